@@ -6,10 +6,11 @@ layout(location = 2) in vec2 aUv;
 layout(location = 3) in vec3 aTangent;
 layout(location = 4) in vec3 aBiTangent;
 
-layout(push_constant) uniform constants
+// Filled by RenderSystem, gl_InstanceIndex includes first instance of the draw
+layout(std430, binding = 2) readonly buffer InstanceBuffer
 {
-	mat4 cTransform;
-} Transform;
+    mat4 u_Transforms[];
+};
 
 layout(binding = 1) uniform CameraUB
 {
@@ -30,13 +31,15 @@ layout(location = 0) out VertexOutput Output;
 
 void main()
 {
+    const mat4 transform = u_Transforms[gl_InstanceIndex];
+
     Output.UV = aUv;
-    Output.Normal = transpose(inverse(mat3(Transform.cTransform))) * aNormal;
-    Output.WorldPos = vec3(Transform.cTransform * vec4(aPosition, 1.0));
+    Output.Normal = transpose(inverse(mat3(transform))) * aNormal;
+    Output.WorldPos = vec3(transform * vec4(aPosition, 1.0));
 
-    vec3 T = normalize(vec3(Transform.cTransform * vec4(aTangent,   0.0)));
-    vec3 B = normalize(vec3(Transform.cTransform * vec4(aBiTangent, 0.0)));
-    vec3 N = normalize(vec3(Transform.cTransform * vec4(aNormal,    0.0)));
+    vec3 T = normalize(vec3(transform * vec4(aTangent,   0.0)));
+    vec3 B = normalize(vec3(transform * vec4(aBiTangent, 0.0)));
+    vec3 N = normalize(vec3(transform * vec4(aNormal,    0.0)));
     mat3 TBN = mat3(T, B, N);
     Output.TBN = TBN;
     Output.CameraPosition = u_CameraPosition;
@@ -73,6 +76,12 @@ layout(binding = 8) uniform samplerCube u_IrradianceMap;
 layout(binding = 9) uniform samplerCube u_PrefilterMap;
 layout(binding = 10) uniform sampler2D u_BRDFLUT;
 
+// Material features, values are set per pipeline permutation by the material loader
+layout(constant_id = 0) const bool USE_ALBEDO_TEX = false;
+layout(constant_id = 1) const bool USE_NORMAL_TEX = true;
+layout(constant_id = 2) const bool USE_METALLIC_TEX = false;
+layout(constant_id = 3) const bool USE_ROUGHNESS_TEX = false;
+
 struct Light
 {
     vec4 color;
@@ -88,6 +97,11 @@ const float PI = 3.14159265359;
 
 vec3 getNormalFromMap()
 {
+    if (!USE_NORMAL_TEX)
+    {
+        return normalize(Output.Normal);
+    }
+
     vec3 tangentNormal = texture(u_Normal, Output.UV).xyz;
     tangentNormal = tangentNormal * 2.0 - 1.0;
     return normalize(Output.TBN * tangentNormal);
@@ -142,7 +156,7 @@ vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
 void main()
 {
     vec3 albedo;
-    if (u_UseAlbedoTex)
+    if (USE_ALBEDO_TEX)
     {
         albedo = texture(u_Albedo, Output.UV).rgb;
     }
@@ -153,7 +167,7 @@ void main()
     albedo = pow(albedo, vec3(2.2));
 
     float metallic;
-    if (u_UseMetallicTex)
+    if (USE_METALLIC_TEX)
     {
         metallic = texture(u_Metallic, Output.UV).r;
     }
@@ -163,7 +177,7 @@ void main()
     }
 
     float roughness;
-    if (u_UseRoughnessTex)
+    if (USE_ROUGHNESS_TEX)
     {
         roughness = texture(u_Rougness, Output.UV).r;
     }
@@ -0,0 +1,123 @@
+#include <RHI/ShaderCompiler.hpp>
+#include <taskflow/taskflow.hpp>
+#include <fmt/format.h>
+#include <EASTL/vector.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+
+// Measures shader compile throughput when the shader set is compiled by different amount of workers.
+// Usage: ShaderCompileBenchmark <shader directory> [repeats]. Every worker amount uses a new compiler with disk cache
+// disabled, so every shader is actually compiled
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr uint32_t C_DEFAULT_REPEATS = 4;
+
+struct Job
+{
+    std::string     m_path;
+    rhi::ShaderType m_type = rhi::ShaderType::NONE;
+};
+
+// Same rule as material loader uses: compute shaders have their own extension
+eastl::vector<Job> CollectShaders(const fs::path& directory)
+{
+    eastl::vector<Job> jobs;
+
+    for (const auto& entry : fs::directory_iterator(directory))
+    {
+        const auto extension = entry.path().extension();
+
+        if (extension == ".glsl")
+        {
+            jobs.push_back({ fs::absolute(entry.path()).generic_u8string(), rhi::ShaderType::FX });
+        }
+        else if (extension == ".glslc")
+        {
+            jobs.push_back({ fs::absolute(entry.path()).generic_u8string(), rhi::ShaderType::COMPUTE });
+        }
+    }
+
+    return jobs;
+}
+
+} // unnamed
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fmt::print("Usage: {} <shader directory> [repeats]\n", argv[0]);
+        return 1;
+    }
+
+    const auto jobs = CollectShaders(argv[1]);
+    const uint32_t repeats = argc > 2 ? static_cast<uint32_t>(std::max(1, std::atoi(argv[2]))) : C_DEFAULT_REPEATS;
+
+    if (jobs.empty())
+    {
+        fmt::print("No shaders were found in {}\n", argv[1]);
+        return 1;
+    }
+
+    const uint32_t maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+
+    eastl::vector<uint32_t> workerAmounts;
+    for (uint32_t workers = 1; workers < maxWorkers; workers *= 2)
+    {
+        workerAmounts.push_back(workers);
+    }
+    workerAmounts.push_back(maxWorkers);
+
+    fmt::print("{} shaders, {} repeats\n", jobs.size(), repeats);
+    fmt::print("{:>8} | {:>10} | {:>14} | {:>8} | {:>6}\n", "Workers", "Total ms", "Shaders/sec", "Speedup", "Failed");
+
+    double singleWorkerMs = 0.0;
+
+    for (const uint32_t workers : workerAmounts)
+    {
+        const auto compiler = rhi::vulkan::CreateShaderCompiler();
+
+        tf::Executor executor(workers);
+        tf::Taskflow taskflow;
+        std::atomic<uint32_t> failed = 0;
+
+        for (uint32_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            for (const auto& job : jobs)
+            {
+                taskflow.emplace([&compiler, &job, &failed]
+                {
+                    if (!compiler->Compile(job.m_path, job.m_type).m_valid)
+                    {
+                        failed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        executor.run(taskflow).wait();
+        const auto end = std::chrono::steady_clock::now();
+
+        const double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+        const double compiled = static_cast<double>(jobs.size() * repeats);
+
+        if (workers == 1)
+        {
+            singleWorkerMs = totalMs;
+        }
+
+        fmt::print("{:>8} | {:>10.2f} | {:>14.2f} | {:>7.2f}x | {:>6}\n",
+            workers, totalMs, compiled / (totalMs / 1000.0), singleWorkerMs / totalMs, failed.load());
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <RHI/ShaderCompiler.hpp>
+#include <Core/String.hpp>
+#include <fmt/format.h>
+#include <EASTL/vector.h>
+#include <chrono>
+#include <filesystem>
+
+// Compiles the same shader set with every shader profile and reports blob size and compile time of each, so effect
+// of the SPIR-V optimizer is visible. Usage: ShaderProfileBenchmark <shader directory>. Disk cache is disabled
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+struct Profile
+{
+    std::string_view        m_name;
+    rhi::ShaderProfile      m_profile = rhi::ShaderProfile::DEBUG;
+    bool                    m_optimizeSize = false;
+};
+
+constexpr Profile C_PROFILES[] = {
+    { "Debug", rhi::ShaderProfile::DEBUG, false },
+    { "Release", rhi::ShaderProfile::RELEASE, false },
+    { "Release (size)", rhi::ShaderProfile::RELEASE, true },
+};
+
+} // unnamed
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fmt::print("Usage: {} <shader directory>\n", argv[0]);
+        return 1;
+    }
+
+    eastl::vector<std::pair<std::string, rhi::ShaderType>> shaders;
+    for (const auto& entry : fs::directory_iterator(argv[1]))
+    {
+        const auto extension = entry.path().extension();
+
+        // Same rule as material loader uses: compute shaders have their own extension
+        if (extension == ".glsl" || extension == ".glslc")
+        {
+            shaders.emplace_back(fs::absolute(entry.path()).generic_u8string(), extension == ".glsl" ? rhi::ShaderType::FX : rhi::ShaderType::COMPUTE);
+        }
+    }
+
+    if (shaders.empty())
+    {
+        fmt::print("No shaders were found in {}\n", argv[1]);
+        return 1;
+    }
+
+    fmt::print("{} shaders\n", shaders.size());
+    fmt::print("{:>16} | {:>12} | {:>14} | {:>10} | {:>6}\n", "Profile", "Blob size", "Compile ms", "Wall ms", "Failed");
+
+    for (const auto& profile : C_PROFILES)
+    {
+        rhi::ShaderCompiler::Options options;
+        options.m_profile = profile.m_profile;
+        options.m_optimizeSize = profile.m_optimizeSize;
+
+        const auto compiler = rhi::vulkan::CreateShaderCompiler(options);
+        uint32_t failed = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& [path, type] : shaders)
+        {
+            if (!compiler->Compile(path, type).m_valid)
+            {
+                ++failed;
+            }
+        }
+        const double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        const auto stats = compiler->GetStats();
+        fmt::print("{:>16} | {:>12} | {:>14.2f} | {:>10.2f} | {:>6}\n",
+            profile.m_name,
+            core::string::BytesToHumanReadable(stats.m_compiledBlobSize),
+            stats.m_compileTimeMs,
+            wallMs,
+            failed);
+    }
+
+    return 0;
+}
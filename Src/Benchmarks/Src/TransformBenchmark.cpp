@@ -0,0 +1,114 @@
+#include <Engine/System/TransformSystem.hpp>
+#include <Engine/ECS/World.hpp>
+#include <taskflow/taskflow.hpp>
+#include <fmt/format.h>
+#include <EASTL/vector.h>
+#include <chrono>
+
+// Measures TransformSystem update time for transform trees of different sizes, when every transform is dirty
+// and when only 1% of the leaves were modified. Runs without engine instance, chunks are executed on the local executor
+
+namespace
+{
+
+constexpr uint32_t C_FRAMES = 100;
+constexpr uint32_t C_FAN_OUT = 8;
+constexpr size_t C_ENTITY_AMOUNTS[] = { 10'000, 100'000, 1'000'000 };
+
+struct Result
+{
+    double m_msPerFrame = 0.0;
+    double m_nsPerEntity = 0.0;
+};
+
+eastl::vector<entt::entity> CreateHierarchy(engine::ecs::World& world, size_t amount)
+{
+    auto& entityManager = world.GetEntityManager();
+
+    for (size_t i = 0; i < amount; ++i)
+    {
+        entityManager->CreateEntity();
+    }
+    entityManager->Update();
+
+    eastl::vector<entt::entity> entities;
+    entities.reserve(amount);
+
+    for (auto [e, t] : world.View<engine::TransformComponent>())
+    {
+        entities.push_back(e);
+    }
+
+    // Every entity except the root gets a parent, which is created before it, so the tree is C_FAN_OUT wide
+    auto& storage = world.Storage<engine::TransformComponent>();
+    for (size_t i = 1; i < entities.size(); ++i)
+    {
+        storage.get(entities[i]).m_parent = entities[(i - 1) / C_FAN_OUT];
+    }
+
+    return entities;
+}
+
+template<typename Modify>
+Result Measure(engine::TransformSystem& system, size_t amount, Modify&& modify)
+{
+    std::chrono::nanoseconds total{ 0 };
+
+    for (uint32_t frame = 0; frame < C_FRAMES; ++frame)
+    {
+        modify();
+
+        const auto start = std::chrono::steady_clock::now();
+        system.Update(0.0f);
+        total += std::chrono::steady_clock::now() - start;
+    }
+
+    Result result;
+    result.m_msPerFrame = static_cast<double>(total.count()) / C_FRAMES / 1'000'000.0;
+    result.m_nsPerEntity = static_cast<double>(total.count()) / C_FRAMES / static_cast<double>(amount);
+    return result;
+}
+
+} // unnamed
+
+int main()
+{
+    tf::Executor executor;
+
+    fmt::print("{:>10} | {:>12} | {:>14} | {:>12} | {:>14}\n", "Entities", "All ms/frame", "All ns/entity", "1% ms/frame", "1% ns/entity");
+
+    for (const size_t amount : C_ENTITY_AMOUNTS)
+    {
+        engine::ecs::World world("Benchmark");
+        const auto entities = CreateHierarchy(world, amount);
+
+        engine::TransformSystem system(&world);
+        system.SetExecutor(&executor);
+
+        // Builds the hierarchy and initializes recently created transforms, so they aren't counted as dirty anymore
+        system.Update(0.0f);
+
+        auto& storage = world.Storage<engine::TransformComponent>();
+
+        // Modifying the root makes every transform of the tree dirty
+        const Result all = Measure(system, amount, [&]
+        {
+            storage.get(entities.front()).Modify();
+        });
+
+        // Last created entities are the leaves of the tree, so modification doesn't propagate further
+        const size_t dirtyBegin = amount - amount / 100;
+        const Result sparse = Measure(system, amount, [&]
+        {
+            for (size_t i = dirtyBegin; i < amount; ++i)
+            {
+                storage.get(entities[i]).Modify();
+            }
+        });
+
+        fmt::print("{:>10} | {:>12.3f} | {:>14.2f} | {:>12.3f} | {:>14.2f}\n",
+            amount, all.m_msPerFrame, all.m_nsPerEntity, sparse.m_msPerFrame, sparse.m_nsPerEntity);
+    }
+
+    return 0;
+}
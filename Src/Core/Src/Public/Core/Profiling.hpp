@@ -9,10 +9,12 @@
 #define PROFILER_CPU_ZONE_SET_NAME(LABEL, LEN) ZoneName(LABEL, LEN)
 #define PROFILER_FRAME_END FrameMark
 #define PROFILER_SET_THREAD_NAME(NAME) tracy::SetThreadName(NAME)
+#define PROFILER_PLOT(NAME, VALUE) TracyPlot(NAME, VALUE)
 #else
 #define PROFILER_CPU_ZONE
 #define PROFILER_CPU_ZONE_NAME(LABEL)
 #define PROFILER_CPU_ZONE_SET_NAME(LABEL, LEN)
 #define PROFILER_FRAME_END
 #define PROFILER_SET_THREAD_NAME(NAME)
+#define PROFILER_PLOT(NAME, VALUE)
 #endif
\ No newline at end of file
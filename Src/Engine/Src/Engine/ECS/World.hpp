@@ -26,6 +26,20 @@ public:
         return m_entityManager->m_registry.view<T, Types...>().each();
     }
 
+    // Direct access to the packed component storage, useful for chunked iteration
+    template<typename T>
+    auto&   Storage()
+    {
+        return m_entityManager->m_registry.storage<T>();
+    }
+
+    // Sorts component storage, so iterating it from begin to end follows the compare order
+    template<typename T, typename Compare>
+    void    Sort(Compare compare)
+    {
+        m_entityManager->m_registry.sort<T>(std::move(compare));
+    }
+
     std::unique_ptr<SystemManager>& GetSystemManager() { return m_systemManager; }
     std::unique_ptr<EntityManager>& GetEntityManager() { return m_entityManager; }
 
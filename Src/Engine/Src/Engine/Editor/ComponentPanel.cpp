@@ -147,13 +147,25 @@ void ComponentPanel::DrawPanel()
 
 	DrawComponent<TransformComponent>(selectedEntity, em, [](TransformComponent& t)
 	{
-		auto rotation = glm::degrees(glm::eulerAngles(t.m_rotation));
+		const auto prevRotation = glm::degrees(glm::eulerAngles(t.m_rotation));
+		const auto prevPosition = t.m_position;
+		const auto prevScale = t.m_scale;
+		auto rotation = prevRotation;
 
 		DrawVec3Control("Position", t.m_position);
 		DrawVec3Control("Rotation", rotation);
 		DrawVec3Control("Scale", t.m_scale);
 
-		t.m_rotation = glm::quat(glm::radians(rotation));
+		if (rotation != prevRotation)
+		{
+			t.m_rotation = glm::quat(glm::radians(rotation));
+		}
+
+		// TransformSystem recalculates only modified transforms
+		if (!t.IsModified() && (rotation != prevRotation || t.m_position != prevPosition || t.m_scale != prevScale))
+		{
+			t.Modify();
+		}
 	});
 
 	DrawComponent<DirectionalLightComponent>(selectedEntity, em, [](DirectionalLightComponent& l)
@@ -177,9 +189,9 @@ void ComponentPanel::DrawPanel()
 				dirty = true;
 			}
 
-			if (ImGui::Checkbox("Use albedo texture", &materialBuffer->m_useAlbedoTex))
+			if (bool useTexture = material->Feature("USE_ALBEDO_TEX"); ImGui::Checkbox("Use albedo texture", &useTexture))
 			{
-				dirty = true;
+				material->SetFeature("USE_ALBEDO_TEX", useTexture);
 			}
 
 			ImGui::Separator();
@@ -190,9 +202,9 @@ void ComponentPanel::DrawPanel()
 				dirty = true;
 			}
 
-			if (ImGui::Checkbox("Use roughness texture", &materialBuffer->m_useRoughnessTex))
+			if (bool useTexture = material->Feature("USE_ROUGHNESS_TEX"); ImGui::Checkbox("Use roughness texture", &useTexture))
 			{
-				dirty = true;
+				material->SetFeature("USE_ROUGHNESS_TEX", useTexture);
 			}
 
 			ImGui::Separator();
@@ -203,9 +215,16 @@ void ComponentPanel::DrawPanel()
 				dirty = true;
 			}
 
-			if (ImGui::Checkbox("Use metallic texture", &materialBuffer->m_useMetallicTex))
+			if (bool useTexture = material->Feature("USE_METALLIC_TEX"); ImGui::Checkbox("Use metallic texture", &useTexture))
 			{
-				dirty = true;
+				material->SetFeature("USE_METALLIC_TEX", useTexture);
+			}
+
+			ImGui::Separator();
+
+			if (bool useTexture = material->Feature("USE_NORMAL_TEX"); ImGui::Checkbox("Use normal texture", &useTexture))
+			{
+				material->SetFeature("USE_NORMAL_TEX", useTexture);
 			}
 
 			if (dirty)
@@ -158,6 +158,36 @@ constexpr ImVec4 MakeImVec4(const ImVec4& vec, float w)
 
 constexpr uint8_t C_DEFAULT_FONT_SIZE = 14;
 
+void ReleaseDrawData(ImDrawData& drawData)
+{
+	for (auto* list : drawData.CmdLists)
+	{
+		IM_DELETE(list);
+	}
+
+	drawData.Clear();
+}
+
+// Lists are cloned, so ImGui may begin the next frame while the render thread draws the copy
+void CopyDrawData(const ImDrawData& src, ImDrawData& dst)
+{
+	ReleaseDrawData(dst);
+
+	dst.Valid = src.Valid;
+	dst.CmdListsCount = src.CmdListsCount;
+	dst.TotalIdxCount = src.TotalIdxCount;
+	dst.TotalVtxCount = src.TotalVtxCount;
+	dst.DisplayPos = src.DisplayPos;
+	dst.DisplaySize = src.DisplaySize;
+	dst.FramebufferScale = src.FramebufferScale;
+	dst.OwnerViewport = src.OwnerViewport;
+
+	for (const auto* list : src.CmdLists)
+	{
+		dst.CmdLists.push_back(list->CloneOutput());
+	}
+}
+
 } // unnamed
 
 namespace engine
@@ -249,10 +279,20 @@ ImguiService::ImguiService()
     ImGui_ImplGlfw_InitForVulkan(ws.Window(), true);
 
     m_imguiProvider = rhi::imgui::IImguiProvider::Create();
+
+    // The first Begin creates fonts texture, later frames begin without waiting as they don't touch ImGui state anymore
+    Instance().Service<RenderService>().RunOnRenderThreadWait([this]()
+        {
+            m_imguiProvider->Begin();
+        });
 }
 
 ImguiService::~ImguiService()
 {
+    // Render thread may still draw the last frame
+    Instance().Service<RenderService>().WaitAll();
+    ReleaseDrawData(m_drawData);
+
     ImGui::SaveIniSettingsToDisk(m_configFilePath.c_str());
 
     ImGui_ImplGlfw_Shutdown();
@@ -267,9 +307,9 @@ void ImguiService::Update(float dt)
 
 	auto& rs = Instance().Service<RenderService>();
 
-	rs.RunOnRenderThreadWait([=, &rs]
+	rs.RunOnRenderThread([=, pass = rs.ImGuiPass()]
 		{
-			m_imguiProvider->SetRenderPass(rs.ImGuiPass());
+			m_imguiProvider->SetRenderPass(pass);
 			m_imguiProvider->Begin();
 		});
 
@@ -284,10 +324,21 @@ void ImguiService::PostUpdate(float dt)
 
 	ImGui::Render();
 
-	rs.RunOnRenderThreadWait([=]
+	// Copy of the previous frame may be drawn until the render frame is begun
+	rs.BeginRenderFrame();
+	CopyDrawData(*ImGui::GetDrawData(), m_drawData);
+
+	rs.AddPass(rs.ImGuiPass(), m_frameImages, [=]
 		{
-			m_imguiProvider->End();
+			m_imguiProvider->End(&m_drawData);
 		});
+
+	m_frameImages.clear();
+
+	for (auto it = m_images.begin(); it != m_images.end();)
+	{
+		it = it->second.m_texture.expired() ? m_images.erase(it) : eastl::next(it);
+	}
 }
 
 void ImguiService::Image(const std::shared_ptr<rhi::Texture>& texture, const ImVec2& size, const ImVec2& uv0,
@@ -295,19 +346,27 @@ void ImguiService::Image(const std::shared_ptr<rhi::Texture>& texture, const ImV
 {
 	ENGINE_ASSERT(core::IsMainThread());
 
-	auto& rs = Instance().Service<RenderService>();
+	auto& image = m_images[texture.get()];
 
-	const auto texId = rs.RunOnRenderThreadWait([=]
-		{
-			return m_imguiProvider->Image(texture, size, uv0, uv1);
-		});
+	// Descriptor set of the texture is created once, so the render thread is waited for only when the texture is drawn first time
+	if (image.m_texture.expired())
+	{
+		image.m_texture = texture;
+		image.m_id = Instance().Service<RenderService>().RunOnRenderThreadWait([=]
+			{
+				return m_imguiProvider->Image(texture, size, uv0, uv1);
+			});
+	}
+
+	m_frameImages.push_back(texture);
 
-	ImGui::Image(texId, size, uv0, uv1);
+	ImGui::Image(image.m_id, size, uv0, uv1);
 }
 
 void ImguiService::RemoveImage(const std::shared_ptr<rhi::Texture>& texture)
 {
     ENGINE_ASSERT(texture);
+	m_images.erase(texture.get());
 	m_imguiProvider->RemoveImage(texture);
 }
 
@@ -3,6 +3,8 @@
 #include <Engine/Config.hpp>
 #include <Engine/Service/IService.hpp>
 #include <RHI/IImguiProvider.hpp>
+#include <EASTL/vector.h>
+#include <EASTL/unordered_map.h>
 
 namespace engine
 {
@@ -22,6 +24,18 @@ public:
 private:
     std::string                                 m_configFilePath;
     std::shared_ptr<rhi::imgui::IImguiProvider> m_imguiProvider;
+    // Textures drawn in the current frame, ImGui pass samples them
+    eastl::vector<std::shared_ptr<rhi::Texture>> m_frameImages;
+    // Draw data of the last frame, render thread draws it
+    ImDrawData                                  m_drawData;
+
+    struct CachedImage
+    {
+        std::weak_ptr<rhi::Texture> m_texture;
+        ImTextureID                 m_id = nullptr;
+    };
+
+    eastl::unordered_map<const rhi::Texture*, CachedImage> m_images;
 };
 
 } // engine
\ No newline at end of file
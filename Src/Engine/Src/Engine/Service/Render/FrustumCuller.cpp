@@ -0,0 +1,191 @@
+#include <Engine/Service/Render/FrustumCuller.hpp>
+#include <Engine/Service/ThreadService.hpp>
+#include <Engine/Engine.hpp>
+#include <Core/Profiling.hpp>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define FRUSTUM_CULLER_SSE 1
+#include <xmmintrin.h>
+#else
+#define FRUSTUM_CULLER_SSE 0
+#endif
+
+namespace
+{
+
+// Amount of boxes processed by a single task, must be divisible by 4
+constexpr size_t C_CHUNK_SIZE = 4096;
+constexpr size_t C_SIMD_WIDTH = 4;
+constexpr float  C_UNBOUNDED_EXTENT = 1e30f;
+
+// Plane is (n, d), point is inside if dot(n, p) + d >= 0.
+// Projection is built by glm without GLM_FORCE_DEPTH_ZERO_TO_ONE, so clip depth range is [-w, w] and near plane is row3 + row2
+void ExtractPlanes(const glm::mat4& m, glm::vec4* planes)
+{
+    const glm::vec4 row0 = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1 = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2 = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3 = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0;
+    planes[1] = row3 - row0;
+    planes[2] = row3 + row1;
+    planes[3] = row3 - row1;
+    planes[4] = row3 + row2;
+    planes[5] = row3 - row2;
+}
+
+} // unnamed
+
+namespace engine::render
+{
+
+void FrustumCuller::Clear()
+{
+    m_items.clear();
+}
+
+void FrustumCuller::Push(const AABB& localBox, const glm::mat4* transform)
+{
+    // Objects without bounds are never culled
+    if (!localBox.Valid())
+    {
+        m_items.push_back({ glm::vec3(0.0f), glm::vec3(C_UNBOUNDED_EXTENT), transform });
+        return;
+    }
+
+    m_items.push_back({ localBox.Center(), localBox.Extents(), transform });
+}
+
+size_t FrustumCuller::Cull(const glm::mat4& projView)
+{
+    PROFILER_CPU_ZONE;
+
+    ExtractPlanes(projView, m_planes);
+
+    m_visible.resize(m_items.size());
+    m_visibleCounter = 0;
+
+    if (m_items.size() <= C_CHUNK_SIZE)
+    {
+        return CullRange(0, m_items.size());
+    }
+
+    const size_t chunksAmount = (m_items.size() + C_CHUNK_SIZE - 1) / C_CHUNK_SIZE;
+
+    // Taskflow is rebuilt only when amount of chunks changes, tasks read actual items amount on execution
+    if (chunksAmount != m_chunksAmount)
+    {
+        m_taskflow.clear();
+
+        for (size_t chunk = 0; chunk < chunksAmount; ++chunk)
+        {
+            m_taskflow.emplace([this, chunk]
+            {
+                PROFILER_CPU_ZONE_NAME("FrustumCuller chunk");
+
+                const size_t begin = chunk * C_CHUNK_SIZE;
+                const size_t end = std::min(begin + C_CHUNK_SIZE, m_items.size());
+
+                m_visibleCounter.fetch_add(CullRange(begin, end), std::memory_order_relaxed);
+            });
+        }
+
+        m_chunksAmount = chunksAmount;
+    }
+
+    Instance().Service<ThreadService>().RunForegroundTaskflowAndWait(m_taskflow);
+
+    return m_visibleCounter;
+}
+
+uint32_t FrustumCuller::CullRange(size_t begin, size_t end)
+{
+    uint32_t visibleAmount = 0;
+
+    for (size_t i = begin; i < end; i += C_SIMD_WIDTH)
+    {
+        const size_t count = std::min(C_SIMD_WIDTH, end - i);
+
+        // Transform boxes to world space, result box is still axis aligned
+        alignas(16) float cx[C_SIMD_WIDTH] = {};
+        alignas(16) float cy[C_SIMD_WIDTH] = {};
+        alignas(16) float cz[C_SIMD_WIDTH] = {};
+        alignas(16) float ex[C_SIMD_WIDTH] = {};
+        alignas(16) float ey[C_SIMD_WIDTH] = {};
+        alignas(16) float ez[C_SIMD_WIDTH] = {};
+
+        for (size_t k = 0; k < count; ++k)
+        {
+            const auto& item = m_items[i + k];
+            const glm::mat4& m = *item.m_transform;
+
+            const glm::vec3 center = glm::vec3(m * glm::vec4(item.m_center, 1.0f));
+            const glm::mat3 absRotationScale = glm::mat3(glm::abs(glm::vec3(m[0])), glm::abs(glm::vec3(m[1])), glm::abs(glm::vec3(m[2])));
+            const glm::vec3 extents = absRotationScale * item.m_extents;
+
+            cx[k] = center.x;
+            cy[k] = center.y;
+            cz[k] = center.z;
+            ex[k] = extents.x;
+            ey[k] = extents.y;
+            ez[k] = extents.z;
+        }
+
+        int mask = 0;
+
+#if FRUSTUM_CULLER_SSE
+        const __m128 vcx = _mm_load_ps(cx);
+        const __m128 vcy = _mm_load_ps(cy);
+        const __m128 vcz = _mm_load_ps(cz);
+        const __m128 vex = _mm_load_ps(ex);
+        const __m128 vey = _mm_load_ps(ey);
+        const __m128 vez = _mm_load_ps(ez);
+        const __m128 zero = _mm_setzero_ps();
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+
+        for (const auto& plane : m_planes)
+        {
+            // Distance from center plus projected extents, box is outside if it is negative
+            __m128 distance = _mm_add_ps(_mm_mul_ps(vcx, _mm_set1_ps(plane.x)), _mm_mul_ps(vcy, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(vcz, _mm_set1_ps(plane.z)));
+            distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(vex, _mm_set1_ps(glm::abs(plane.x))));
+            distance = _mm_add_ps(distance, _mm_mul_ps(vey, _mm_set1_ps(glm::abs(plane.y))));
+            distance = _mm_add_ps(distance, _mm_mul_ps(vez, _mm_set1_ps(glm::abs(plane.z))));
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+        }
+
+        mask = _mm_movemask_ps(inside);
+#else
+        for (size_t k = 0; k < C_SIMD_WIDTH; ++k)
+        {
+            bool inside = true;
+
+            for (const auto& plane : m_planes)
+            {
+                const float distance = cx[k] * plane.x + cy[k] * plane.y + cz[k] * plane.z + plane.w
+                    + ex[k] * glm::abs(plane.x) + ey[k] * glm::abs(plane.y) + ez[k] * glm::abs(plane.z);
+
+                inside &= distance >= 0.0f;
+            }
+
+            mask |= static_cast<int>(inside) << k;
+        }
+#endif
+
+        for (size_t k = 0; k < count; ++k)
+        {
+            const uint8_t visible = (mask >> k) & 1;
+            m_visible[i + k] = visible;
+            visibleAmount += visible;
+        }
+    }
+
+    return visibleAmount;
+}
+
+} // engine::render
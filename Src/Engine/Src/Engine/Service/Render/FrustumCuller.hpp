@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Engine/Config.hpp>
+#include <Engine/Service/Render/Mesh.hpp>
+#include <Core/Type.hpp>
+#include <EASTL/vector.h>
+#include <taskflow/taskflow.hpp>
+#include <glm/glm.hpp>
+#include <atomic>
+
+namespace engine::render
+{
+
+// Tests world space bounding boxes against camera frustum.
+// Boxes are tested 4 at a time with SIMD, big amounts of boxes are split between foreground workers
+class ENGINE_API FrustumCuller : public core::NonCopyable
+{
+public:
+    void        Clear();
+
+    // Box is transformed to world space during culling, so transform must stay alive until Cull is finished
+    void        Push(const AABB& localBox, const glm::mat4* transform);
+
+    // Returns amount of visible boxes
+    size_t      Cull(const glm::mat4& projView);
+
+    size_t      Size() const { return m_items.size(); }
+    bool        Visible(size_t index) const { return m_visible[index] != 0; }
+
+private:
+    struct Item
+    {
+        glm::vec3           m_center;
+        glm::vec3           m_extents;
+        const glm::mat4*    m_transform;
+    };
+
+    uint32_t    CullRange(size_t begin, size_t end);
+
+    eastl::vector<Item>     m_items;
+    eastl::vector<uint8_t>  m_visible;
+    glm::vec4               m_planes[6];
+    tf::Taskflow            m_taskflow;
+    size_t                  m_chunksAmount = 0;
+    std::atomic<uint32_t>   m_visibleCounter = 0;
+};
+
+} // engine::render
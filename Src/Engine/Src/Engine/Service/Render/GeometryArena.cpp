@@ -0,0 +1,232 @@
+#include <Engine/Service/Render/GeometryArena.hpp>
+#include <Engine/Service/Render/RenderService.hpp>
+#include <Engine/Engine.hpp>
+#include <Core/String.hpp>
+#include <algorithm>
+
+namespace engine::render
+{
+
+FreeListAllocator::FreeListAllocator(uint32_t size) : m_size(size), m_freeSize(size)
+{
+    if (size > 0)
+    {
+        m_freeRanges[0] = size;
+    }
+}
+
+uint32_t FreeListAllocator::Allocate(uint32_t size, uint32_t alignment)
+{
+    ENGINE_ASSERT(size > 0 && alignment > 0);
+
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it)
+    {
+        const uint32_t rangeOffset = it->first;
+        const uint32_t rangeSize = it->second;
+        const uint32_t alignedOffset = (rangeOffset + alignment - 1) / alignment * alignment;
+        const uint32_t padding = alignedOffset - rangeOffset;
+
+        if (padding + size > rangeSize)
+        {
+            continue;
+        }
+
+        m_freeRanges.erase(it);
+
+        // Padding before the allocation and the tail stay free
+        if (padding > 0)
+        {
+            m_freeRanges[rangeOffset] = padding;
+        }
+        if (const uint32_t tail = rangeSize - padding - size; tail > 0)
+        {
+            m_freeRanges[alignedOffset + size] = tail;
+        }
+
+        m_freeSize -= size;
+        return alignedOffset;
+    }
+
+    return C_INVALID_OFFSET;
+}
+
+void FreeListAllocator::Free(uint32_t offset, uint32_t size)
+{
+    ENGINE_ASSERT(offset + size <= m_size);
+
+    m_freeSize += size;
+
+    auto next = m_freeRanges.lower_bound(offset);
+    ENGINE_ASSERT(next == m_freeRanges.end() || next->first >= offset + size);
+
+    // Merge with the following range
+    if (next != m_freeRanges.end() && next->first == offset + size)
+    {
+        size += next->second;
+        next = m_freeRanges.erase(next);
+    }
+
+    // Merge with the preceding range
+    if (next != m_freeRanges.begin())
+    {
+        auto prev = eastl::prev(next);
+        ENGINE_ASSERT(prev->first + prev->second <= offset);
+
+        if (prev->first + prev->second == offset)
+        {
+            prev->second += size;
+            return;
+        }
+    }
+
+    m_freeRanges[offset] = size;
+}
+
+GeometryArena::GeometryArena(const std::shared_ptr<rhi::Buffer>& vertexBuffer, const std::shared_ptr<rhi::Buffer>& indexBuffer)
+{
+    ENGINE_ASSERT(vertexBuffer->Descriptor().m_type == rhi::BufferType::VERTEX);
+    ENGINE_ASSERT(indexBuffer->Descriptor().m_type == rhi::BufferType::INDEX);
+
+    m_vertexBlocks.push_back({ vertexBuffer, FreeListAllocator(vertexBuffer->Descriptor().m_size) });
+    m_indexBlocks.push_back({ indexBuffer, FreeListAllocator(indexBuffer->Descriptor().m_size) });
+}
+
+GeometryArena::Range GeometryArena::AllocateVertices(const void* data, uint32_t count, uint32_t stride)
+{
+    return Allocate(m_vertexBlocks, data, count, stride);
+}
+
+GeometryArena::Range GeometryArena::AllocateIndices(const uint32_t* data, uint32_t count)
+{
+    return Allocate(m_indexBlocks, data, count, sizeof(uint32_t));
+}
+
+std::shared_ptr<rhi::Buffer> GeometryArena::VertexBuffer(uint32_t block) const
+{
+    std::lock_guard l(m_mutex);
+    ENGINE_ASSERT(block < m_vertexBlocks.size());
+    return m_vertexBlocks[block].m_buffer;
+}
+
+std::shared_ptr<rhi::Buffer> GeometryArena::IndexBuffer(uint32_t block) const
+{
+    std::lock_guard l(m_mutex);
+    ENGINE_ASSERT(block < m_indexBlocks.size());
+    return m_indexBlocks[block].m_buffer;
+}
+
+GeometryArena::Range GeometryArena::Allocate(BlockList& blocks, const void* data, uint32_t count, uint32_t stride)
+{
+    ENGINE_ASSERT(data && count > 0 && stride > 0);
+
+    const uint32_t size = count * stride;
+    uint32_t offset = FreeListAllocator::C_INVALID_OFFSET;
+    uint32_t blockIndex = 0;
+    std::shared_ptr<rhi::Buffer> buffer;
+
+    {
+        std::lock_guard l(m_mutex);
+
+        for (; blockIndex < blocks.size(); ++blockIndex)
+        {
+            // Offset must be a multiple of stride to be addressed in elements
+            offset = blocks[blockIndex].m_allocator.Allocate(size, stride);
+
+            if (offset != FreeListAllocator::C_INVALID_OFFSET)
+            {
+                break;
+            }
+        }
+
+        if (offset == FreeListAllocator::C_INVALID_OFFSET)
+        {
+            const auto* block = AddBlock(blocks, size);
+
+            if (!block)
+            {
+                return {};
+            }
+
+            blockIndex = static_cast<uint32_t>(blocks.size() - 1);
+            offset = blocks.back().m_allocator.Allocate(size, stride);
+            ENGINE_ASSERT(offset != FreeListAllocator::C_INVALID_OFFSET);
+        }
+
+        buffer = blocks[blockIndex].m_buffer;
+    }
+
+    Instance().Service<RenderService>().UpdateBuffer(buffer, data, size, offset);
+
+    Range range;
+    range.m_offset = offset / stride;
+    range.m_count = count;
+    range.m_stride = stride;
+    range.m_block = blockIndex;
+    return range;
+}
+
+GeometryArena::Block* GeometryArena::AddBlock(BlockList& blocks, uint32_t minSize)
+{
+    // Meshes bigger than the block get a block of their own size
+    auto descriptor = blocks.front().m_buffer->Descriptor();
+    descriptor.m_size = std::max(descriptor.m_size, minSize);
+    descriptor.m_name = fmt::format("{} #{}", blocks.front().m_buffer->Descriptor().m_name, blocks.size());
+
+    size_t freeSize = 0;
+    for (const auto& block : blocks)
+    {
+        freeSize += block.m_allocator.FreeSize();
+    }
+
+    // Failed allocation means the arena is undersized for the scene, so it is reported as error even if it is recovered
+    core::log::error("[GeometryArena] Failed to allocate {} in '{}', free memory left: {}, adding block '{}' of {}",
+        core::string::BytesToHumanReadable(minSize),
+        blocks.front().m_buffer->Descriptor().m_name,
+        core::string::BytesToHumanReadable(freeSize),
+        descriptor.m_name,
+        core::string::BytesToHumanReadable(descriptor.m_size));
+
+    auto buffer = Instance().Service<RenderService>().CreateBuffer(descriptor);
+
+    if (!buffer)
+    {
+        core::log::error("[GeometryArena] Failed to create block '{}'", descriptor.m_name);
+        return nullptr;
+    }
+
+    blocks.push_back({ buffer, FreeListAllocator(descriptor.m_size) });
+    return &blocks.back();
+}
+
+void GeometryArena::Free(const Range& vertices, const Range& indices)
+{
+    std::lock_guard l(m_mutex);
+    m_retiredRanges.push_back({ vertices, indices, 0 });
+}
+
+void GeometryArena::NextFrame(uint32_t framesInFlight)
+{
+    std::lock_guard l(m_mutex);
+
+    for (auto it = m_retiredRanges.begin(); it != m_retiredRanges.end();)
+    {
+        if (++it->m_frames <= framesInFlight)
+        {
+            ++it;
+            continue;
+        }
+
+        if (it->m_vertices.Valid())
+        {
+            m_vertexBlocks[it->m_vertices.m_block].m_allocator.Free(it->m_vertices.m_offset * it->m_vertices.m_stride, it->m_vertices.m_count * it->m_vertices.m_stride);
+        }
+        if (it->m_indices.Valid())
+        {
+            m_indexBlocks[it->m_indices.m_block].m_allocator.Free(it->m_indices.m_offset * it->m_indices.m_stride, it->m_indices.m_count * it->m_indices.m_stride);
+        }
+
+        it = m_retiredRanges.erase(it);
+    }
+}
+
+} // engine::render
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Engine/Config.hpp>
+#include <Core/Type.hpp>
+#include <RHI/Buffer.hpp>
+#include <EASTL/map.h>
+#include <EASTL/vector.h>
+#include <limits>
+#include <mutex>
+
+namespace engine::render
+{
+
+// First fit allocator over the free ranges sorted by offset, neighbouring ranges are merged on free
+class ENGINE_API FreeListAllocator
+{
+public:
+    static constexpr uint32_t C_INVALID_OFFSET = std::numeric_limits<uint32_t>::max();
+
+    FreeListAllocator(uint32_t size = 0);
+
+    // Returns C_INVALID_OFFSET if there is no free range big enough
+    uint32_t    Allocate(uint32_t size, uint32_t alignment);
+    void        Free(uint32_t offset, uint32_t size);
+
+    uint32_t    Size() const { return m_size; }
+    uint32_t    FreeSize() const { return m_freeSize; }
+
+private:
+    // Offset -> size
+    eastl::map<uint32_t, uint32_t>  m_freeRanges;
+    uint32_t                        m_size = 0;
+    uint32_t                        m_freeSize = 0;
+};
+
+// Device local vertex and index buffers shared by all meshes.
+// Meshes own ranges of the arena, so vertex and index buffers are bound once per block and draws use offsets.
+// When all blocks are full a new one is added, blocks are never released
+class ENGINE_API GeometryArena : public core::NonCopyable
+{
+public:
+    struct Range
+    {
+        // Offset and count are in elements, e.g. vertices or indices
+        uint32_t    m_offset = 0;
+        uint32_t    m_count = 0;
+        uint32_t    m_stride = 0;
+        uint32_t    m_block = 0;
+
+        bool Valid() const { return m_count > 0; }
+    };
+
+    // Buffers of the first block, next blocks are created with the same descriptors
+    GeometryArena(const std::shared_ptr<rhi::Buffer>& vertexBuffer, const std::shared_ptr<rhi::Buffer>& indexBuffer);
+
+    // Thread safe, returns invalid range only if a new block couldn't be created
+    Range                               AllocateVertices(const void* data, uint32_t count, uint32_t stride);
+    Range                               AllocateIndices(const uint32_t* data, uint32_t count);
+
+    // Memory is reused only after all frames in flight which could reference it are finished
+    void                                Free(const Range& vertices, const Range& indices);
+
+    // Must be called once per frame, releases ranges freed more than frames in flight ago
+    void                                NextFrame(uint32_t framesInFlight);
+
+    // Thread safe, block is the one of the allocated range
+    std::shared_ptr<rhi::Buffer>        VertexBuffer(uint32_t block) const;
+    std::shared_ptr<rhi::Buffer>        IndexBuffer(uint32_t block) const;
+
+private:
+    struct RetiredRange
+    {
+        Range       m_vertices;
+        Range       m_indices;
+        uint32_t    m_frames = 0;
+    };
+
+    struct Block
+    {
+        std::shared_ptr<rhi::Buffer>    m_buffer;
+        FreeListAllocator               m_allocator;
+    };
+
+    using BlockList = eastl::vector<Block>;
+
+    Range                               Allocate(BlockList& blocks, const void* data, uint32_t count, uint32_t stride);
+    // Must be called under the lock, returns nullptr if buffer creation failed
+    Block*                              AddBlock(BlockList& blocks, uint32_t minSize);
+
+    BlockList                           m_vertexBlocks;
+    BlockList                           m_indexBlocks;
+    eastl::vector<RetiredRange>         m_retiredRanges;
+    mutable std::mutex                  m_mutex;
+};
+
+} // engine::render
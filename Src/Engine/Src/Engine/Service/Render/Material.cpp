@@ -1,11 +1,13 @@
 #include <Engine/Service/Render/Material.hpp>
 #include <Engine/Service/Render/RenderService.hpp>
 #include <RHI/GPUMaterial.hpp>
+#include <EASTL/algorithm.h>
 
 namespace
 {
 constexpr int C_MAX_SHADER_BUFFER_AMOUNT = 16;
 constexpr int C_MAX_SHADER_TEXTURE_AMOUNT = 16;
+constexpr size_t C_MAX_FEATURE_AMOUNT = 32;
 } // unnamed
 
 namespace engine::render
@@ -44,20 +46,29 @@ void Material::SetBuffer(rttr::type type, int slot, rhi::ShaderStage stage, std:
 
     auto& rs = Instance().Service<RenderService>();
 
+    // Uniform data lives in the per frame uniform ring, actual location is passed as dynamic offset on bind
     BufferInfo buffer{};
     buffer.m_cpuBuffer = type.create();
+    buffer.m_gpuBuffer = rs.UniformRing().Buffer();
     buffer.m_offset = offset;
     buffer.m_stage = stage;
 
-    rhi::BufferDescriptor descriptor{};
-    descriptor.m_size = core::math::roundToDivisible(static_cast<uint32_t>(type.get_sizeof()), rs.DeviceParams().m_minUniformBufferAlignment);
-    descriptor.m_memoryType = rhi::MemoryType::CPU_GPU;
-    descriptor.m_type = rhi::BufferType::UNIFORM;
-    descriptor.m_name = name;
+    m_pendingBuffers.emplace_back(slot, std::move(buffer));
+    m_dirty = true;
+}
+
+void Material::SetBuffer(const std::shared_ptr<rhi::Buffer>& buffer, int slot, rhi::ShaderStage stage, int offset)
+{
+    ENGINE_ASSERT(buffer);
+    ENGINE_ASSERT(slot < m_buffers.size());
+    ENGINE_ASSERT(stage != rhi::ShaderStage::NONE);
 
-    buffer.m_gpuBuffer = rs.CreateBuffer(descriptor);
+    BufferInfo info{};
+    info.m_gpuBuffer = buffer;
+    info.m_offset = offset;
+    info.m_stage = stage;
 
-    m_pendingBuffers.emplace_back(slot, std::move(buffer));
+    m_pendingBuffers.emplace_back(slot, std::move(info));
     m_dirty = true;
 }
 
@@ -101,19 +112,96 @@ void Material::Sync()
 
     m_gpuMaterial->Sync();
 
-    for (auto&& [slot, _] : m_pendingBuffers)
+    if (!m_pendingBuffers.empty())
     {
-        UpdateBuffer(slot);
+        m_uniformsDirty = true;
     }
 
     m_pendingBuffers.clear();
     m_pendingTextures.clear();
 }
 
-void Material::UpdateBuffer(int slot)
+const rhi::DynamicOffsets& Material::UploadUniforms()
 {
-    auto& info = m_buffers[slot];
-    info.m_gpuBuffer->CopyToBuffer(info.m_cpuBuffer.get_raw_ptr(), info.m_cpuBuffer.get_type().get_sizeof());
+    auto& ring = Instance().Service<RenderService>().UniformRing();
+
+    if (!m_uniformsDirty && m_uniformFrame == ring.Frame())
+    {
+        return m_uniformOffsets;
+    }
+
+    m_uniformOffsets.clear();
+
+    const auto& reflection = m_shader->Descriptor().m_reflection;
+
+    // Dynamic offsets are consumed in binding order, so slots must be visited in ascending order
+    for (int slot = 0; slot < static_cast<int>(m_buffers.size()); ++slot)
+    {
+        auto& info = m_buffers[slot];
+
+        // External buffers have no CPU copy and are not dynamic
+        if (!info.m_cpuBuffer.is_valid())
+        {
+            continue;
+        }
+
+        const auto cpuSize = static_cast<uint32_t>(info.m_cpuBuffer.get_type().get_sizeof());
+        auto size = cpuSize;
+        if (const auto it = reflection.m_bufferMap.find(slot); it != reflection.m_bufferMap.end())
+        {
+            size = std::max(size, it->second.m_size);
+        }
+
+        const auto allocation = ring.Allocate(size);
+
+        // Data isn't uploaded, material is drawn with whatever lies at the beginning of the ring this frame
+        if (allocation.m_data)
+        {
+            memcpy(allocation.m_data, info.m_cpuBuffer.get_raw_ptr(), cpuSize);
+        }
+
+        m_uniformOffsets.push_back(allocation.m_offset);
+    }
+
+    m_uniformFrame = ring.Frame();
+    m_uniformsDirty = false;
+
+    return m_uniformOffsets;
+}
+
+void Material::SetFeatures(const eastl::vector<std::string>& features, uint32_t defaultPermutation)
+{
+    ENGINE_ASSERT(features.size() <= C_MAX_FEATURE_AMOUNT);
+
+    m_features = features;
+    m_defaultPermutation = defaultPermutation;
+    m_permutation = defaultPermutation;
+}
+
+bool Material::SetFeature(std::string_view name, bool enabled)
+{
+    const auto it = eastl::find(m_features.begin(), m_features.end(), name);
+
+    if (it == m_features.end())
+    {
+        return false;
+    }
+
+    const uint32_t bit = 1u << static_cast<uint32_t>(eastl::distance(m_features.begin(), it));
+    m_permutation = enabled ? m_permutation | bit : m_permutation & ~bit;
+    return true;
+}
+
+bool Material::Feature(std::string_view name) const
+{
+    const auto it = eastl::find(m_features.begin(), m_features.end(), name);
+
+    if (it == m_features.end())
+    {
+        return false;
+    }
+
+    return m_permutation & (1u << static_cast<uint32_t>(eastl::distance(m_features.begin(), it)));
 }
 
 } // engine::render
\ No newline at end of file
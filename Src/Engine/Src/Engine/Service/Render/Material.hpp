@@ -9,6 +9,7 @@
 #include <RHI/ShaderDescriptor.hpp>
 #include <RHI/Texture.hpp>
 #include <RHI/Shader.hpp>
+#include <RHI/Device.hpp>
 
 namespace engine::render
 {
@@ -82,7 +83,7 @@ public:
         ENGINE_ASSERT(name == name2);
 
         info.m_cpuBuffer = bufferObject;
-        info.m_gpuBuffer->CopyToBuffer(info.m_cpuBuffer.get_raw_ptr(), info.m_cpuBuffer.get_type().get_sizeof());
+        m_uniformsDirty = true;
     }
 
     template <typename T>
@@ -108,13 +109,46 @@ public:
 
     void SetBuffer(rttr::type type, int slot, rhi::ShaderStage stage, std::string_view name = "", int offset = 0);
 
+    // Binds buffer which is owned and updated outside of the material, e.g. per frame instance data
+    void SetBuffer(const std::shared_ptr<rhi::Buffer>& buffer, int slot, rhi::ShaderStage stage, int offset = 0);
+
+    const std::shared_ptr<rhi::Buffer>& GPUBuffer(int slot) const { return m_buffers[slot].m_gpuBuffer; }
+
     void SetTexture(const std::shared_ptr<rhi::Texture>& texture, uint8_t slot, uint8_t mipLevel = 0);
 
+    // Iterates over synced textures only, pending ones aren't bound yet
+    template <typename F>
+    inline void ForEachTexture(F&& f) const
+    {
+        for (const auto& info : m_textures)
+        {
+            if (info.m_texture)
+            {
+                f(info.m_texture);
+            }
+        }
+    }
+
     void Sync();
 
-private:
-    void UpdateBuffer(int slot);
+    // Copies uniform buffers data to the uniform ring if it was changed or the frame was switched.
+    // Returns dynamic offsets which must be used while binding the material
+    const rhi::DynamicOffsets& UploadUniforms();
+    // Offsets of the last upload, can be read from any thread once uniforms were uploaded in the current frame
+    const rhi::DynamicOffsets& UniformOffsets() const { return m_uniformOffsets; }
+
+    // Feature is a boolean specialization constant of the shader, its index is the bit in the permutation mask.
+    // Pipeline for the permutation is selected by the material loader
+    void SetFeatures(const eastl::vector<std::string>& features, uint32_t defaultPermutation);
+    // Returns false if material has no such feature
+    bool SetFeature(std::string_view name, bool enabled);
+    bool Feature(std::string_view name) const;
 
+    const eastl::vector<std::string>& Features() const { return m_features; }
+    uint32_t Permutation() const { return m_permutation; }
+    uint32_t DefaultPermutation() const { return m_defaultPermutation; }
+
+private:
     struct BufferInfo
     {
         rttr::variant                   m_cpuBuffer;
@@ -135,7 +169,13 @@ private:
     eastl::vector<eastl::pair<uint8_t, TextureInfo>> m_pendingTextures;
     std::shared_ptr<rhi::Shader>                     m_shader;
     std::shared_ptr<rhi::GPUMaterial>                m_gpuMaterial;
+    eastl::vector<std::string>                       m_features;
+    uint32_t                                         m_permutation = 0;
+    uint32_t                                         m_defaultPermutation = 0;
+    rhi::DynamicOffsets                              m_uniformOffsets;
+    uint64_t                                         m_uniformFrame = std::numeric_limits<uint64_t>::max();
     bool                                             m_dirty;
+    bool                                             m_uniformsDirty = true;
 
     inline static MaterialDataStorage                s_storage;
 };
@@ -3,11 +3,30 @@
 namespace engine
 {
 
+render::SubMesh::~SubMesh()
+{
+	if (const auto arena = m_arena.lock())
+	{
+		arena->Free(m_vertices, m_indices);
+	}
+}
+
 void render::Mesh::AddSubMesh(const std::shared_ptr<SubMesh>& submesh)
 {
 	ENGINE_ASSERT(eastl::find(m_submeshes.begin(), m_submeshes.end(), submesh) == m_submeshes.end());
 
 	m_submeshes.emplace_back(submesh);
+
+	m_aabb.Expand(submesh->BoundingBox());
+
+	// Sphere is built around the merged box, so it encloses all submesh spheres
+	m_sphere.m_center = m_aabb.Center();
+	m_sphere.m_radius = 0.0f;
+	for (const auto& sm : m_submeshes)
+	{
+		const auto& sphere = sm->Sphere();
+		m_sphere.m_radius = glm::max(m_sphere.m_radius, glm::length(sphere.m_center - m_sphere.m_center) + sphere.m_radius);
+	}
 }
 
 } // engine
\ No newline at end of file
@@ -1,23 +1,73 @@
 #pragma once
 
 #include <Engine/Config.hpp>
+#include <Engine/Service/Render/GeometryArena.hpp>
 #include <RHI/Device.hpp>
+#include <glm/glm.hpp>
+#include <limits>
 
 namespace engine::render
 {
 
-class ENGINE_API SubMesh
+struct AABB
+{
+    glm::vec3 m_min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 m_max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    bool        Valid() const { return m_min.x <= m_max.x && m_min.y <= m_max.y && m_min.z <= m_max.z; }
+    glm::vec3   Center() const { return (m_min + m_max) * 0.5f; }
+    glm::vec3   Extents() const { return (m_max - m_min) * 0.5f; }
+
+    void Expand(const glm::vec3& point)
+    {
+        m_min = glm::min(m_min, point);
+        m_max = glm::max(m_max, point);
+    }
+
+    void Expand(const AABB& other)
+    {
+        m_min = glm::min(m_min, other.m_min);
+        m_max = glm::max(m_max, other.m_max);
+    }
+};
+
+struct BoundingSphere
+{
+    glm::vec3   m_center = glm::vec3(0.0f);
+    float       m_radius = 0.0f;
+};
+
+// Range of vertices and indices in the geometry arena
+class ENGINE_API SubMesh : public core::NonCopyable
 {
 public:
-    SubMesh(const std::shared_ptr<rhi::Buffer>& vb, const std::shared_ptr<rhi::Buffer>& ib = {}) : m_vertexBuffer(vb), m_indexBuffer(ib)
+    SubMesh(const std::shared_ptr<GeometryArena>& arena, const GeometryArena::Range& vertices, const GeometryArena::Range& indices = {}) :
+        m_arena(arena),
+        m_vertices(vertices),
+        m_indices(indices)
     {}
 
-    const std::shared_ptr<rhi::Buffer>& VertexBuffer() { ENGINE_ASSERT(m_vertexBuffer); return m_vertexBuffer; }
-    const std::shared_ptr<rhi::Buffer>& IndexBuffer() { return m_indexBuffer; }
+    ~SubMesh();
+
+    uint32_t                            VertexOffset() const { return m_vertices.m_offset; }
+    uint32_t                            VertexCount() const { return m_vertices.m_count; }
+    uint32_t                            FirstIndex() const { return m_indices.m_offset; }
+    uint32_t                            IndexCount() const { return m_indices.m_count; }
+    bool                                Indexed() const { return m_indices.Valid(); }
+    // Blocks of the arena which hold the vertices and the indices
+    uint32_t                            VertexBlock() const { return m_vertices.m_block; }
+    uint32_t                            IndexBlock() const { return m_indices.m_block; }
+
+    void                                SetBounds(const AABB& aabb, const BoundingSphere& sphere) { m_aabb = aabb; m_sphere = sphere; }
+    const AABB&                         BoundingBox() const { return m_aabb; }
+    const BoundingSphere&               Sphere() const { return m_sphere; }
 
 private:
-    std::shared_ptr<rhi::Buffer> m_vertexBuffer;
-    std::shared_ptr<rhi::Buffer> m_indexBuffer;
+    std::weak_ptr<GeometryArena> m_arena;
+    GeometryArena::Range         m_vertices;
+    GeometryArena::Range         m_indices;
+    AABB                         m_aabb;
+    BoundingSphere               m_sphere;
 };
 
 class ENGINE_API Mesh
@@ -31,8 +81,14 @@ public:
 
     void AddSubMesh(const std::shared_ptr<SubMesh>& submesh);
 
+    // Bounds of all submeshes
+    const AABB&             BoundingBox() const { return m_aabb; }
+    const BoundingSphere&   Sphere() const { return m_sphere; }
+
 private:
     eastl::vector<std::shared_ptr<SubMesh>> m_submeshes;
+    AABB                                    m_aabb;
+    BoundingSphere                          m_sphere;
 };
 
 } // engine::render
\ No newline at end of file
@@ -0,0 +1,559 @@
+#include <Engine/Service/Render/RenderGraph.hpp>
+#include <Core/Profiling.hpp>
+#include <EASTL/algorithm.h>
+#include <optional>
+
+namespace
+{
+
+struct Access
+{
+    uint32_t    m_pass = 0;
+    bool        m_write = false;
+    // Write which keeps previous content of the attachment
+    bool        m_load = false;
+};
+
+} // unnamed
+
+namespace engine::render
+{
+
+void RenderGraph::Reset()
+{
+    std::lock_guard l(m_mutex);
+
+    ENGINE_ASSERT(!m_passOpen);
+
+    m_passes.clear();
+    m_order.clear();
+    m_pendingCommands.clear();
+}
+
+void RenderGraph::BeginPass(const std::shared_ptr<rhi::RenderPass>& pass, bool offscreen)
+{
+    std::lock_guard l(m_mutex);
+
+    ENGINE_ASSERT(!m_passOpen);
+    ENGINE_ASSERT(pass);
+
+    auto& node = m_passes.emplace_back();
+    node.m_renderPass = pass;
+    node.m_offscreen = offscreen;
+    node.m_commands = std::move(m_pendingCommands);
+
+    m_pendingCommands.clear();
+    m_passOpen = true;
+}
+
+void RenderGraph::EndPass()
+{
+    std::lock_guard l(m_mutex);
+
+    ENGINE_ASSERT(m_passOpen);
+    m_passOpen = false;
+}
+
+void RenderGraph::AddRead(const std::shared_ptr<rhi::Texture>& texture)
+{
+    std::lock_guard l(m_mutex);
+
+    ENGINE_ASSERT(m_passOpen);
+
+    if (!m_attachmentTextures.count(texture.get()))
+    {
+        return;
+    }
+
+    auto& reads = m_passes.back().m_reads;
+
+    if (eastl::find(reads.begin(), reads.end(), texture) == reads.end())
+    {
+        reads.push_back(texture);
+    }
+}
+
+void RenderGraph::Record(Command&& command)
+{
+    std::lock_guard l(m_mutex);
+
+    if (m_passOpen)
+    {
+        m_passes.back().m_commands.emplace_back(std::move(command));
+    }
+    else
+    {
+        m_pendingCommands.emplace_back(std::move(command));
+    }
+}
+
+void RenderGraph::Compile()
+{
+    PROFILER_CPU_ZONE;
+
+    std::lock_guard l(m_mutex);
+
+    ENGINE_ASSERT(!m_passOpen);
+
+    BuildDependencies();
+    Cull();
+    Sort();
+    PlanBarriers();
+    UpdateLifetimes();
+
+    Stats stats;
+    stats.m_passes = static_cast<uint32_t>(m_passes.size());
+    stats.m_culledPasses = stats.m_passes - static_cast<uint32_t>(m_order.size());
+
+    for (const auto index : m_order)
+    {
+        const auto& barriers = m_passes[index].m_barriers;
+        stats.m_barriers += barriers.empty() ? 0 : 1;
+        stats.m_transitions += static_cast<uint32_t>(barriers.size());
+    }
+
+    if (!(stats == m_stats))
+    {
+        core::log::debug("[RenderGraph] {} passes, {} culled, {} barriers with {} transitions", stats.m_passes, stats.m_culledPasses,
+            stats.m_barriers, stats.m_transitions);
+    }
+
+    m_stats = stats;
+}
+
+void RenderGraph::Execute(rhi::Device& device)
+{
+    PROFILER_CPU_ZONE;
+
+    for (const auto index : m_order)
+    {
+        auto& pass = m_passes[index];
+
+        if (!pass.m_barriers.empty())
+        {
+            device.Barrier(pass.m_barriers);
+        }
+
+        for (auto& command : pass.m_commands)
+        {
+            command();
+        }
+    }
+
+    for (auto& command : m_pendingCommands)
+    {
+        command();
+    }
+}
+
+void RenderGraph::RegisterAttachment(const std::string& name, const std::shared_ptr<rhi::Texture>& texture, const std::shared_ptr<rhi::Texture>& memory)
+{
+    std::lock_guard l(m_mutex);
+
+    Attachment attachment;
+    attachment.m_texture = texture;
+    attachment.m_memoryId = m_nextMemoryId++;
+
+    if (memory)
+    {
+        for (const auto& [_, other] : m_attachments)
+        {
+            if (other.m_texture.lock() == memory)
+            {
+                attachment.m_memoryId = other.m_memoryId;
+                break;
+            }
+        }
+    }
+
+    if (const auto it = m_attachments.find(name); it != m_attachments.end())
+    {
+        if (const auto oldTexture = it->second.m_texture.lock())
+        {
+            m_attachmentTextures.erase(oldTexture.get());
+        }
+    }
+
+    m_attachments[name] = attachment;
+    m_attachmentTextures.insert(texture.get());
+}
+
+eastl::vector<std::shared_ptr<rhi::Texture>> RenderGraph::AliasCandidates(const std::string& name) const
+{
+    std::lock_guard l(m_mutex);
+
+    eastl::vector<std::shared_ptr<rhi::Texture>> candidates;
+
+    const auto lifetimeIt = m_lifetimes.find(name);
+
+    if (lifetimeIt == m_lifetimes.end() || !lifetimeIt->second.m_transient)
+    {
+        return candidates;
+    }
+
+    const auto& lifetime = lifetimeIt->second;
+
+    // All attachments living in the memory must be unused while the new one is used
+    const auto memoryFree = [&](uint32_t memoryId)
+        {
+            for (const auto& [otherName, other] : m_attachments)
+            {
+                if (otherName == name || other.m_memoryId != memoryId || other.m_texture.expired())
+                {
+                    continue;
+                }
+
+                const auto it = m_lifetimes.find(otherName);
+
+                if (it == m_lifetimes.end() || !it->second.m_transient || it->second.Overlaps(lifetime))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+    for (const auto& [otherName, other] : m_attachments)
+    {
+        if (otherName == name)
+        {
+            continue;
+        }
+
+        const auto texture = other.m_texture.lock();
+
+        if (texture && memoryFree(other.m_memoryId))
+        {
+            candidates.push_back(texture);
+        }
+    }
+
+    return candidates;
+}
+
+void RenderGraph::BuildDependencies()
+{
+    PROFILER_CPU_ZONE;
+
+    eastl::unordered_map<const rhi::Texture*, eastl::vector<Access>> accesses;
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        auto& pass = m_passes[i];
+        pass.m_dependencies.clear();
+        pass.m_producers.clear();
+        pass.m_culled = false;
+
+        const auto& desc = pass.m_renderPass->Descriptor();
+
+        // Swapchain is written instead of the attachments by the not offscreen passes
+        if (pass.m_offscreen)
+        {
+            for (const auto& attachment : desc.m_colorAttachments)
+            {
+                accesses[attachment.m_texture.get()].push_back({ i, true, attachment.m_loadOperation == rhi::AttachmentLoadOperation::LOAD });
+            }
+
+            if (const auto& depth = desc.m_depthStencilAttachment; depth.m_texture)
+            {
+                accesses[depth.m_texture.get()].push_back({ i, true, depth.m_loadOperation == rhi::AttachmentLoadOperation::LOAD });
+            }
+        }
+
+        for (const auto& texture : pass.m_reads)
+        {
+            // Sampling of own attachment is a feedback loop, it doesn't introduce dependency
+            auto& textureAccesses = accesses[texture.get()];
+            if (textureAccesses.empty() || textureAccesses.back().m_pass != i)
+            {
+                textureAccesses.push_back({ i, false, false });
+            }
+        }
+    }
+
+    const auto addDependency = [&](uint32_t from, uint32_t to, bool data)
+        {
+            if (from == to)
+            {
+                return;
+            }
+
+            m_passes[to].m_dependencies.push_back(from);
+
+            if (data)
+            {
+                m_passes[to].m_producers.push_back(from);
+            }
+        };
+
+    for (const auto& [_, textureAccesses] : accesses)
+    {
+        std::optional<uint32_t> lastWriter;
+        eastl::vector<uint32_t> readersSinceWrite;
+        // Passes which were recorded before any writer read the final content of the frame
+        eastl::vector<uint32_t> earlyReaders;
+
+        for (const auto& access : textureAccesses)
+        {
+            if (access.m_write)
+            {
+                if (lastWriter)
+                {
+                    addDependency(*lastWriter, access.m_pass, access.m_load);
+                }
+
+                for (const auto reader : readersSinceWrite)
+                {
+                    addDependency(reader, access.m_pass, false);
+                }
+
+                lastWriter = access.m_pass;
+                readersSinceWrite.clear();
+            }
+            else if (lastWriter)
+            {
+                addDependency(*lastWriter, access.m_pass, true);
+                readersSinceWrite.push_back(access.m_pass);
+            }
+            else
+            {
+                earlyReaders.push_back(access.m_pass);
+            }
+        }
+
+        if (lastWriter)
+        {
+            for (const auto reader : earlyReaders)
+            {
+                addDependency(*lastWriter, reader, true);
+            }
+        }
+    }
+}
+
+void RenderGraph::Cull()
+{
+    PROFILER_CPU_ZONE;
+
+    eastl::vector<uint32_t> stack;
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        if (!m_passes[i].m_offscreen)
+        {
+            stack.push_back(i);
+        }
+    }
+
+    // Nothing is presented, so there is no way to tell which passes are needed
+    if (stack.empty())
+    {
+        return;
+    }
+
+    eastl::vector<bool> alive(m_passes.size(), false);
+
+    while (!stack.empty())
+    {
+        const auto index = stack.back();
+        stack.pop_back();
+
+        if (alive[index])
+        {
+            continue;
+        }
+
+        alive[index] = true;
+
+        for (const auto producer : m_passes[index].m_producers)
+        {
+            stack.push_back(producer);
+        }
+    }
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        m_passes[i].m_culled = !alive[i];
+    }
+}
+
+void RenderGraph::Sort()
+{
+    PROFILER_CPU_ZONE;
+
+    const auto passCount = static_cast<uint32_t>(m_passes.size());
+
+    eastl::vector<uint32_t> inDegree(passCount, 0);
+    eastl::vector<eastl::vector<uint32_t>> dependents(passCount);
+
+    for (uint32_t i = 0; i < passCount; ++i)
+    {
+        for (const auto dependency : m_passes[i].m_dependencies)
+        {
+            dependents[dependency].push_back(i);
+            ++inDegree[i];
+        }
+    }
+
+    eastl::vector<bool> scheduled(passCount, false);
+    m_order.clear();
+
+    // Kahn's algorithm, the earliest recorded ready pass goes first, so independent passes keep recording order
+    for (uint32_t scheduledCount = 0; scheduledCount < passCount; ++scheduledCount)
+    {
+        uint32_t next = passCount;
+
+        for (uint32_t i = 0; i < passCount; ++i)
+        {
+            if (!scheduled[i] && inDegree[i] == 0)
+            {
+                next = i;
+                break;
+            }
+        }
+
+        if (next == passCount)
+        {
+            core::log::error("[RenderGraph] Passes have cyclic dependencies, the rest of them is executed in recording order");
+
+            for (uint32_t i = 0; i < passCount; ++i)
+            {
+                if (!scheduled[i] && !m_passes[i].m_culled)
+                {
+                    m_order.push_back(i);
+                }
+            }
+            break;
+        }
+
+        scheduled[next] = true;
+
+        for (const auto dependent : dependents[next])
+        {
+            --inDegree[dependent];
+        }
+
+        if (!m_passes[next].m_culled)
+        {
+            m_order.push_back(next);
+        }
+    }
+}
+
+void RenderGraph::PlanBarriers()
+{
+    PROFILER_CPU_ZONE;
+
+    // Layouts which textures will have at the current point of the frame
+    eastl::unordered_map<const rhi::Texture*, rhi::TextureLayout> layouts;
+    m_frameLifetimes.clear();
+
+    for (uint32_t position = 0; position < m_order.size(); ++position)
+    {
+        auto& pass = m_passes[m_order[position]];
+        pass.m_barriers.clear();
+
+        const auto use = [&](const std::shared_ptr<rhi::Texture>& texture, rhi::TextureLayout layout, bool discard)
+            {
+                if (const auto it = m_frameLifetimes.find(texture.get()); it != m_frameLifetimes.end())
+                {
+                    it->second.m_last = position;
+                }
+                else
+                {
+                    m_frameLifetimes[texture.get()] = { position, position, discard };
+                }
+
+                const auto it = layouts.find(texture.get());
+
+                // Discard matters only for aliased textures, device skips it for the rest if layout is the same
+                if (it != layouts.end() && it->second == layout && !discard)
+                {
+                    return;
+                }
+
+                layouts[texture.get()] = layout;
+                pass.m_barriers.push_back({ texture, layout, discard });
+            };
+
+        if (pass.m_offscreen)
+        {
+            const auto& desc = pass.m_renderPass->Descriptor();
+
+            for (const auto& attachment : desc.m_colorAttachments)
+            {
+                use(attachment.m_texture, rhi::TextureLayout::COLOR_ATTACHMENT, attachment.m_loadOperation != rhi::AttachmentLoadOperation::LOAD);
+            }
+
+            if (const auto& depth = desc.m_depthStencilAttachment; depth.m_texture)
+            {
+                use(depth.m_texture, rhi::TextureLayout::DEPTH_STENCIL_ATTACHMENT, depth.m_loadOperation != rhi::AttachmentLoadOperation::LOAD);
+            }
+        }
+
+        for (const auto& texture : pass.m_reads)
+        {
+            use(texture, rhi::TextureLayout::SHADER_READ_ONLY, false);
+        }
+    }
+}
+
+void RenderGraph::UpdateLifetimes()
+{
+    PROFILER_CPU_ZONE;
+
+    m_lifetimes.clear();
+
+    for (auto it = m_attachments.begin(); it != m_attachments.end();)
+    {
+        const auto texture = it->second.m_texture.lock();
+
+        if (!texture)
+        {
+            it = m_attachments.erase(it);
+            continue;
+        }
+
+        if (const auto lifetimeIt = m_frameLifetimes.find(texture.get()); lifetimeIt != m_frameLifetimes.end())
+        {
+            m_lifetimes[it->first] = lifetimeIt->second;
+        }
+
+        ++it;
+    }
+
+    m_aliasingBroken = false;
+
+    for (const auto& [name, attachment] : m_attachments)
+    {
+        const auto lifetimeIt = m_lifetimes.find(name);
+
+        if (lifetimeIt == m_lifetimes.end())
+        {
+            continue;
+        }
+
+        for (const auto& [otherName, other] : m_attachments)
+        {
+            if (otherName == name || other.m_memoryId != attachment.m_memoryId)
+            {
+                continue;
+            }
+
+            const auto otherLifetimeIt = m_lifetimes.find(otherName);
+
+            if (otherLifetimeIt == m_lifetimes.end())
+            {
+                continue;
+            }
+
+            if (!lifetimeIt->second.m_transient || !otherLifetimeIt->second.m_transient || lifetimeIt->second.Overlaps(otherLifetimeIt->second))
+            {
+                core::log::warning("[RenderGraph] Attachments '{}' and '{}' share memory, but are used at the same time", name, otherName);
+                m_aliasingBroken = true;
+            }
+        }
+    }
+}
+
+} // engine::render
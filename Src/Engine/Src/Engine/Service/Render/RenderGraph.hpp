@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Engine/Config.hpp>
+#include <Core/Type.hpp>
+#include <RHI/Device.hpp>
+#include <RHI/RenderPass.hpp>
+#include <EASTL/vector.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/unordered_set.h>
+#include <functional>
+#include <mutex>
+
+namespace engine::render
+{
+
+// Graph of the graphics passes of one frame. Commands of the passes are recorded during the frame and executed once the graph
+// is compiled: passes are ordered by the attachments they write and the textures they sample, passes which don't contribute
+// to the swapchain are culled, and attachments are transitioned by one batched barrier before each pass only if layout changes.
+// Content which is sampled only in the next frames isn't tracked, so the pass producing it would be culled.
+// Lifetimes of the attachments are kept between frames to find the ones which memory can be shared (aliased)
+class ENGINE_API RenderGraph : public core::NonCopyable
+{
+public:
+    using Command = std::function<void()>;
+
+    struct Stats
+    {
+        uint32_t    m_passes = 0;
+        uint32_t    m_culledPasses = 0;
+        // Batched barriers and layout transitions in them, transitions to the layout texture is already in are skipped by device
+        uint32_t    m_barriers = 0;
+        uint32_t    m_transitions = 0;
+
+        bool operator==(const Stats& other) const
+        {
+            return m_passes == other.m_passes
+                && m_culledPasses == other.m_culledPasses
+                && m_barriers == other.m_barriers
+                && m_transitions == other.m_transitions;
+        }
+    };
+
+    // Drops passes of the previous frame, must be called before the new frame is recorded
+    void                            Reset();
+
+    // Commands recorded until EndPass are executed inside of the pass. Not offscreen pass draws to the swapchain and is never culled
+    void                            BeginPass(const std::shared_ptr<rhi::RenderPass>& pass, bool offscreen);
+    void                            EndPass();
+    // Marks texture as sampled by the open pass, textures which aren't registered attachments are ignored
+    void                            AddRead(const std::shared_ptr<rhi::Texture>& texture);
+    // Commands recorded outside of the passes are executed right before the next pass, e.g. vertex buffers binding
+    void                            Record(Command&& command);
+
+    // Must be called once all passes of the frame are recorded
+    void                            Compile();
+    // Must be called on the render thread after Compile
+    void                            Execute(rhi::Device& device);
+
+    // Attachments are tracked by name, so their lifetimes survive reallocation on resize.
+    // Memory must be set if texture was created in the memory of the other attachment
+    void                            RegisterAttachment(const std::string& name, const std::shared_ptr<rhi::Texture>& texture,
+                                                       const std::shared_ptr<rhi::Texture>& memory = {});
+    // Attachments which memory can be shared with the new attachment of the given name, it is based on the lifetimes from the last frame.
+    // Only attachments which content is discarded every frame are aliased
+    eastl::vector<std::shared_ptr<rhi::Texture>> AliasCandidates(const std::string& name) const;
+    // True if attachments sharing memory were used at the same time in the last frame, they must be reallocated then
+    bool                            AliasingBroken() const { return m_aliasingBroken; }
+
+    const Stats&                    GetStats() const { return m_stats; }
+
+private:
+    struct Pass
+    {
+        std::shared_ptr<rhi::RenderPass>                m_renderPass;
+        eastl::vector<Command>                          m_commands;
+        eastl::vector<std::shared_ptr<rhi::Texture>>    m_reads;
+        eastl::vector<rhi::TextureBarrier>              m_barriers;
+        // Passes which must be executed before this one
+        eastl::vector<uint32_t>                         m_dependencies;
+        // Passes which content is used by this one, culling follows only them
+        eastl::vector<uint32_t>                         m_producers;
+        bool                                            m_offscreen = true;
+        bool                                            m_culled = false;
+    };
+
+    // Positions of the first and the last passes using the attachment in the execution order
+    struct Lifetime
+    {
+        uint32_t    m_first = 0;
+        uint32_t    m_last = 0;
+        // First use of the attachment in the frame discards its content
+        bool        m_transient = false;
+
+        bool Overlaps(const Lifetime& other) const
+        {
+            return m_first <= other.m_last && other.m_first <= m_last;
+        }
+    };
+
+    struct Attachment
+    {
+        std::weak_ptr<rhi::Texture> m_texture;
+        // Attachments with the same id share memory
+        uint32_t                    m_memoryId = 0;
+    };
+
+    void                            BuildDependencies();
+    void                            Cull();
+    void                            Sort();
+    void                            PlanBarriers();
+    void                            UpdateLifetimes();
+
+    mutable std::mutex                                      m_mutex;
+    eastl::vector<Pass>                                     m_passes;
+    // Indices of the passes which aren't culled, in the execution order
+    eastl::vector<uint32_t>                                 m_order;
+    eastl::vector<Command>                                  m_pendingCommands;
+    bool                                                    m_passOpen = false;
+
+    eastl::unordered_map<std::string, Attachment>           m_attachments;
+    eastl::unordered_set<const rhi::Texture*>               m_attachmentTextures;
+    eastl::unordered_map<const rhi::Texture*, Lifetime>     m_frameLifetimes;
+    eastl::unordered_map<std::string, Lifetime>             m_lifetimes;
+    uint32_t                                                m_nextMemoryId = 0;
+    bool                                                    m_aliasingBroken = false;
+
+    Stats                                                   m_stats;
+};
+
+} // engine::render
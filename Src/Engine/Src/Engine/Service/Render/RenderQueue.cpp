@@ -0,0 +1,201 @@
+#include <Engine/Service/Render/RenderQueue.hpp>
+#include <Engine/Assert.hpp>
+#include <Core/Profiling.hpp>
+#include <Core/Log.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace
+{
+
+constexpr uint32_t C_RADIX_BITS = 8;
+constexpr uint32_t C_RADIX_SIZE = 1 << C_RADIX_BITS;
+constexpr uint32_t C_RADIX_PASSES = sizeof(uint64_t) * 8 / C_RADIX_BITS;
+constexpr uint32_t C_MAX_ID = std::numeric_limits<uint16_t>::max();
+constexpr uint32_t C_MIN_ID_SLOTS = 256;
+
+// Fibonacci hashing of the address, low bits are always zero because of the alignment
+size_t SlotIndex(const void* object, size_t mask)
+{
+    return static_cast<size_t>((reinterpret_cast<uintptr_t>(object) >> 4) * 11400714819323198485ull) & mask;
+}
+
+} // unnamed
+
+namespace engine::render
+{
+
+void RenderQueue::Clear()
+{
+    m_items.clear();
+    m_order.clear();
+
+    // Ids are rebuilt every frame, so destroyed objects don't keep their ids and new objects at the same address get fresh ones
+    m_passIds.Clear();
+    m_materialIds.Clear();
+    m_meshIds.Clear();
+}
+
+void RenderQueue::Push(const DrawItem& item)
+{
+    m_items.push_back(item);
+}
+
+void RenderQueue::Sort()
+{
+    PROFILER_CPU_ZONE;
+
+    const auto size = static_cast<uint32_t>(m_items.size());
+
+    m_order.resize(size);
+    m_tmpOrder.resize(size);
+
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        m_order[i] = i;
+    }
+
+    // Build histograms for all digits with a single pass over the keys
+    uint32_t histograms[C_RADIX_PASSES][C_RADIX_SIZE] = {};
+
+    for (const auto& item : m_items)
+    {
+        for (uint32_t pass = 0; pass < C_RADIX_PASSES; ++pass)
+        {
+            ++histograms[pass][(item.m_key >> (pass * C_RADIX_BITS)) & (C_RADIX_SIZE - 1)];
+        }
+    }
+
+    // LSD radix sort, passes where all keys have the same digit are skipped
+    for (uint32_t pass = 0; pass < C_RADIX_PASSES; ++pass)
+    {
+        auto& histogram = histograms[pass];
+        const uint32_t shift = pass * C_RADIX_BITS;
+
+        if (size == 0 || histogram[(m_items[0].m_key >> shift) & (C_RADIX_SIZE - 1)] == size)
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (auto& count : histogram)
+        {
+            const uint32_t current = count;
+            count = offset;
+            offset += current;
+        }
+
+        for (const auto index : m_order)
+        {
+            const auto digit = (m_items[index].m_key >> shift) & (C_RADIX_SIZE - 1);
+            m_tmpOrder[histogram[digit]++] = index;
+        }
+
+        m_order.swap(m_tmpOrder);
+    }
+}
+
+std::optional<uint16_t> RenderQueue::PassId(const void* pass)
+{
+    return UniqueId(m_passIds, pass, "passes");
+}
+
+std::optional<uint16_t> RenderQueue::MaterialId(const void* material)
+{
+    return UniqueId(m_materialIds, material, "materials");
+}
+
+uint16_t RenderQueue::MeshId(const void* mesh)
+{
+    return static_cast<uint16_t>(std::min(m_meshIds.Get(mesh), C_MAX_ID));
+}
+
+std::optional<uint16_t> RenderQueue::UniqueId(IdMap& ids, const void* object, std::string_view type)
+{
+    const uint32_t id = ids.Get(object);
+
+    if (id > C_MAX_ID)
+    {
+        // Reported once per frame, ids are rebuilt on Clear
+        if (id == C_MAX_ID + 1)
+        {
+            core::log::error("[RenderQueue] More than {} {} are drawn in the frame, the rest of them are skipped", C_MAX_ID + 1, type);
+        }
+        return std::nullopt;
+    }
+
+    return static_cast<uint16_t>(id);
+}
+
+uint32_t RenderQueue::IdMap::Get(const void* object)
+{
+    ENGINE_ASSERT(object);
+
+    if ((m_size + 1) * 2 > m_slots.size())
+    {
+        Grow();
+    }
+
+    const size_t mask = m_slots.size() - 1;
+    size_t index = SlotIndex(object, mask);
+
+    while (m_slots[index].m_object && m_slots[index].m_object != object)
+    {
+        index = (index + 1) & mask;
+    }
+
+    auto& slot = m_slots[index];
+
+    if (!slot.m_object)
+    {
+        slot.m_object = object;
+        slot.m_id = m_size++;
+    }
+
+    return slot.m_id;
+}
+
+void RenderQueue::IdMap::Clear()
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    std::fill(m_slots.begin(), m_slots.end(), Slot{});
+    m_size = 0;
+}
+
+void RenderQueue::IdMap::Grow()
+{
+    eastl::vector<Slot> slots;
+    slots.swap(m_slots);
+    m_slots.resize(std::max<size_t>(C_MIN_ID_SLOTS, slots.size() * 2));
+
+    const size_t mask = m_slots.size() - 1;
+    for (const auto& slot : slots)
+    {
+        if (!slot.m_object)
+        {
+            continue;
+        }
+
+        size_t index = SlotIndex(slot.m_object, mask);
+        while (m_slots[index].m_object)
+        {
+            index = (index + 1) & mask;
+        }
+        m_slots[index] = slot;
+    }
+}
+
+uint64_t RenderQueue::MakeKey(uint16_t pass, uint16_t material, uint16_t mesh, uint16_t depth)
+{
+    return static_cast<uint64_t>(pass) << 48
+        | static_cast<uint64_t>(material) << 32
+        | static_cast<uint64_t>(mesh) << 16
+        | static_cast<uint64_t>(depth);
+}
+
+} // engine::render
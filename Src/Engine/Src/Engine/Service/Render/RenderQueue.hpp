@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Engine/Config.hpp>
+#include <Core/Type.hpp>
+#include <EASTL/vector.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace rhi
+{
+class Pipeline;
+} // rhi
+
+namespace engine
+{
+class MaterialResource;
+} // engine
+
+namespace engine::render
+{
+
+class SubMesh;
+
+// Persistent list of draw items which is reused between frames.
+// Items are sorted by 64 bit key: [pass 16 bits][material 16 bits][mesh 16 bits][depth 16 bits].
+// Material permutations use different pipelines with the same render pass, so items are grouped by pass to begin it once
+class ENGINE_API RenderQueue : public core::NonCopyable
+{
+public:
+    struct DrawItem
+    {
+        uint64_t                                    m_key = 0;
+        const rhi::Pipeline*                        m_pipeline = nullptr;
+        // Points to the material owned by the drawn component, so no ref counting is required while the queue is built
+        const std::shared_ptr<MaterialResource>*    m_material = nullptr;
+        SubMesh*                                    m_submesh = nullptr;
+        const glm::mat4*                            m_transform = nullptr;
+    };
+
+    void                Clear();
+
+    void                Push(const DrawItem& item);
+
+    // Radix sorts items by their keys, sorting is stable
+    void                Sort();
+
+    size_t              Size() const { return m_items.size(); }
+    bool                Empty() const { return m_items.empty(); }
+
+    // Returns item in sorted order
+    const DrawItem&     operator[](size_t index) const { return m_items[m_order[index]]; }
+
+    // Return 16 bit ids used to build sort keys, ids are valid until the next Clear.
+    // Items of the same pass and of the same material are processed as contiguous ranges after sorting, so their ids must be unique.
+    // Null is returned once all ids of the frame are used, the item mustn't be drawn then
+    std::optional<uint16_t> PassId(const void* pass);
+    std::optional<uint16_t> MaterialId(const void* material);
+    // Meshes past the limit share the last id, it only makes instanced runs shorter
+    uint16_t                MeshId(const void* mesh);
+
+    static uint64_t     MakeKey(uint16_t pass, uint16_t material, uint16_t mesh, uint16_t depth);
+
+private:
+    // Open addressing table which keeps its storage between frames, so ids are assigned without allocations
+    class IdMap
+    {
+    public:
+        // New objects get the next id
+        uint32_t    Get(const void* object);
+        void        Clear();
+
+    private:
+        struct Slot
+        {
+            const void* m_object = nullptr;
+            uint32_t    m_id = 0;
+        };
+
+        void        Grow();
+
+        eastl::vector<Slot> m_slots;
+        uint32_t            m_size = 0;
+    };
+
+    static std::optional<uint16_t> UniqueId(IdMap& ids, const void* object, std::string_view type);
+
+    eastl::vector<DrawItem>                         m_items;
+    eastl::vector<uint32_t>                         m_order;
+    eastl::vector<uint32_t>                         m_tmpOrder;
+    IdMap                                           m_passIds;
+    IdMap                                           m_materialIds;
+    IdMap                                           m_meshIds;
+};
+
+} // engine::render
@@ -1,5 +1,8 @@
 #include <Engine/Service/Render/RenderService.hpp>
 #include <Engine/Service/Render/Material.hpp>
+#include <Engine/Service/Render/UniformRing.hpp>
+#include <Engine/Service/Render/GeometryArena.hpp>
+#include <Engine/Service/Render/RenderGraph.hpp>
 #include <Engine/Service/Window/WindowService.hpp>
 #include <Engine/Service/Filesystem/VirtualFilesystemService.hpp>
 #include <Engine/Service/Imgui/ImguiService.hpp>
@@ -8,11 +11,27 @@
 #include <Engine/Engine.hpp>
 #include <RHI/Pipeline.hpp>
 #include <RHI/GPUMaterial.hpp>
+#include <EASTL/fixed_vector.h>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
 
 RTTR_REGISTRATION
 {
 engine::registration::Service<engine::RenderService>("engine::RenderService")
     .Domain(engine::Domain::UI);
+
+engine::registration::CommandLineArgs()
+            .Argument(
+                engine::registration::CommandLineArg("-fif", "--frames-in-flight")
+                .Help("Amount of frames CPU may record ahead of GPU, from 1 to 3")
+                .DefaultValue("2")
+            )
+            .Argument(
+                engine::registration::CommandLineArg("-rl", "--render-latency")
+                .Help("Amount of frames render thread may submit behind simulation, 0 or 1")
+                .DefaultValue("1")
+            );
 }
 
 namespace
@@ -30,6 +49,13 @@ const eastl::vector<float> presentVBRaw =
 };
 
 constexpr uint32_t C_MAX_RESOLUTION = 65536;
+constexpr uint32_t C_UNIFORM_RING_FRAME_SIZE = 4 * 1024 * 1024;
+constexpr uint32_t C_GEOMETRY_ARENA_VERTEX_SIZE = 256 * 1024 * 1024;
+constexpr uint32_t C_GEOMETRY_ARENA_INDEX_SIZE = 64 * 1024 * 1024;
+constexpr std::string_view C_PIPELINE_CACHE_PATH = "/System/Cache/pipeline.cache";
+constexpr uint32_t C_MAX_PUSH_CONSTANT_SIZE = 128;
+// Attachments are reallocated only when viewport size stays the same for this time, e.g. while editor splitter is dragged
+constexpr auto C_RESIZE_DEBOUNCE_INTERVAL = std::chrono::milliseconds(150);
 
 inline engine::MaterialLoader& GetMaterialLoader()
 {
@@ -46,6 +72,9 @@ struct RenderService::Impl
     std::shared_ptr<rhi::Device>            m_device;
     std::shared_ptr<rhi::Sampler>           m_defaultSampler;
     std::shared_ptr<rhi::IContext>          m_context;
+    std::unique_ptr<render::UniformRing>    m_uniformRing;
+    std::shared_ptr<render::GeometryArena>  m_geometryArena;
+    render::RenderGraph                     m_graph;
 
     std::shared_ptr<rhi::Buffer>            m_presentVB;
     std::shared_ptr<rhi::Texture>           m_texture;
@@ -58,14 +87,21 @@ struct RenderService::Impl
     std::mutex                              m_pipelineGetterMutex;
 
     glm::ivec2                              m_newResolution;
+    std::chrono::steady_clock::time_point   m_resizeRequestTime;
     bool                                    m_resizeRequested = true;
+
+    // Previous frame is submitted on the render thread while the next one is simulated if set
+    bool                                    m_pipelined = true;
+    bool                                    m_frameBegun = false;
+
+    render::RenderThread::Stats             m_renderThreadStats;
 };
 
 RenderService::RenderService()
 {
     m_impl = std::make_unique<Impl>();
 
-    m_renderThread = Instance().Service<ThreadService>().SpawnThread("Render Thread");
+    m_renderThread = std::make_unique<render::RenderThread>("Render Thread");
 
     RunOnRenderThreadWait([]()
         {
@@ -94,15 +130,50 @@ RenderService::RenderService()
     initCtx.m_requiredExtensions = std::move(extensions);
 
     m_impl->m_context = rhi::vulkan::CreateContext(std::move(initCtx));
-    m_impl->m_device = rhi::Device::Create(m_impl->m_context);
+    rhi::Device::Options deviceOptions;
+    deviceOptions.m_pipelineCachePath = Instance().Service<io::VirtualFilesystemService>().Absolute(C_PIPELINE_CACHE_PATH).generic_u8string();
+    deviceOptions.m_framesInFlight = static_cast<uint8_t>(std::clamp(std::atoi(registration::CommandLineArgs::Get("--frames-in-flight").c_str()),
+                                                                     1, static_cast<int>(rhi::C_MAX_FRAMES_IN_FLIGHT)));
+
+    m_impl->m_device = rhi::Device::Create(m_impl->m_context, deviceOptions);
+    m_impl->m_pipelined = std::atoi(registration::CommandLineArgs::Get("--render-latency").c_str()) > 0;
 
     m_impl->m_defaultSampler = m_impl->m_device->CreateSampler({});
+
+    const auto& params = m_impl->m_device->m_parameters;
+
+    rhi::BufferDescriptor ringDesc{};
+    ringDesc.m_size = C_UNIFORM_RING_FRAME_SIZE * params.m_framesInFlight;
+    ringDesc.m_memoryType = rhi::MemoryType::CPU_GPU;
+    ringDesc.m_type = rhi::BufferType::UNIFORM;
+    ringDesc.m_name = "UniformRing";
+
+    m_impl->m_uniformRing = std::make_unique<render::UniformRing>(m_impl->m_device->CreateBuffer(ringDesc, nullptr),
+                                                                  params.m_framesInFlight,
+                                                                  params.m_minUniformBufferAlignment);
+
+    rhi::BufferDescriptor arenaVBDesc{};
+    arenaVBDesc.m_size = C_GEOMETRY_ARENA_VERTEX_SIZE;
+    arenaVBDesc.m_memoryType = rhi::MemoryType::GPU_ONLY;
+    arenaVBDesc.m_type = rhi::BufferType::VERTEX;
+    arenaVBDesc.m_name = "GeometryArena VB";
+
+    rhi::BufferDescriptor arenaIBDesc{};
+    arenaIBDesc.m_size = C_GEOMETRY_ARENA_INDEX_SIZE;
+    arenaIBDesc.m_memoryType = rhi::MemoryType::GPU_ONLY;
+    arenaIBDesc.m_type = rhi::BufferType::INDEX;
+    arenaIBDesc.m_name = "GeometryArena IB";
+
+    m_impl->m_geometryArena = std::make_shared<render::GeometryArena>(m_impl->m_device->CreateBuffer(arenaVBDesc, nullptr),
+                                                                      m_impl->m_device->CreateBuffer(arenaIBDesc, nullptr));
 }
 
 RenderService::~RenderService()
 {
-    m_impl->m_device->WaitForIdle();
+    WaitAll();
     m_impl->m_defaultSampler.reset();
+    m_impl->m_uniformRing.reset();
+    m_impl->m_geometryArena.reset();
     m_impl->m_device.reset();
     m_impl->m_context.reset();
     m_impl.reset();
@@ -112,16 +183,57 @@ void RenderService::Update(float dt)
 {
     PROFILER_CPU_ZONE;
 
-    if (m_impl->m_resizeRequested)
+    m_impl->m_renderThreadStats = m_renderThread->TakeStats();
+    PROFILER_PLOT("Render thread sync points", static_cast<int64_t>(m_impl->m_renderThreadStats.m_syncPoints));
+    PROFILER_PLOT("Render thread commands", static_cast<int64_t>(m_impl->m_renderThreadStats.m_commands));
+
+    m_impl->m_frameBegun = false;
+
+    if (!m_impl->m_pipelined)
+    {
+        BeginRenderFrame();
+    }
+}
+
+void RenderService::BeginRenderFrame()
+{
+    if (m_impl->m_frameBegun)
+    {
+        return;
+    }
+
+    PROFILER_CPU_ZONE;
+
+    m_renderThread->WaitForAll();
+    m_impl->m_frameBegun = true;
+
+    if (m_impl->m_resizeRequested && std::chrono::steady_clock::now() - m_impl->m_resizeRequestTime >= C_RESIZE_DEBOUNCE_INTERVAL)
     {
         PROFILER_CPU_ZONE_NAME("Resize render resources");
 
         ENGINE_ASSERT(m_impl->m_newResolution != glm::ivec2());
-        m_impl->m_device->WaitForIdle();
+        // Old attachments are retired by the material loader until frames in flight are finished, so there is no need to wait for idle
         CreateRenderResources(m_impl->m_newResolution);
         m_impl->m_resizeRequested = false;
     }
 
+    if (m_impl->m_graph.AliasingBroken())
+    {
+        PROFILER_CPU_ZONE_NAME("Reallocate aliased attachments");
+
+        core::log::warning("[RenderService] Aliased attachments are used at the same time, reallocating them");
+        WaitAll();
+        CreateWindowResources(Instance().Service<WindowService>().Extent());
+
+        if (m_impl->m_newResolution != glm::ivec2())
+        {
+            CreateRenderResources(m_impl->m_newResolution);
+        }
+    }
+
+    m_impl->m_graph.Reset();
+    m_impl->m_uniformRing->NextFrame();
+    m_impl->m_geometryArena->NextFrame(m_impl->m_device->m_parameters.m_framesInFlight);
     m_impl->m_device->BeginFrame();
 }
 
@@ -129,6 +241,8 @@ void RenderService::PostUpdate(float dt)
 {
     PROFILER_CPU_ZONE;
 
+    BeginRenderFrame();
+
     BeginPass(m_impl->m_presentMaterial);
     BindMaterial(m_impl->m_presentMaterial);
     
@@ -137,104 +251,118 @@ void RenderService::PostUpdate(float dt)
     
     EndPass(m_impl->m_presentMaterial);
 
+    m_impl->m_graph.Compile();
+
     RunOnRenderThread([=]
         {
+            m_impl->m_graph.Execute(*m_impl->m_device);
             m_impl->m_device->EndFrame();
             m_impl->m_device->Present();
         });
 
+    // Otherwise the frame is waited for once the next one is begun, so simulation of the next frame overlaps with submission
+    if (!m_impl->m_pipelined)
     {
-        PROFILER_CPU_ZONE_NAME("Wait for render thread");
         m_renderThread->WaitForAll();
     }
 }
 
 RPtr<rhi::ShaderCompiler> RenderService::CreateShaderCompiler(const rhi::ShaderCompiler::Options& options)
 {
-    return RunOnRenderThreadWait([&]()
-        {
-            return m_impl->m_device->CreateShaderCompiler(options);
-        });
+    return m_impl->m_device->CreateShaderCompiler(options);
 }
 
+// Device creation methods are thread safe, so resources are created on the calling thread, e.g. by background loaders,
+// without waiting for the render thread
 RPtr<rhi::Buffer> RenderService::CreateBuffer(const rhi::BufferDescriptor& desc, const void* data)
 {
     ENGINE_ASSERT(!desc.m_name.empty());
 
-    return RunOnRenderThreadWait([&]()
-        {
-            return m_impl->m_device->CreateBuffer(desc, data);
-        });
+    return m_impl->m_device->CreateBuffer(desc, data);
 }
 
 RPtr<rhi::Texture> RenderService::CreateTexture(const rhi::TextureDescriptor& desc, const std::shared_ptr<rhi::Sampler>& sampler, const void* data)
 {
-    if (sampler)
-    {
-        return RunOnRenderThreadWait([&]()
-            {
-                return m_impl->m_device->CreateTexture(desc, sampler, data);
-            });
-    }
-    return RunOnRenderThreadWait([&]()
-        {
-            return m_impl->m_device->CreateTexture(desc, m_impl->m_defaultSampler, data);
-        });
+    return m_impl->m_device->CreateTexture(desc, sampler ? sampler : m_impl->m_defaultSampler, data);
 }
 
 RPtr<rhi::Shader> RenderService::CreateShader(const rhi::ShaderDescriptor& desc)
 {
     ENGINE_ASSERT(!desc.m_name.empty());
 
-    return RunOnRenderThreadWait([&]()
-        {
-            return m_impl->m_device->CreateShader(desc);
-        });
+    return m_impl->m_device->CreateShader(desc);
 }
 
 RPtr<rhi::Sampler> RenderService::CreateSampler(const rhi::SamplerDescriptor& desc)
 {
-    return RunOnRenderThreadWait([&]()
-        {
-            return m_impl->m_device->CreateSampler(desc);
-        });
+    return m_impl->m_device->CreateSampler(desc);
 }
 
 RPtr<rhi::RenderPass> RenderService::CreateRenderPass(const rhi::RenderPassDescriptor& desc)
 {
-    return RunOnRenderThreadWait([&]()
-        {
-            return m_impl->m_device->CreateRenderPass(desc);
-        });
+    return m_impl->m_device->CreateRenderPass(desc);
 }
 
 RPtr<rhi::Pipeline> RenderService::CreatePipeline(const rhi::PipelineDescriptor& desc)
 {
-    return RunOnRenderThreadWait([&]()
-        {
-            return m_impl->m_device->CreatePipeline(desc);
-        });
+    PROFILER_CPU_ZONE;
+
+    return m_impl->m_device->CreatePipeline(desc);
 }
 
 RPtr<rhi::GPUMaterial> RenderService::CreateGPUMaterial(const std::shared_ptr<rhi::Shader>& shader)
 {
-    return RunOnRenderThreadWait([&]()
+    return m_impl->m_device->CreateGPUMaterial(shader);
+}
+
+RPtr<rhi::Texture> RenderService::CreateAttachment(const rhi::TextureDescriptor& desc, const std::string& name)
+{
+    PROFILER_CPU_ZONE;
+
+    const auto candidates = m_impl->m_graph.AliasCandidates(name);
+
+    for (const auto& candidate : candidates)
+    {
+        const auto texture = m_impl->m_device->CreateAliasedTexture(desc, m_impl->m_defaultSampler, candidate);
+
+        if (texture)
         {
-            return m_impl->m_device->CreateGPUMaterial(shader);
-        });
+            core::log::debug("[RenderService] Attachment '{}' shares memory with the other attachment", name);
+            m_impl->m_graph.RegisterAttachment(name, texture, candidate);
+            return texture;
+        }
+    }
+
+    const auto texture = CreateTexture(desc);
+    m_impl->m_graph.RegisterAttachment(name, texture);
+    return texture;
 }
 
-void RenderService::BeginPass(const ResPtr<MaterialResource>& material)
+void RenderService::UpdateBuffer(const std::shared_ptr<rhi::Buffer>& buffer, const void* data, uint32_t size, uint32_t offset)
 {
-    RunOnRenderThread([=]()
+    // Buffer is used only by the commands pushed after this one, so there is no need to wait
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    eastl::vector<uint8_t> copy(bytes, bytes + size);
+
+    RunOnRenderThread([=, copy = std::move(copy)]()
         {
-            m_impl->m_device->BeginPipeline(Pipeline(material));
+            m_impl->m_device->UpdateBuffer(buffer, copy.data(), size, offset);
         });
 }
 
+// Graphics commands are recorded to the render graph and executed on the render thread once the frame is compiled.
+// Compute passes aren't part of the graph, they are executed on the render thread right away
+void RenderService::BeginPass(const ResPtr<MaterialResource>& material)
+{
+    BeginPass(Pipeline(material));
+}
+
 void RenderService::BeginPass(const std::shared_ptr<rhi::Pipeline>& pipeline)
 {
-    RunOnRenderThread([=]()
+    BeginRenderFrame();
+
+    m_impl->m_graph.BeginPass(pipeline->Descriptor().m_pass, pipeline->Descriptor().m_offscreen);
+    m_impl->m_graph.Record([=]()
         {
             m_impl->m_device->BeginPipeline(pipeline);
         });
@@ -242,18 +370,24 @@ void RenderService::BeginPass(const std::shared_ptr<rhi::Pipeline>& pipeline)
 
 void RenderService::EndPass(const ResPtr<MaterialResource>& material)
 {
-    RunOnRenderThread([=]()
-        {
-            m_impl->m_device->EndPipeline(Pipeline(material));
-        });
+    EndPass(Pipeline(material));
 }
 
 void RenderService::EndPass(const std::shared_ptr<rhi::Pipeline>& pipeline)
 {
-    RunOnRenderThread([=]()
+    m_impl->m_graph.Record([=]()
         {
             m_impl->m_device->EndPipeline(pipeline);
         });
+    m_impl->m_graph.EndPass();
+}
+
+void RenderService::BindPipeline(const std::shared_ptr<rhi::Pipeline>& pipeline)
+{
+    m_impl->m_graph.Record([=]()
+        {
+            m_impl->m_device->BindPipeline(pipeline);
+        });
 }
 
 void RenderService::BeginComputePass(const ResPtr<MaterialResource>& material)
@@ -297,19 +431,51 @@ void RenderService::PushConstantComputeImmediate(const void* data, uint32_t size
         });
 }
 
-void RenderService::Draw(const std::shared_ptr<rhi::Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount)
+void RenderService::Draw(const std::shared_ptr<rhi::Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance)
 {
-    RunOnRenderThread([=]()
+    m_impl->m_graph.Record([=]()
         {
-            m_impl->m_device->Draw(buffer, vertexCount, instanceCount);
+            m_impl->m_device->Draw(buffer, vertexCount, instanceCount, firstInstance);
         });
 }
 
-void RenderService::Draw(const std::shared_ptr<rhi::Buffer>& vb, const std::shared_ptr<rhi::Buffer>& ib, uint32_t instanceCount)
+void RenderService::Draw(const std::shared_ptr<rhi::Buffer>& vb, const std::shared_ptr<rhi::Buffer>& ib, uint32_t instanceCount, uint32_t firstInstance)
 {
-    RunOnRenderThread([=]()
+    m_impl->m_graph.Record([=]()
+        {
+            m_impl->m_device->Draw(vb, ib, ib->Descriptor().m_size / sizeof(uint32_t), instanceCount, firstInstance);
+        });
+}
+
+void RenderService::BindVertexBuffer(const std::shared_ptr<rhi::Buffer>& buffer)
+{
+    m_impl->m_graph.Record([=]()
+        {
+            m_impl->m_device->BindVertexBuffer(buffer);
+        });
+}
+
+void RenderService::BindIndexBuffer(const std::shared_ptr<rhi::Buffer>& buffer)
+{
+    m_impl->m_graph.Record([=]()
+        {
+            m_impl->m_device->BindIndexBuffer(buffer);
+        });
+}
+
+void RenderService::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+    m_impl->m_graph.Record([=]()
+        {
+            m_impl->m_device->Draw(vertexCount, instanceCount, firstVertex, firstInstance);
+        });
+}
+
+void RenderService::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+    m_impl->m_graph.Record([=]()
         {
-            m_impl->m_device->Draw(vb, ib, ib->Descriptor().m_size / sizeof(uint32_t), instanceCount);
+            m_impl->m_device->DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
         });
 }
 
@@ -333,37 +499,141 @@ void RenderService::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_
 void RenderService::BindMaterial(const ResPtr<MaterialResource>& material)
 {
     auto& pipeline = Pipeline(material);
+    const auto offsets = material->Material()->UploadUniforms();
 
-    RunOnRenderThread([=]()
+    material->Material()->ForEachTexture([this](const auto& texture)
         {
-            if (const auto gpuMaterial = material->Material()->GPUMaterial())
-            {
-                m_impl->m_device->BindGPUMaterial(material->Material()->GPUMaterial(), pipeline);
-            }
+            m_impl->m_graph.AddRead(texture);
+        });
+
+    const auto& gpuMaterial = material->Material()->GPUMaterial();
+
+    if (!gpuMaterial)
+    {
+        return;
+    }
+
+    // Graph is executed while the caller may already sync the material for the next frame, so the set is resolved here.
+    // Objects are captured to keep the handles alive until the command is recorded
+    m_impl->m_graph.Record([this, gpuMaterial, pipeline, handle = gpuMaterial->GetHandle(), pipelineHandle = pipeline->GetHandle(), offsets]()
+        {
+            m_impl->m_device->BindGPUMaterial(handle, pipelineHandle, offsets);
         });
 }
 
 void RenderService::BindMaterial(const ResPtr<MaterialResource>& material, const RPtr<rhi::ComputeState>& state)
 {
-    RunOnRenderThread([=]()
+    const auto offsets = material->Material()->UploadUniforms();
+    const auto& gpuMaterial = material->Material()->GPUMaterial();
+
+    if (!gpuMaterial)
+    {
+        return;
+    }
+
+    const auto& pipeline = Pipeline(material);
+
+    RunOnRenderThread([this, gpuMaterial, pipeline, handle = gpuMaterial->GetHandle(), pipelineHandle = pipeline->GetHandle(), state, offsets]()
         {
-            if (const auto gpuMaterial = material->Material()->GPUMaterial())
-            {
-                m_impl->m_device->BindGPUMaterial(material->Material()->GPUMaterial(), Pipeline(material), state);
-            }
+            m_impl->m_device->BindGPUMaterial(handle, pipelineHandle, state, offsets);
         });
 }
 
 void RenderService::PushConstant(const void* data, uint32_t size, const std::shared_ptr<rhi::Pipeline>& pipeline)
 {
-    RunOnRenderThread([=]()
+    ENGINE_ASSERT(size <= C_MAX_PUSH_CONSTANT_SIZE);
+
+    // Graph is executed when the caller may already simulate the next frame, so data is copied
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    const eastl::fixed_vector<uint8_t, C_MAX_PUSH_CONSTANT_SIZE, false> copy(bytes, bytes + size);
+
+    m_impl->m_graph.Record([=]()
+        {
+            m_impl->m_device->PushConstant(copy.data(), size, pipeline);
+        });
+}
+
+void RenderService::RecordPass(const std::shared_ptr<rhi::Pipeline>& pipeline,
+                               const eastl::vector<ResPtr<MaterialResource>>& materials,
+                               uint32_t chunksAmount,
+                               const std::function<void(uint32_t chunk, rhi::CommandList& list)>& record)
+{
+    PROFILER_CPU_ZONE;
+
+    ENGINE_ASSERT(chunksAmount > 0);
+    ENGINE_ASSERT(pipeline->Descriptor().m_offscreen);
+
+    BeginRenderFrame();
+
+    m_impl->m_graph.BeginPass(pipeline->Descriptor().m_pass, true);
+
+    // Uniform ring and the graph aren't thread safe, so everything shared by the lists is prepared here
+    for (const auto& material : materials)
+    {
+        material->Material()->UploadUniforms();
+        material->Material()->ForEachTexture([this](const auto& texture)
+            {
+                m_impl->m_graph.AddRead(texture);
+            });
+    }
+
+    eastl::vector<RPtr<rhi::CommandList>> lists(chunksAmount);
+    const auto& pass = pipeline->Descriptor().m_pass;
+
+    tf::Taskflow taskflow;
+
+    for (uint32_t chunk = 0; chunk < chunksAmount; ++chunk)
+    {
+        taskflow.emplace([&, chunk]
+            {
+                PROFILER_CPU_ZONE_NAME("Record command list");
+
+                auto list = m_impl->m_device->BeginCommandList(pass);
+                record(chunk, *list);
+                list->End();
+
+                lists[chunk] = std::move(list);
+            });
+    }
+
+    Instance().Service<ThreadService>().RunForegroundTaskflowAndWait(taskflow);
+
+    m_impl->m_graph.Record([=, lists = std::move(lists)]()
         {
-            m_impl->m_device->PushConstant(data, size, pipeline);
+            m_impl->m_device->BeginPipeline(pipeline, true);
+            m_impl->m_device->ExecuteCommandLists(lists);
+            m_impl->m_device->EndPipeline(pipeline);
         });
+    m_impl->m_graph.EndPass();
+}
+
+void RenderService::BindMaterial(const ResPtr<MaterialResource>& material, rhi::PipelineHandle pipeline, rhi::CommandList& list)
+{
+    if (const auto& gpuMaterial = material->Material()->GPUMaterial())
+    {
+        list.BindGPUMaterial(gpuMaterial->GetHandle(), pipeline, material->Material()->UniformOffsets());
+    }
+}
+
+void RenderService::AddPass(const RPtr<rhi::RenderPass>& pass, const eastl::vector<RPtr<rhi::Texture>>& sampledTextures, std::function<void()>&& callback)
+{
+    BeginRenderFrame();
+
+    m_impl->m_graph.BeginPass(pass, true);
+
+    for (const auto& texture : sampledTextures)
+    {
+        m_impl->m_graph.AddRead(texture);
+    }
+
+    m_impl->m_graph.Record(std::move(callback));
+    m_impl->m_graph.EndPass();
 }
 
 void RenderService::WaitAll()
 {
+    // Previous frame may still be submitted on the render thread
+    m_renderThread->WaitForAll();
     m_impl->m_device->WaitForIdle();
 }
 
@@ -374,6 +644,7 @@ void RenderService::OnResize(glm::ivec2 extent)
         core::log::warning("[RenderService] Resize with zeroed dimension was requested, clamping it to 1: {}x{}", extent.x, extent.y);
     }
     m_impl->m_resizeRequested = true;
+    m_impl->m_resizeRequestTime = std::chrono::steady_clock::now();
     m_impl->m_newResolution = { glm::clamp<int>(extent.x, 1u, C_MAX_RESOLUTION), glm::clamp<int>(extent.y, 1u, C_MAX_RESOLUTION) };
 }
 
@@ -427,11 +698,41 @@ const ResPtr<rhi::Pipeline>& RenderService::Pipeline(const ResPtr<MaterialResour
     return materialLoader.Pipeline(res);
 }
 
+rhi::Device::PipelineStats RenderService::PipelineStats() const
+{
+    return m_impl->m_device->GetPipelineStats();
+}
+
+rhi::Device::BarrierStats RenderService::BarrierStats() const
+{
+    return m_impl->m_device->GetBarrierStats();
+}
+
+rhi::Device::FrameStats RenderService::FrameStats() const
+{
+    return m_impl->m_device->GetFrameStats();
+}
+
+render::RenderThread::Stats RenderService::RenderThreadStats() const
+{
+    return m_impl->m_renderThreadStats;
+}
+
 const rhi::Device::Parameters& RenderService::DeviceParams() const
 {
     return m_impl->m_device->m_parameters;
 }
 
+render::UniformRing& RenderService::UniformRing()
+{
+    return *m_impl->m_uniformRing;
+}
+
+const RPtr<render::GeometryArena>& RenderService::GeometryArena() const
+{
+    return m_impl->m_geometryArena;
+}
+
 void RenderService::CreateRenderResources(glm::ivec2 extent)
 {
     PROFILER_CPU_ZONE;
@@ -459,7 +760,7 @@ void RenderService::CreateWindowResources(glm::ivec2 extent)
     textureDescriptor.m_layersAmount = 1;
     textureDescriptor.m_format = rhi::Format::BGRA8_UNORM;
 
-    const auto imguiTex = CreateTexture(textureDescriptor);
+    const auto imguiTex = CreateAttachment(textureDescriptor, "ImGui/0");
 
     rhi::RenderPassDescriptor imguiPassDesc{};
     imguiPassDesc.m_extent = extent;
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <Engine/Service/IService.hpp>
+#include <Engine/Service/Render/RenderThread.hpp>
 #include <RHI/Device.hpp>
+#include <RHI/CommandList.hpp>
+#include <functional>
 
 namespace engine
 {
@@ -9,6 +12,8 @@ namespace engine
 namespace render
 {
 class Material;
+class UniformRing;
+class GeometryArena;
 } // render
 
 class MaterialResource;
@@ -25,31 +30,56 @@ public:
     virtual void                Update(float dt) override;
     virtual void                PostUpdate(float dt) override;
 
+    // Waits until the render thread submits the previous frame and begins the new one. Called implicitly by the first recorded pass,
+    // systems call it explicitly after their simulation only work, so it overlaps with submission of the previous frame
+    void                        BeginRenderFrame();
+
     RPtr<rhi::ShaderCompiler>   CreateShaderCompiler(const rhi::ShaderCompiler::Options& options = {});
     RPtr<rhi::Buffer>           CreateBuffer(const rhi::BufferDescriptor& desc, const void* data = nullptr);
     RPtr<rhi::Texture>          CreateTexture(const rhi::TextureDescriptor& desc, const std::shared_ptr<rhi::Sampler>& sampler = {}, const void* data = nullptr);
+    // Creates render pass attachment tracked by the render graph, it may share memory with the other attachment which is never used at the same time.
+    // Name must be unique and stable between reallocations, e.g. '<pass>/<index>'
+    RPtr<rhi::Texture>          CreateAttachment(const rhi::TextureDescriptor& desc, const std::string& name);
     RPtr<rhi::Shader>           CreateShader(const rhi::ShaderDescriptor& desc);
     RPtr<rhi::Sampler>          CreateSampler(const rhi::SamplerDescriptor& desc);
     RPtr<rhi::RenderPass>       CreateRenderPass(const rhi::RenderPassDescriptor& desc);
     RPtr<rhi::Pipeline>         CreatePipeline(const rhi::PipelineDescriptor& desc);
     RPtr<rhi::GPUMaterial>      CreateGPUMaterial(const std::shared_ptr<rhi::Shader>& shader);
+    void                        UpdateBuffer(const std::shared_ptr<rhi::Buffer>& buffer, const void* data, uint32_t size, uint32_t offset = 0);
 
     void                        BeginPass(const ResPtr<MaterialResource>& material);
     void                        BeginPass(const std::shared_ptr<rhi::Pipeline>& pipeline);
     void                        EndPass(const ResPtr<MaterialResource>& material);
     void                        EndPass(const std::shared_ptr<rhi::Pipeline>& pipeline);
+    // Switches pipeline inside of the begun pass, pipeline must use the same render pass
+    void                        BindPipeline(const std::shared_ptr<rhi::Pipeline>& pipeline);
     void                        BeginComputePass(const ResPtr<MaterialResource>& material);
     RPtr<rhi::ComputeState>     BeginComputePassImmediate(const ResPtr<MaterialResource>& material);
     void                        EndComputePass(const ResPtr<MaterialResource>& material);
     void                        EndComputePass(const ResPtr<MaterialResource>& material, const RPtr<rhi::ComputeState>& state);
     void                        PushConstantComputeImmediate(const void* data, uint32_t size, const ResPtr<MaterialResource>& material, const std::shared_ptr<rhi::ComputeState>& state);
-    void                        Draw(const std::shared_ptr<rhi::Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount = 1);
-    void                        Draw(const std::shared_ptr<rhi::Buffer>& vb, const std::shared_ptr<rhi::Buffer>& ib, uint32_t instanceCount = 1);
+    void                        Draw(const std::shared_ptr<rhi::Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+    void                        Draw(const std::shared_ptr<rhi::Buffer>& vb, const std::shared_ptr<rhi::Buffer>& ib, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+    void                        BindVertexBuffer(const std::shared_ptr<rhi::Buffer>& buffer);
+    void                        BindIndexBuffer(const std::shared_ptr<rhi::Buffer>& buffer);
+    void                        Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+    void                        DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
     void                        Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
     void                        Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, const RPtr<rhi::ComputeState>& state);
     void                        BindMaterial(const ResPtr<MaterialResource>& material);
     void                        BindMaterial(const ResPtr<MaterialResource>& material, const RPtr<rhi::ComputeState>& state);
     void                        PushConstant(const void* data, uint32_t size, const std::shared_ptr<rhi::Pipeline>& pipeline);
+    // Records contents of the offscreen pass into command lists in parallel on the foreground workers, record is called once per chunk
+    // with its own list and the lists are executed in the chunk order. Uniforms of the materials are uploaded and their textures
+    // are marked as sampled beforehand, so lists may bind only these materials
+    void                        RecordPass(const std::shared_ptr<rhi::Pipeline>& pipeline,
+                                           const eastl::vector<ResPtr<MaterialResource>>& materials,
+                                           uint32_t chunksAmount,
+                                           const std::function<void(uint32_t chunk, rhi::CommandList& list)>& record);
+    // Thread safe, material must be passed to RecordPass of the pass which list is recorded for and pipeline must be the one of the material
+    void                        BindMaterial(const ResPtr<MaterialResource>& material, rhi::PipelineHandle pipeline, rhi::CommandList& list);
+    // Adds pass which records its commands itself on the render thread, e.g. ImGui. Sampled textures are used to order the pass in the frame
+    void                        AddPass(const RPtr<rhi::RenderPass>& pass, const eastl::vector<RPtr<rhi::Texture>>& sampledTextures, std::function<void()>&& callback);
 
     void                        WaitAll();
     void                        OnResize(glm::ivec2 extent);
@@ -70,17 +100,28 @@ public:
     const ResPtr<rhi::Pipeline>&        Pipeline(const ResPtr<MaterialResource>& res) const;
 
     const rhi::Device::Parameters&      DeviceParams() const;
+    rhi::Device::PipelineStats          PipelineStats() const;
+    rhi::Device::BarrierStats           BarrierStats() const;
+    rhi::Device::FrameStats             FrameStats() const;
+    // Counters of the previous frame
+    render::RenderThread::Stats         RenderThreadStats() const;
+
+    render::UniformRing&                UniformRing();
+
+    const RPtr<render::GeometryArena>&  GeometryArena() const;
 
+    // Doesn't block, use it unless result of the call is needed
     template <typename F>
     auto RunOnRenderThread(F&& f)
     {
-        return m_renderThread->AddTask(f);
+        return m_renderThread->Push(std::forward<F>(f));
     }
 
+    // Sync point with the render thread, it is counted in RenderThreadStats
     template <typename F>
     auto RunOnRenderThreadWait(F&& f)
     {
-        return m_renderThread->AddTask(f).get();
+        return m_renderThread->PushAndWait(std::forward<F>(f));
     }
 
     friend class Engine;
@@ -92,8 +133,8 @@ private:
     void                        CreateWindowResources(glm::ivec2 extent);
     void                        LoadSystemResources();
 
-    std::unique_ptr<Impl>           m_impl;
-    std::unique_ptr<CustomThread>   m_renderThread;
+    std::unique_ptr<Impl>                   m_impl;
+    std::unique_ptr<render::RenderThread>   m_renderThread;
 };
 
 } // engine
\ No newline at end of file
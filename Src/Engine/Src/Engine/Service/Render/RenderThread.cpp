@@ -0,0 +1,175 @@
+#include <Engine/Service/Render/RenderThread.hpp>
+#include <Core/Profiling.hpp>
+
+namespace engine::render
+{
+
+namespace
+{
+
+// Render thread spins for a while before it goes to sleep, commands usually come in bursts
+constexpr uint32_t C_SPIN_COUNT = 256;
+
+} // unnamed
+
+RenderThread::RenderThread(std::string_view name) : m_name(name)
+{
+    static_assert((C_CAPACITY & (C_CAPACITY - 1)) == 0, "Capacity must be power of two");
+    static_assert(sizeof(Command) == 128);
+
+    m_ring = std::make_unique<Command[]>(C_CAPACITY);
+
+    for (uint64_t i = 0; i < C_CAPACITY; ++i)
+    {
+        m_ring[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+
+    m_thread = std::thread([this]() { Run(); });
+}
+
+RenderThread::~RenderThread()
+{
+    Push([this]() { m_stop = true; });
+    m_thread.join();
+}
+
+void RenderThread::Wait(Ticket ticket)
+{
+    if (m_executed.load() >= ticket)
+    {
+        return;
+    }
+
+    ENGINE_ASSERT(!IsCurrent());
+
+    PROFILER_CPU_ZONE_NAME("Wait for render thread");
+
+    m_syncPoints.fetch_add(1, std::memory_order_relaxed);
+
+    std::unique_lock l(m_doneMutex);
+    m_waiters.fetch_add(1);
+    m_doneCondition.wait(l, [this, ticket]() { return m_executed.load() >= ticket; });
+    m_waiters.fetch_sub(1);
+}
+
+void RenderThread::WaitForAll()
+{
+    Wait(m_tail.load());
+}
+
+RenderThread::Stats RenderThread::TakeStats()
+{
+    Stats stats;
+    stats.m_commands = m_commands.exchange(0, std::memory_order_relaxed);
+    stats.m_syncPoints = m_syncPoints.exchange(0, std::memory_order_relaxed);
+    stats.m_heapCommands = m_heapCommands.exchange(0, std::memory_order_relaxed);
+    stats.m_ringFullStalls = m_ringFullStalls.exchange(0, std::memory_order_relaxed);
+    return stats;
+}
+
+std::pair<RenderThread::Command*, RenderThread::Ticket> RenderThread::Acquire()
+{
+    m_commands.fetch_add(1, std::memory_order_relaxed);
+
+    bool stalled = false;
+    uint64_t position = m_tail.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        auto& command = m_ring[position & (C_CAPACITY - 1)];
+        const uint64_t sequence = command.m_sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(sequence - position);
+
+        if (diff == 0)
+        {
+            if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                return { &command, position + 1 };
+            }
+        }
+        else if (diff < 0)
+        {
+            // Slot still holds the command pushed a whole ring ago, render thread must not push in that case or it waits for itself
+            ENGINE_ASSERT(!IsCurrent());
+
+            if (!stalled)
+            {
+                stalled = true;
+                m_ringFullStalls.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            std::this_thread::yield();
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void RenderThread::Publish(Command& command, Ticket ticket)
+{
+    // Sequential consistency pairs with the render thread going to sleep, so either it sees the command or it is woken up
+    command.m_sequence.store(ticket);
+
+    if (m_sleeping.load())
+    {
+        std::lock_guard l(m_wakeMutex);
+        m_wakeCondition.notify_one();
+    }
+}
+
+bool RenderThread::ExecuteNext()
+{
+    auto& command = m_ring[m_head & (C_CAPACITY - 1)];
+
+    if (command.m_sequence.load() != m_head + 1)
+    {
+        return false;
+    }
+
+    command.m_execute(command.m_payload);
+    command.m_sequence.store(m_head + C_CAPACITY, std::memory_order_release);
+
+    ++m_head;
+    m_executed.store(m_head);
+
+    if (m_waiters.load() > 0)
+    {
+        std::lock_guard l(m_doneMutex);
+        m_doneCondition.notify_all();
+    }
+
+    return true;
+}
+
+void RenderThread::Run()
+{
+    PROFILER_SET_THREAD_NAME(m_name.c_str());
+
+    uint32_t spins = 0;
+
+    while (!m_stop)
+    {
+        if (ExecuteNext())
+        {
+            spins = 0;
+            continue;
+        }
+
+        if (++spins < C_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock l(m_wakeMutex);
+        m_sleeping.store(true);
+        m_wakeCondition.wait(l, [this]() { return m_ring[m_head & (C_CAPACITY - 1)].m_sequence.load() == m_head + 1; });
+        m_sleeping.store(false);
+        spins = 0;
+    }
+}
+
+} // engine::render
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <Engine/Config.hpp>
+#include <Core/Type.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace engine::render
+{
+
+// Thread which executes render commands in the order they are pushed.
+// Commands live in a fixed lock-free ring shared by all producers, a command is a function pointer with inline payload,
+// so pushing never allocates unless captures of the callable don't fit into the payload.
+// Producers block only when they wait for the command, e.g. its result is needed, or when the ring is full
+class ENGINE_API RenderThread : public core::NonCopyable
+{
+public:
+    // Amount of commands which were pushed before the command and the command itself
+    using Ticket = uint64_t;
+
+    // Counters since the previous TakeStats call
+    struct Stats
+    {
+        uint32_t    m_commands = 0;
+        // Waits of the other threads for the render thread, each one costs at least a pair of context switches
+        uint32_t    m_syncPoints = 0;
+        // Commands which captures didn't fit into the inline payload
+        uint32_t    m_heapCommands = 0;
+        // Pushes which waited for a free slot of the ring
+        uint32_t    m_ringFullStalls = 0;
+    };
+
+    RenderThread(std::string_view name);
+    // Executes all commands pushed so far
+    ~RenderThread();
+
+    template <typename F>
+    Ticket                  Push(F&& f);
+
+    // Callable is referenced, not copied, as the caller is blocked until it is executed
+    template <typename F>
+    auto                    PushAndWait(F&& f);
+
+    // Blocks until the command and all commands pushed before it are executed
+    void                    Wait(Ticket ticket);
+    void                    WaitForAll();
+
+    Stats                   TakeStats();
+
+    bool                    IsCurrent() const { return std::this_thread::get_id() == m_thread.get_id(); }
+
+private:
+    static constexpr size_t     C_PAYLOAD_SIZE = 112;
+    static constexpr size_t     C_PAYLOAD_ALIGNMENT = 16;
+    static constexpr uint64_t   C_CAPACITY = 4096;
+
+    struct alignas(64) Command
+    {
+        std::atomic<uint64_t>   m_sequence;
+        void                    (*m_execute)(void* payload) = nullptr;
+        alignas(C_PAYLOAD_ALIGNMENT) std::byte m_payload[C_PAYLOAD_SIZE];
+    };
+
+    std::pair<Command*, Ticket> Acquire();
+    void                        Publish(Command& command, Ticket ticket);
+    // Returns false if the next command isn't published yet
+    bool                        ExecuteNext();
+    void                        Run();
+
+    std::unique_ptr<Command[]>  m_ring;
+    alignas(64) std::atomic<uint64_t> m_tail = 0;
+    alignas(64) std::atomic<uint64_t> m_executed = 0;
+    // Owned by the render thread
+    uint64_t                    m_head = 0;
+    bool                        m_stop = false;
+
+    std::mutex                  m_wakeMutex;
+    std::condition_variable     m_wakeCondition;
+    std::atomic<bool>           m_sleeping = false;
+
+    std::mutex                  m_doneMutex;
+    std::condition_variable     m_doneCondition;
+    std::atomic<uint32_t>       m_waiters = 0;
+
+    std::atomic<uint32_t>       m_commands = 0;
+    std::atomic<uint32_t>       m_syncPoints = 0;
+    std::atomic<uint32_t>       m_heapCommands = 0;
+    std::atomic<uint32_t>       m_ringFullStalls = 0;
+
+    std::string                 m_name;
+    std::thread                 m_thread;
+};
+
+template <typename F>
+RenderThread::Ticket RenderThread::Push(F&& f)
+{
+    using Callable = std::decay_t<F>;
+
+    auto [command, ticket] = Acquire();
+
+    if constexpr (sizeof(Callable) <= C_PAYLOAD_SIZE && alignof(Callable) <= C_PAYLOAD_ALIGNMENT)
+    {
+        new (command->m_payload) Callable(std::forward<F>(f));
+        command->m_execute = [](void* payload)
+        {
+            auto* callable = std::launder(reinterpret_cast<Callable*>(payload));
+            (*callable)();
+            callable->~Callable();
+        };
+    }
+    else
+    {
+        new (command->m_payload) Callable*(new Callable(std::forward<F>(f)));
+        command->m_execute = [](void* payload)
+        {
+            std::unique_ptr<Callable> callable(*std::launder(reinterpret_cast<Callable**>(payload)));
+            (*callable)();
+        };
+        m_heapCommands.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Publish(*command, ticket);
+    return ticket;
+}
+
+template <typename F>
+auto RenderThread::PushAndWait(F&& f)
+{
+    using Result = std::invoke_result_t<F&>;
+
+    if constexpr (std::is_void_v<Result>)
+    {
+        Wait(Push([&f]() { f(); }));
+    }
+    else
+    {
+        std::optional<Result> result;
+        Wait(Push([&f, &result]() { result.emplace(f()); }));
+        return std::move(*result);
+    }
+}
+
+} // engine::render
@@ -0,0 +1,54 @@
+#include <Engine/Service/Render/UniformRing.hpp>
+#include <Core/Math.hpp>
+
+namespace engine::render
+{
+
+UniformRing::UniformRing(const std::shared_ptr<rhi::Buffer>& buffer, uint32_t framesInFlight, uint32_t alignment) :
+    m_buffer(buffer),
+    m_framesInFlight(framesInFlight),
+    m_alignment(alignment)
+{
+    ENGINE_ASSERT(m_buffer);
+    ENGINE_ASSERT(m_framesInFlight > 0);
+
+    m_frameSize = m_buffer->Descriptor().m_size / m_framesInFlight;
+    m_frameSize -= m_frameSize % m_alignment;
+
+    m_mappedData = static_cast<uint8_t*>(m_buffer->Map());
+    ENGINE_ASSERT(m_mappedData);
+}
+
+void UniformRing::NextFrame()
+{
+    const uint64_t frame = (m_state.load() >> 32) + 1;
+    m_state.store(frame << 32);
+}
+
+UniformRing::Allocation UniformRing::Allocate(uint32_t size)
+{
+    const uint32_t alignedSize = core::math::roundToDivisible(size, m_alignment);
+    uint64_t state = m_state.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        const auto offset = static_cast<uint32_t>(state);
+
+        // Exhausted region is left as is, so data of the allocations which are already recorded is never overwritten
+        if (static_cast<uint64_t>(offset) + alignedSize > m_frameSize)
+        {
+            ENGINE_ASSERT_WITH_MESSAGE(false, fmt::format("[UniformRing] Frame region of {} bytes is exhausted", m_frameSize));
+            core::log::error("[UniformRing] Frame region of {} bytes is exhausted, allocation of {} bytes failed", m_frameSize, alignedSize);
+            return {};
+        }
+
+        if (m_state.compare_exchange_weak(state, state + alignedSize, std::memory_order_relaxed))
+        {
+            const uint64_t frame = state >> 32;
+            const uint32_t bufferOffset = static_cast<uint32_t>(frame % m_framesInFlight) * m_frameSize + offset;
+            return { m_mappedData + bufferOffset, bufferOffset };
+        }
+    }
+}
+
+} // engine::render
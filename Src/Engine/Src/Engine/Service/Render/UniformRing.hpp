@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Engine/Config.hpp>
+#include <Core/Type.hpp>
+#include <RHI/Buffer.hpp>
+#include <atomic>
+
+namespace engine::render
+{
+
+// Linear allocator for per frame uniform data.
+// Buffer is split in a region per frame in flight, region is reused only after the frame that used it is finished.
+// Buffer is persistently mapped, allocations are bound using dynamic descriptor offsets
+class ENGINE_API UniformRing : public core::NonCopyable
+{
+public:
+    struct Allocation
+    {
+        // Null if the frame region is exhausted, offset then points to the beginning of the buffer, so binding stays valid
+        void*       m_data = nullptr;
+        // Offset from the beginning of the buffer
+        uint32_t    m_offset = 0;
+    };
+
+    UniformRing(const std::shared_ptr<rhi::Buffer>& buffer, uint32_t framesInFlight, uint32_t alignment);
+
+    // Must be called once frame is started, switches to the next region.
+    // Frame and offset are switched at once, so concurrent allocations land either in the previous region or in the new one
+    void                                NextFrame();
+
+    // Thread safe, memory is valid until the end of the current frame. Allocations never wrap inside the region,
+    // allocation fails when the region is exhausted
+    Allocation                          Allocate(uint32_t size);
+
+    uint64_t                            Frame() const { return m_state.load() >> 32; }
+    const std::shared_ptr<rhi::Buffer>& Buffer() const { return m_buffer; }
+
+private:
+    std::shared_ptr<rhi::Buffer>    m_buffer;
+    uint8_t*                        m_mappedData = nullptr;
+    uint32_t                        m_frameSize = 0;
+    uint32_t                        m_framesInFlight = 1;
+    uint32_t                        m_alignment = 1;
+    // Frame in the high half, offset inside the frame region in the low half
+    std::atomic<uint64_t>           m_state = 0;
+};
+
+} // engine::render
@@ -6,7 +6,9 @@
 #include <Engine/Service/Render/RenderService.hpp>
 #include <Engine/Service/Window/WindowService.hpp>
 #include <RHI/Helpers.hpp>
+#include <Core/String.hpp>
 #include <nlohmann/json.hpp>
+#include <EASTL/algorithm.h>
 
 #include "RHI/Pipeline.hpp"
 #include "RHI/RenderPass.hpp"
@@ -62,6 +64,74 @@ constexpr std::string_view C_STORE_OPERATION_KEY = "storeOperation";
 constexpr std::string_view C_DEPENDENCY_KEY = "dependency";
 constexpr std::string_view C_PATH_KEY = "path";
 constexpr std::string_view C_INDEX_KEY = "index";
+constexpr std::string_view C_FEATURES_KEY = "features";
+
+constexpr std::string_view C_SHADER_CACHE_PATH = "/System/Cache/Shaders";
+constexpr auto C_SHADER_WATCH_INTERVAL = std::chrono::milliseconds(500);
+
+rhi::ShaderType ShaderTypeFromPath(const std::filesystem::path& path)
+{
+	return path.extension() == ".glsl" ? rhi::ShaderType::FX : rhi::ShaderType::COMPUTE;
+}
+
+// Materials keep descriptor sets allocated for the old shader, so reloaded shader must have the same resource layout
+bool CompatibleReflection(const rhi::ShaderReflection& a, const rhi::ShaderReflection& b)
+{
+	const auto compareBuffers = [](const rhi::ShaderReflection::BufferMap& lhs, const rhi::ShaderReflection::BufferMap& rhs)
+		{
+			if (lhs.size() != rhs.size())
+			{
+				return false;
+			}
+
+			for (const auto& [slot, buffer] : lhs)
+			{
+				const auto it = rhs.find(slot);
+				if (it == rhs.end() || it->second.m_size != buffer.m_size || it->second.m_name != buffer.m_name)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+	const auto compareTextures = [](const rhi::ShaderReflection::TextureList& lhs, const rhi::ShaderReflection::TextureList& rhs)
+		{
+			return lhs.size() == rhs.size() && eastl::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const auto& l, const auto& r)
+				{
+					return l.m_slot == r.m_slot && l.m_isCubemap == r.m_isCubemap;
+				});
+		};
+
+	return compareBuffers(a.m_bufferMap, b.m_bufferMap) &&
+		compareBuffers(a.m_storageBufferMap, b.m_storageBufferMap) &&
+		compareTextures(a.m_textures, b.m_textures) &&
+		compareTextures(a.m_storageImages, b.m_storageImages) &&
+		a.m_pushConstant.m_name == b.m_pushConstant.m_name &&
+		a.m_inputLayout.Stride() == b.m_inputLayout.Stride() &&
+		a.m_outputAmount == b.m_outputAmount;
+}
+
+// Feature index is its bit in the permutation mask, features which shader doesn't declare are skipped
+eastl::vector<rhi::SpecializationConstant> FeatureConstants(const rhi::ShaderReflection& reflection, const eastl::vector<std::string>& features, uint32_t permutation)
+{
+	eastl::vector<rhi::SpecializationConstant> constants;
+
+	for (uint32_t i = 0; i < features.size(); i++)
+	{
+		const auto it = eastl::find_if(reflection.m_specializationConstants.begin(), reflection.m_specializationConstants.end(), [&](const auto& constant)
+			{
+				return constant.m_name == features[i];
+			});
+
+		if (it != reflection.m_specializationConstants.end())
+		{
+			constants.push_back({ it->m_id, (permutation >> i) & 1u });
+		}
+	}
+
+	return constants;
+}
 
 template<typename T>
 T StringToEnum(std::string_view str)
@@ -85,12 +155,28 @@ using namespace nlohmann;
 
 MaterialLoader::MaterialLoader()
 {
-	m_shaderCompiler = Instance().Service<RenderService>().CreateShaderCompiler();
+	rhi::ShaderCompiler::Options options;
+	options.m_cacheDirectory = Instance().Service<io::VirtualFilesystemService>().Absolute(C_SHADER_CACHE_PATH).generic_u8string();
+#ifdef NDEBUG
+	options.m_profile = rhi::ShaderProfile::RELEASE;
+#endif
+
+	m_shaderCompiler = Instance().Service<RenderService>().CreateShaderCompiler(options);
 }
 
 void MaterialLoader::Update()
 {
 	PROFILER_CPU_ZONE;
+
+	SwapReloadedPipelines();
+	UpdatePermutations();
+
+	const auto now = std::chrono::steady_clock::now();
+	if (now - m_lastWatchCheck >= C_SHADER_WATCH_INTERVAL)
+	{
+		m_lastWatchCheck = now;
+		CheckShaderChanges();
+	}
 }
 
 ResPtr<Resource> MaterialLoader::Load(const fs::path& path)
@@ -142,6 +228,42 @@ void MaterialLoader::LoadSystemResources()
 	m_equirectToCubemapMaterial->Wait();
 	m_envmapIrradianceMaterial->Wait();
 	m_envmapPrefilterMaterial->Wait();
+
+	const auto stats = m_shaderCompiler->GetStats();
+	core::log::info("[MaterialLoader] Shader cache: {} hits, {} misses", stats.m_cacheHits, stats.m_cacheMisses);
+	core::log::info("[MaterialLoader] {} profile shaders: {}, compile time {:.2f}ms",
+		rhi::ShaderProfileToString(m_shaderCompiler->GetOptions().m_profile),
+		core::string::BytesToHumanReadable(stats.m_compiledBlobSize),
+		stats.m_compileTimeMs);
+
+	const auto pipelineStats = Instance().Service<RenderService>().PipelineStats();
+	core::log::info("[MaterialLoader] {} pipelines created with {} cache in {:.2f}ms", pipelineStats.m_createdPipelines,
+		pipelineStats.m_warmCache ? "warm" : "cold", pipelineStats.m_creationTimeMs);
+}
+
+eastl::vector<ResPtr<MaterialResource>> MaterialLoader::WarmUp(const eastl::vector<fs::path>& paths, const eastl::vector<uint32_t>& permutations)
+{
+	PROFILER_CPU_ZONE;
+
+	eastl::vector<ResPtr<MaterialResource>> materials;
+	materials.reserve(paths.size());
+
+	for (const auto& path : paths)
+	{
+		materials.push_back(std::static_pointer_cast<MaterialResource>(Load(path)));
+	}
+
+	std::lock_guard l(m_mutex);
+
+	for (const auto& material : materials)
+	{
+		for (const auto permutation : permutations)
+		{
+			m_warmUpPermutations.emplace_back(material, permutation);
+		}
+	}
+
+	return materials;
 }
 
 const ResPtr<rhi::Pipeline>& MaterialLoader::Pipeline(const ResPtr<MaterialResource>& res) const
@@ -150,7 +272,8 @@ const ResPtr<rhi::Pipeline>& MaterialLoader::Pipeline(const ResPtr<MaterialResou
 
 	ENGINE_ASSERT(res);
 
-	const auto it = m_shaderToPipeline.find(res->Material()->Shader());
+	const auto& material = res->Material();
+	const auto it = m_shaderToPipeline.find(material->Shader());
 
 	if (it == m_shaderToPipeline.end())
 	{
@@ -161,43 +284,129 @@ const ResPtr<rhi::Pipeline>& MaterialLoader::Pipeline(const ResPtr<MaterialResou
 
 	const auto& p = it->second;
 
+	if (material->Permutation() == material->DefaultPermutation())
+	{
+		return p;
+	}
+
+	if (const auto permutationsIt = m_permutations.find(material->Shader()); permutationsIt != m_permutations.end())
+	{
+		if (const auto permutationIt = permutationsIt->second.find(material->Permutation()); permutationIt != permutationsIt->second.end())
+		{
+			return permutationIt->second ? permutationIt->second : p;
+		}
+	}
+
+	const bool requested = eastl::any_of(m_permutationRequests.begin(), m_permutationRequests.end(), [&](const PermutationRequest& request)
+		{
+			return request.m_shader == material->Shader() && request.m_permutation == material->Permutation();
+		});
+
+	if (!requested)
+	{
+		m_permutationRequests.push_back({ material->Shader(), material->Features(), material->Permutation() });
+	}
+
 	return p;
 }
 
 void MaterialLoader::ResizePipelines(glm::ivec2 extent, bool offscreen)
 {
+	PROFILER_CPU_ZONE;
+
 	ENGINE_ASSERT(extent != glm::ivec2(0));
 
-	eastl::vector<std::future<void>> tasks;
+	eastl::vector_set<std::shared_ptr<rhi::Shader>> resized;
 
 	for (auto& [_, resource] : m_cache)
 	{
-		// TODO: Probably we need to resize it later
-		if (!resource->Ready())
+		ResizeRenderPass(resource, extent, offscreen, resized);
+	}
+}
+
+void MaterialLoader::ResizeRenderPass(const ResPtr<MaterialResource>& resource, glm::ivec2 extent, bool offscreen,
+									  eastl::vector_set<std::shared_ptr<rhi::Shader>>& resized)
+{
+	// TODO: Probably we need to resize it later
+	if (!resource->Ready())
+	{
+		return;
+	}
+
+	const auto& shader = resource->Material()->Shader();
+
+	if (!resized.insert(shader).second)
+	{
+		return;
+	}
+
+	std::shared_ptr<rhi::Pipeline> pipeline;
+	ParsedPipelineInfo info;
+
+	{
+		std::lock_guard l(m_mutex);
+
+		const auto pipelineIt = m_shaderToPipeline.find(shader);
+		const auto infoIt = m_pipelineInfos.find(shader);
+
+		if (pipelineIt == m_shaderToPipeline.end() || infoIt == m_pipelineInfos.end())
 		{
-			continue;
+			return;
 		}
 
-		const auto& pipeline = Pipeline(resource);
+		pipeline = pipelineIt->second;
+		info = infoIt->second;
+	}
+
+	if (pipeline->Descriptor().m_compute || pipeline->Descriptor().m_offscreen != offscreen)
+	{
+		return;
+	}
 
-		if (pipeline->Descriptor().m_offscreen == offscreen && !pipeline->Descriptor().m_compute)
+	const auto resizeDependency = [&](const LoadAttachmentDescriptor& attachment)
 		{
-			auto& ts = Instance().Service<ThreadService>();
+			if (attachment.m_dependency.empty())
+			{
+				return;
+			}
 
-			resource->m_status = Resource::Status::LOADING;
+			if (const auto it = m_cache.find(attachment.m_dependency); it != m_cache.end())
+			{
+				ResizeRenderPass(it->second, extent, offscreen, resized);
+			}
+		};
 
-			tasks.push_back(ts.AddBackgroundTask([this, resource]()
-				{
-					PROFILER_CPU_ZONE_NAME("Load texture");
-					const auto result = Load(resource, true);
-					resource->m_status = result ? Resource::Status::READY : Resource::Status::FAILED;
-				}));
-		}
+	for (const auto& attachment : info.m_attachments)
+	{
+		resizeDependency(attachment);
 	}
 
-	for (auto& task : tasks)
+	if (info.m_depthAttachment)
 	{
-		task.wait();
+		resizeDependency(*info.m_depthAttachment);
+	}
+
+	info.m_viewportSize = extent;
+	const auto pass = AllocateRenderPass(info);
+
+	const uint32_t framesToKeep = Instance().Service<RenderService>().DeviceParams().m_framesInFlight + 1;
+
+	std::lock_guard l(m_mutex);
+
+	// Old attachments are released once GPU is done with them, so resize doesn't need to wait for idle device
+	m_retiredResources.push_back({ pipeline->Descriptor().m_pass, framesToKeep });
+	pipeline->SetRenderPass(pass);
+
+	// Permutations share the render pass with the base pipeline
+	if (const auto permutationsIt = m_permutations.find(shader); permutationsIt != m_permutations.end())
+	{
+		for (auto& [_, permutation] : permutationsIt->second)
+		{
+			if (permutation)
+			{
+				permutation->SetRenderPass(pass);
+			}
+		}
 	}
 }
 
@@ -224,7 +433,7 @@ MaterialLoader::LoadEnvironmentMapData MaterialLoader::LoadEnvironmentMap(const
 
 		auto& computePass = rs.Pipeline(m_equirectToCubemapMaterial)->Descriptor().m_computePass;
 		computePass->m_textures.emplace_back(envTex->Texture());
-		computePass->m_storageTextures.emplace_back(envCubemap);
+		computePass->m_storageTextures.push_back({ envCubemap });
 
 		m_equirectToCubemapMaterial->Material()->SetTexture(envCubemap, 0);
 		m_equirectToCubemapMaterial->Material()->SetTexture(envTex->Texture(), 1);
@@ -251,7 +460,7 @@ MaterialLoader::LoadEnvironmentMapData MaterialLoader::LoadEnvironmentMap(const
 
 		auto& computePass = rs.Pipeline(m_envmapIrradianceMaterial)->Descriptor().m_computePass;
 		computePass->m_textures.emplace_back(data.m_cubemap);
-		computePass->m_storageTextures.emplace_back(irrCubemap);
+		computePass->m_storageTextures.push_back({ irrCubemap });
 
 		m_envmapIrradianceMaterial->Material()->SetTexture(irrCubemap, 0);
 		m_envmapIrradianceMaterial->Material()->SetTexture(data.m_cubemap, 1);
@@ -279,12 +488,15 @@ MaterialLoader::LoadEnvironmentMapData MaterialLoader::LoadEnvironmentMap(const
 	
 		auto& computePass = rs.Pipeline(m_envmapPrefilterMaterial)->Descriptor().m_computePass;
 		computePass->m_textures.emplace_back(data.m_cubemap);
-		computePass->m_storageTextures.emplace_back(prefilterCubemap);
+		computePass->m_storageTextures.push_back({ prefilterCubemap });
 
 		const auto maxMipLevel = prefilterCubemap->CalculateMipCount();
 	
 		for (uint8_t mipLevel = 0; mipLevel < maxMipLevel; mipLevel++)
 		{
+			// Only the written mip is transitioned, the rest of them stay readable
+			computePass->m_storageTextures.back().m_mipLevel = mipLevel;
+
 			m_envmapPrefilterMaterial->Material()->SetTexture(prefilterCubemap, 0, mipLevel);
 			m_envmapPrefilterMaterial->Material()->SetTexture(data.m_cubemap, 1);
 			m_envmapPrefilterMaterial->Material()->Sync();
@@ -304,7 +516,7 @@ MaterialLoader::LoadEnvironmentMapData MaterialLoader::LoadEnvironmentMap(const
 	return data;
 }
 
-bool MaterialLoader::Load(const ResPtr<MaterialResource>& resource, bool forcePipelineRecreation)
+bool MaterialLoader::Load(const ResPtr<MaterialResource>& resource)
 {
 	auto& vfs = Instance().Service<io::VirtualFilesystemService>();
 
@@ -339,18 +551,18 @@ bool MaterialLoader::Load(const ResPtr<MaterialResource>& resource, bool forcePi
 	{
 		auto& rs = Instance().Service<RenderService>();
 
-		const auto shaderType = parsedMat.m_shaderPath.extension() == ".glsl" ? rhi::ShaderType::FX : rhi::ShaderType::COMPUTE;
+		const auto shaderType = ShaderTypeFromPath(parsedMat.m_shaderPath);
 
-		const auto shaderData = rs.RunOnRenderThreadWait([&]()
-			{
-				return m_shaderCompiler->Compile(vfs.Absolute(parsedMat.m_shaderPath).generic_u8string(), shaderType);
-			});
+		// Compiler is reentrant, so shaders are compiled right on the loading worker, only shader module creation goes to render thread
+		const auto shaderData = m_shaderCompiler->Compile(vfs.Absolute(parsedMat.m_shaderPath).generic_u8string(), shaderType);
 
 		if (!shaderData.m_valid)
 		{
 			return false;
 		}
 
+		WatchDependencies(parsedMat.m_shaderPath, shaderData.m_dependencies);
+
 		rhi::ShaderDescriptor desc;
 		desc.m_name = parsedMat.m_name;
 		desc.m_type = shaderType;
@@ -368,6 +580,21 @@ bool MaterialLoader::Load(const ResPtr<MaterialResource>& resource, bool forcePi
 		}
 	}
 
+	eastl::vector<std::string> features;
+	uint32_t defaultPermutation = 0;
+
+	for (const auto& [name, enabled] : parsedMat.m_features)
+	{
+		const auto& constants = shader->Descriptor().m_reflection.m_specializationConstants;
+		if (eastl::none_of(constants.begin(), constants.end(), [&](const auto& constant) { return constant.m_name == name; }))
+		{
+			core::log::warning("[MaterialLoader] Shader '{}' has no specialization constant for feature '{}'", parsedMat.m_shaderPath.generic_u8string(), name);
+		}
+
+		defaultPermutation |= enabled ? 1u << features.size() : 0u;
+		features.push_back(name);
+	}
+
 	bool hasPipeline = false;
 
 	{
@@ -378,7 +605,7 @@ bool MaterialLoader::Load(const ResPtr<MaterialResource>& resource, bool forcePi
 		}
 	}
 
-	if (!hasPipeline || forcePipelineRecreation)
+	if (!hasPipeline)
 	{
 		parsedMat.m_parsedPipeline.m_viewportSize = parsedMat.m_parsedPipeline.m_offscreen ? 
 			Instance().Service<RenderService>().ViewportSize() :
@@ -395,10 +622,18 @@ bool MaterialLoader::Load(const ResPtr<MaterialResource>& resource, bool forcePi
 
 		glm::clamp(parsedMat.m_parsedPipeline.m_viewportSize, glm::ivec2(1, 1), glm::ivec2(65536, 65536));
 
+		parsedMat.m_parsedPipeline.m_specializationConstants = FeatureConstants(shader->Descriptor().m_reflection, features, defaultPermutation);
+
+		{
+			std::lock_guard l(m_mutex);
+			m_pipelineInfos[shader] = parsedMat.m_parsedPipeline;
+		}
+
 		m_shaderToPipeline[shader] = AllocatePipeline(parsedMat.m_parsedPipeline);
 	}
 
 	resource->m_material = std::make_shared<render::Material>(shader);
+	resource->m_material->SetFeatures(features, defaultPermutation);
 
 	for (const auto& [slot, buffer] : shader->Descriptor().m_reflection.m_bufferMap)
 	{
@@ -419,6 +654,18 @@ MaterialLoader::ParsedMaterial MaterialLoader::ParseJson(std::ifstream& stream)
 	mat.m_name = j[C_NAME_KEY];
 	mat.m_shaderPath = io::fs::path(std::string_view(j[C_SHADER_KEY]));
 	mat.m_version = j[C_VERSION_KEY];
+
+	if (j.contains(C_FEATURES_KEY))
+	{
+		const auto& features = j[C_FEATURES_KEY];
+		ENGINE_ASSERT(features.is_object());
+
+		for (const auto& [name, enabled] : features.items())
+		{
+			mat.m_features.emplace_back(name, enabled.get<bool>());
+		}
+	}
+
 	if (!j[C_COMPUTE_KEY].is_null())
 	{
 		mat.m_parsedPipeline.m_compute = true;
@@ -482,16 +729,36 @@ std::shared_ptr<rhi::Pipeline> MaterialLoader::AllocatePipeline(ParsedPipelineIn
 		computePipelineDesc.m_compute = true;
 		computePipelineDesc.m_computePass = computePass;
 		computePipelineDesc.m_shader = info.m_shader;
+		computePipelineDesc.m_specializationConstants = info.m_specializationConstants;
 
 		return rs.CreatePipeline(computePipelineDesc);
 	}
 
+	rhi::PipelineDescriptor pipelineDesc{};
+	pipelineDesc.m_compute = false;
+	pipelineDesc.m_cullMode = info.m_cullMode;
+	pipelineDesc.m_depthCompareOp = info.m_depthCompareOp;
+	pipelineDesc.m_offscreen = info.m_offscreen;
+	pipelineDesc.m_pass = AllocateRenderPass(info);
+	pipelineDesc.m_shader = info.m_shader;
+	pipelineDesc.m_specializationConstants = info.m_specializationConstants;
+
+	const auto pipeline = rs.CreatePipeline(pipelineDesc);
+	return pipeline;
+}
+
+std::shared_ptr<rhi::RenderPass> MaterialLoader::AllocateRenderPass(ParsedPipelineInfo& info)
+{
+	auto& rs = Instance().Service<RenderService>();
+
 	ENGINE_ASSERT(info.m_viewportSize != glm::ivec2(0));
 
-	eastl::vector<rhi::AttachmentDescriptor> colorAttachments;
+	const auto passName = fmt::format("{}-Pass", info.m_shader->Descriptor().m_name);
 
-	for (auto& attachment : info.m_attachments)
+	for (uint32_t i = 0; i < info.m_attachments.size(); ++i)
 	{
+		auto& attachment = info.m_attachments[i];
+
 		if (attachment.m_dependency.empty())
 		{
 			rhi::TextureDescriptor colorAttachmentDesc;
@@ -501,7 +768,7 @@ std::shared_ptr<rhi::Pipeline> MaterialLoader::AllocatePipeline(ParsedPipelineIn
 			colorAttachmentDesc.m_height = static_cast<uint16_t>(info.m_viewportSize.y);
 			colorAttachmentDesc.m_layersAmount = 1;
 
-			attachment.m_descriptor.m_texture = rs.CreateTexture(colorAttachmentDesc);
+			attachment.m_descriptor.m_texture = rs.CreateAttachment(colorAttachmentDesc, fmt::format("{}/{}", passName, i));
 		}
 		else
 		{
@@ -529,7 +796,7 @@ std::shared_ptr<rhi::Pipeline> MaterialLoader::AllocatePipeline(ParsedPipelineIn
 			depthDesc.m_height = static_cast<uint16_t>(info.m_viewportSize.y);
 			depthDesc.m_layersAmount = 1;
 
-			depth.m_descriptor.m_texture = rs.CreateTexture(depthDesc);
+			depth.m_descriptor.m_texture = rs.CreateAttachment(depthDesc, fmt::format("{}/depth", passName));
 		}
 		else
 		{
@@ -546,7 +813,7 @@ std::shared_ptr<rhi::Pipeline> MaterialLoader::AllocatePipeline(ParsedPipelineIn
 	}
 
 	rhi::RenderPassDescriptor renderPassDesc{};
-	renderPassDesc.m_name = fmt::format("{}-Pass", info.m_shader->Descriptor().m_name);
+	renderPassDesc.m_name = passName;
 	renderPassDesc.m_extent = info.m_viewportSize;
 
 	for (auto& attachment : info.m_attachments)
@@ -556,18 +823,331 @@ std::shared_ptr<rhi::Pipeline> MaterialLoader::AllocatePipeline(ParsedPipelineIn
 
 	renderPassDesc.m_depthStencilAttachment = info.m_depthAttachment.has_value() ? info.m_depthAttachment->m_descriptor : rhi::AttachmentDescriptor{};
 
-	const auto renderpass = rs.CreateRenderPass(renderPassDesc);
+	return rs.CreateRenderPass(renderPassDesc);
+}
 
-	rhi::PipelineDescriptor pipelineDesc{};
-	pipelineDesc.m_compute = false;
-	pipelineDesc.m_cullMode = info.m_cullMode;
-	pipelineDesc.m_depthCompareOp = info.m_depthCompareOp;
-	pipelineDesc.m_offscreen = info.m_offscreen;
-	pipelineDesc.m_pass = renderpass;
-	pipelineDesc.m_shader = info.m_shader;
+void MaterialLoader::WatchDependencies(const io::fs::path& shaderPath, const eastl::vector<std::string>& dependencies)
+{
+	std::lock_guard l(m_reloadMutex);
 
-	const auto pipeline = rs.CreatePipeline(pipelineDesc);
-	return pipeline;
+	for (const auto& dependency : dependencies)
+	{
+		const io::fs::path path(dependency);
+		m_shaderDependents[path].insert(shaderPath);
+
+		if (m_watchedFiles.find(path) == m_watchedFiles.end())
+		{
+			std::error_code error;
+			m_watchedFiles[path] = fs::last_write_time(path, error);
+		}
+	}
+}
+
+void MaterialLoader::CheckShaderChanges()
+{
+	PROFILER_CPU_ZONE;
+
+	eastl::vector_set<io::fs::path> shadersToReload;
+
+	{
+		std::lock_guard l(m_reloadMutex);
+
+		for (auto& [path, writeTime] : m_watchedFiles)
+		{
+			std::error_code error;
+			const auto currentWriteTime = fs::last_write_time(path, error);
+
+			// File can be absent for a moment while editor saves it
+			if (error || currentWriteTime == writeTime)
+			{
+				continue;
+			}
+
+			writeTime = currentWriteTime;
+			m_shaderCompiler->Invalidate(path.generic_u8string());
+
+			core::log::info("[MaterialLoader] Shader file '{}' was changed", path.generic_u8string());
+
+			for (const auto& shaderPath : m_shaderDependents[path])
+			{
+				shadersToReload.insert(shaderPath);
+			}
+		}
+
+		for (auto it = shadersToReload.begin(); it != shadersToReload.end();)
+		{
+			// Shader will be reloaded once more after current reload is finished
+			if (const auto reloadIt = m_reloadsInProgress.find(*it); reloadIt != m_reloadsInProgress.end())
+			{
+				reloadIt->second = true;
+				it = shadersToReload.erase(it);
+				continue;
+			}
+
+			m_reloadsInProgress[*it] = false;
+			++it;
+		}
+	}
+
+	auto& ts = Instance().Service<ThreadService>();
+
+	for (const auto& shaderPath : shadersToReload)
+	{
+		ts.AddBackgroundTask([this, shaderPath]()
+			{
+				PROFILER_CPU_ZONE_NAME("Reload shader");
+				ReloadShader(shaderPath);
+			});
+	}
+}
+
+void MaterialLoader::ReloadShader(const io::fs::path& shaderPath)
+{
+	auto& vfs = Instance().Service<io::VirtualFilesystemService>();
+	auto& rs = Instance().Service<RenderService>();
+
+	core::log::info("[MaterialLoader] Reloading shader '{}'", shaderPath.generic_u8string());
+
+	const auto shaderData = m_shaderCompiler->Compile(vfs.Absolute(shaderPath).generic_u8string(), ShaderTypeFromPath(shaderPath));
+
+	eastl::vector<ReloadedPipeline> reloaded;
+
+	if (shaderData.m_valid)
+	{
+		WatchDependencies(shaderPath, shaderData.m_dependencies);
+
+		eastl::vector<eastl::pair<std::shared_ptr<rhi::Shader>, rhi::PipelineDescriptor>> pipelines;
+
+		{
+			std::lock_guard l(m_mutex);
+			for (const auto& [shader, pipeline] : m_shaderToPipeline)
+			{
+				if (shader->Descriptor().m_path == shaderPath.generic_u8string())
+				{
+					pipelines.emplace_back(shader, pipeline->Descriptor());
+				}
+			}
+		}
+
+		for (const auto& [shader, descriptor] : pipelines)
+		{
+			if (!CompatibleReflection(shader->Descriptor().m_reflection, shaderData.m_reflection))
+			{
+				core::log::warning("[MaterialLoader] Resource layout of shader '{}' was changed, restart is needed to apply it", shaderPath.generic_u8string());
+				continue;
+			}
+
+			rhi::ShaderDescriptor shaderDesc = shader->Descriptor();
+			shaderDesc.m_reflection = shaderData.m_reflection;
+			shaderDesc.m_blobByStage = shaderData.m_stageBlob;
+
+			// Render pass is reused, so all attachments stay the same for dependent passes
+			rhi::PipelineDescriptor pipelineDesc = descriptor;
+			pipelineDesc.m_shader = rs.CreateShader(shaderDesc);
+
+			reloaded.push_back({ shader, rs.CreatePipeline(pipelineDesc) });
+		}
+	}
+	else
+	{
+		core::log::error("[MaterialLoader] Failed to reload shader '{}', previous version is kept", shaderPath.generic_u8string());
+	}
+
+	bool reloadAgain = false;
+
+	{
+		std::lock_guard l(m_reloadMutex);
+		m_reloadedPipelines.insert(m_reloadedPipelines.end(), reloaded.begin(), reloaded.end());
+
+		const auto it = m_reloadsInProgress.find(shaderPath);
+		reloadAgain = it != m_reloadsInProgress.end() && it->second;
+
+		if (reloadAgain)
+		{
+			it->second = false;
+		}
+		else
+		{
+			m_reloadsInProgress.erase(shaderPath);
+		}
+	}
+
+	if (reloadAgain)
+	{
+		ReloadShader(shaderPath);
+	}
+}
+
+void MaterialLoader::SwapReloadedPipelines()
+{
+	PROFILER_CPU_ZONE;
+
+	// GPU can still use retired pipelines until all frames in flight are finished
+	for (auto it = m_retiredResources.begin(); it != m_retiredResources.end();)
+	{
+		if (--it->m_framesLeft == 0)
+		{
+			it = m_retiredResources.erase(it);
+			continue;
+		}
+		++it;
+	}
+
+	eastl::vector<ReloadedPipeline> reloaded;
+
+	{
+		std::lock_guard l(m_reloadMutex);
+		reloaded.swap(m_reloadedPipelines);
+	}
+
+	if (reloaded.empty())
+	{
+		return;
+	}
+
+	const uint32_t framesToKeep = Instance().Service<RenderService>().DeviceParams().m_framesInFlight + 1;
+
+	std::lock_guard l(m_mutex);
+
+	for (auto& [shader, pipeline] : reloaded)
+	{
+		const auto it = m_shaderToPipeline.find(shader);
+
+		// Material was fully reloaded while shader was compiling
+		if (it == m_shaderToPipeline.end())
+		{
+			continue;
+		}
+
+		// Pipeline could be resized while shader was compiling
+		if (pipeline->Descriptor().m_pass != it->second->Descriptor().m_pass)
+		{
+			pipeline->SetRenderPass(it->second->Descriptor().m_pass);
+		}
+
+		m_retiredResources.push_back({ std::move(it->second), framesToKeep });
+		it->second = std::move(pipeline);
+
+		// Permutations are rebuilt from the new pipeline on the next use
+		if (const auto permutationsIt = m_permutations.find(shader); permutationsIt != m_permutations.end())
+		{
+			for (auto& [_, permutation] : permutationsIt->second)
+			{
+				if (permutation)
+				{
+					m_retiredResources.push_back({ std::move(permutation), framesToKeep });
+				}
+			}
+			m_permutations.erase(permutationsIt);
+		}
+
+		core::log::info("[MaterialLoader] Swapped pipeline for shader '{}'", shader->Descriptor().m_path);
+	}
+}
+
+void MaterialLoader::BuildPermutation(const std::shared_ptr<rhi::Pipeline>& basePipeline, const eastl::vector<std::string>& features, uint32_t permutation)
+{
+	PROFILER_CPU_ZONE;
+
+	rhi::PipelineDescriptor desc;
+
+	{
+		// Render pass of the base pipeline can be replaced by resize meanwhile
+		std::lock_guard l(m_mutex);
+		desc = basePipeline->Descriptor();
+	}
+
+	const auto& shader = desc.m_shader;
+
+	// Permutation shares shader module and render pass with the base pipeline, only specialization differs
+	desc.m_specializationConstants = FeatureConstants(shader->Descriptor().m_reflection, features, permutation);
+
+	auto pipeline = Instance().Service<RenderService>().CreatePipeline(desc);
+
+	if (!pipeline)
+	{
+		core::log::error("[MaterialLoader] Failed to build permutation {:#x} for shader '{}'", permutation, shader->Descriptor().m_path);
+	}
+
+	std::lock_guard l(m_mutex);
+	m_builtPermutations.push_back({ shader, basePipeline, std::move(pipeline), permutation });
+}
+
+void MaterialLoader::UpdatePermutations()
+{
+	PROFILER_CPU_ZONE;
+
+	std::lock_guard l(m_mutex);
+
+	for (auto& built : m_builtPermutations)
+	{
+		const auto baseIt = m_shaderToPipeline.find(built.m_shader);
+		const auto permutationsIt = m_permutations.find(built.m_shader);
+
+		// Pipeline was recreated or reloaded while permutation was building, so it will be requested again
+		if (baseIt == m_shaderToPipeline.end() || baseIt->second != built.m_basePipeline || permutationsIt == m_permutations.end())
+		{
+			continue;
+		}
+
+		// Failed permutation keeps the empty entry, so default pipeline is used and the build isn't retried every frame
+		if (built.m_pipeline)
+		{
+			// Base pipeline could be resized while permutation was building
+			if (built.m_pipeline->Descriptor().m_pass != baseIt->second->Descriptor().m_pass)
+			{
+				built.m_pipeline->SetRenderPass(baseIt->second->Descriptor().m_pass);
+			}
+
+			permutationsIt->second[built.m_permutation] = std::move(built.m_pipeline);
+			core::log::debug("[MaterialLoader] Built permutation {:#x} for shader '{}'", built.m_permutation, built.m_shader->Descriptor().m_path);
+		}
+	}
+	m_builtPermutations.clear();
+
+	for (auto it = m_warmUpPermutations.begin(); it != m_warmUpPermutations.end();)
+	{
+		const auto& [resource, permutation] = *it;
+
+		if (resource->m_status == Resource::Status::LOADING)
+		{
+			++it;
+			continue;
+		}
+
+		if (resource->Ready())
+		{
+			const auto& material = resource->Material();
+			if (permutation != material->DefaultPermutation())
+			{
+				m_permutationRequests.push_back({ material->Shader(), material->Features(), permutation });
+			}
+		}
+
+		it = m_warmUpPermutations.erase(it);
+	}
+
+	auto& ts = Instance().Service<ThreadService>();
+
+	for (auto& request : m_permutationRequests)
+	{
+		const auto baseIt = m_shaderToPipeline.find(request.m_shader);
+		auto& permutations = m_permutations[request.m_shader];
+
+		if (baseIt == m_shaderToPipeline.end() || permutations.find(request.m_permutation) != permutations.end())
+		{
+			continue;
+		}
+
+		permutations[request.m_permutation] = nullptr;
+
+		// Permutations are independent, so all of them are built in parallel on background workers
+		ts.AddBackgroundTask([this, basePipeline = baseIt->second, features = std::move(request.m_features), permutation = request.m_permutation]()
+			{
+				BuildPermutation(basePipeline, features, permutation);
+			});
+	}
+	m_permutationRequests.clear();
 }
 
 MaterialResource::MaterialResource(const io::fs::path& path) : Resource(path)
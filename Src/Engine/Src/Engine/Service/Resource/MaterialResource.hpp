@@ -5,6 +5,8 @@
 #include <Engine/Service/Render/Material.hpp>
 #include <RHI/Texture.hpp>
 #include <taskflow/taskflow.hpp>
+#include <EASTL/vector_set.h>
+#include <chrono>
 
 namespace engine
 {
@@ -24,9 +26,17 @@ public:
 
 	virtual void					LoadSystemResources() override;
 
+	// Starts loading of the materials on background workers, so their pipelines are ready before the first use.
+	// Intended for loading screens, returned materials can be polled with Ready() until all of them are loaded.
+	// Listed permutations are built for every material right after it is loaded
+	eastl::vector<ResPtr<MaterialResource>> WarmUp(const eastl::vector<fs::path>& paths, const eastl::vector<uint32_t>& permutations = {});
+
+	// Returns pipeline for the current material permutation. If it isn't built yet,
+	// the build is scheduled and the pipeline for the default permutation is returned
 	const ResPtr<rhi::Pipeline>&	Pipeline(const ResPtr<MaterialResource>& res) const;
 
 	// Called automatically, don't call it unless you know what are you doing!!!
+	// Only attachments and render passes are recreated, pipelines are kept
 	void							ResizePipelines(glm::ivec2 extent, bool offscreen = true);
 
 	const ResPtr<MaterialResource>& RenderMaterial() const { return m_renderMaterial; }
@@ -61,6 +71,7 @@ private:
 		bool										m_offscreen = true; // ignored in compute
 		rhi::CompareOp								m_depthCompareOp = rhi::CompareOp::LESS; // ignored in compute
 		rhi::CullMode								m_cullMode = rhi::CullMode::BACK; // ignored in compute
+		eastl::vector<rhi::SpecializationConstant>	m_specializationConstants;
 	};
 
 	struct ParsedMaterial
@@ -69,17 +80,67 @@ private:
 		std::string			m_name;
 		uint8_t				m_version = std::numeric_limits<uint8_t>::max();
 		ParsedPipelineInfo	m_parsedPipeline;
+		// Feature name to its default value
+		eastl::vector<eastl::pair<std::string, bool>>	m_features;
+	};
+
+	struct ReloadedPipeline
+	{
+		// Shader materials were created with, pipelines are looked up by it
+		std::shared_ptr<rhi::Shader>	m_shader;
+		std::shared_ptr<rhi::Pipeline>	m_pipeline;
+	};
+
+	// Pipeline or render pass which can be still used by frames in flight
+	struct RetiredResource
+	{
+		std::shared_ptr<void>			m_resource;
+		uint32_t						m_framesLeft = 0;
 	};
 
-	bool							Load(const ResPtr<MaterialResource>& resource, bool forcePipelineRecreation = false);
+	struct PermutationRequest
+	{
+		std::shared_ptr<rhi::Shader>	m_shader;
+		eastl::vector<std::string>		m_features;
+		uint32_t						m_permutation = 0;
+	};
+
+	struct BuiltPermutation
+	{
+		std::shared_ptr<rhi::Shader>	m_shader;
+		// Pipeline the permutation was built from, result is dropped if it was replaced meanwhile
+		std::shared_ptr<rhi::Pipeline>	m_basePipeline;
+		std::shared_ptr<rhi::Pipeline>	m_pipeline;
+		uint32_t						m_permutation = 0;
+	};
+
+	bool							Load(const ResPtr<MaterialResource>& resource);
 	ParsedMaterial					ParseJson(std::ifstream& stream);
 	std::shared_ptr<rhi::Pipeline>	AllocatePipeline(ParsedPipelineInfo& info);
+	std::shared_ptr<rhi::RenderPass> AllocateRenderPass(ParsedPipelineInfo& info);
+	// Dependencies are resized first, so the new pass picks up their new attachments
+	void							ResizeRenderPass(const ResPtr<MaterialResource>& resource, glm::ivec2 extent, bool offscreen,
+													 eastl::vector_set<std::shared_ptr<rhi::Shader>>& resized);
+
+	// Shader hot-reload
+	void							WatchDependencies(const io::fs::path& shaderPath, const eastl::vector<std::string>& dependencies);
+	void							CheckShaderChanges();
+	void							ReloadShader(const io::fs::path& shaderPath);
+	// Must be called only between frames, when render thread doesn't use pipelines
+	void							SwapReloadedPipelines();
+
+	// Shader permutations
+	void							BuildPermutation(const std::shared_ptr<rhi::Pipeline>& basePipeline, const eastl::vector<std::string>& features, uint32_t permutation);
+	// Installs built permutations and starts builds for the requested ones, must be called only between frames
+	void							UpdatePermutations();
 
 	mutable std::mutex																	m_mutex;
 	eastl::vector<tf::Future<void>>														m_loadingTasks;
 	std::shared_ptr<rhi::ShaderCompiler>												m_shaderCompiler;
 	eastl::unordered_map<io::fs::path, std::shared_ptr<rhi::Shader>>					m_shaderCache;
 	eastl::unordered_map<std::shared_ptr<rhi::Shader>, std::shared_ptr<rhi::Pipeline>>	m_shaderToPipeline;
+	// Pipeline info without allocated attachments, used to recreate render pass on resize
+	eastl::unordered_map<std::shared_ptr<rhi::Shader>, ParsedPipelineInfo>				m_pipelineInfos;
 	eastl::unordered_map<fs::path, ResPtr<MaterialResource>>							m_cache;
 	ResPtr<MaterialResource>															m_renderMaterial;
 	ResPtr<MaterialResource>															m_presentMaterial;
@@ -89,6 +150,23 @@ private:
 	ResPtr<MaterialResource>															m_envmapPrefilterMaterial;
 	ResPtr<MaterialResource>															m_irradianceLoadMaterial;
 	ResPtr<MaterialResource>															m_prefilterLoadMaterial;
+
+	std::mutex																			m_reloadMutex;
+	// Absolute path of a shader source or include file to the shaders which are built from it
+	eastl::unordered_map<io::fs::path, eastl::vector_set<io::fs::path>>					m_shaderDependents;
+	eastl::unordered_map<io::fs::path, io::fs::file_time_type>							m_watchedFiles;
+	// Shader path to the flag whether it was changed again while being reloaded
+	eastl::unordered_map<io::fs::path, bool>											m_reloadsInProgress;
+	eastl::vector<ReloadedPipeline>														m_reloadedPipelines;
+	eastl::vector<RetiredResource>														m_retiredResources;
+	std::chrono::steady_clock::time_point												m_lastWatchCheck;
+
+	// Shader to its permutation pipelines, null pipeline means that permutation is being built
+	eastl::unordered_map<std::shared_ptr<rhi::Shader>, eastl::unordered_map<uint32_t, std::shared_ptr<rhi::Pipeline>>> m_permutations;
+	mutable eastl::vector<PermutationRequest>											m_permutationRequests;
+	// Materials which permutations must be built once they are loaded
+	eastl::vector<eastl::pair<ResPtr<MaterialResource>, uint32_t>>						m_warmUpPermutations;
+	eastl::vector<BuiltPermutation>														m_builtPermutations;
 };
 
 class ENGINE_API MaterialResource final : public Resource
@@ -34,27 +34,28 @@ std::shared_ptr<engine::render::SubMesh> BuildSubMesh(const eastl::vector<Vertex
 	}
 
 	auto& rs = engine::Instance().Service<engine::RenderService>();
-	engine::RPtr<rhi::Buffer> vb;
-	engine::RPtr<rhi::Buffer> ib;
+	const auto& arena = rs.GeometryArena();
 
-	rhi::BufferDescriptor vertexBufferDescriptor{};
-	vertexBufferDescriptor.m_type = rhi::BufferType::VERTEX;
-	vertexBufferDescriptor.m_size = static_cast<uint32_t>(vertices.size() * sizeof(Vertex));
-	vertexBufferDescriptor.m_memoryType = rhi::MemoryType::CPU_GPU;
-	vertexBufferDescriptor.m_name = fmt::format("SubMesh VB #{} | '{}'", index, path.generic_u8string());
-	vb = rs.CreateBuffer(vertexBufferDescriptor, vertices.data());
+	const auto vertexRange = arena->AllocateVertices(vertices.data(), static_cast<uint32_t>(vertices.size()), sizeof(Vertex));
+	if (!vertexRange.Valid())
+	{
+		core::log::error("[MeshLoader] Failed to allocate vertices of submesh #{} | '{}'", index, path.generic_u8string());
+		return {};
+	}
 
+	engine::render::GeometryArena::Range indexRange;
 	if (!indexes.empty())
 	{
-		rhi::BufferDescriptor indexBufferDescriptor{};
-		indexBufferDescriptor.m_type = rhi::BufferType::INDEX;
-		indexBufferDescriptor.m_size = static_cast<uint32_t>(indexes.size() * sizeof(uint32_t));
-		indexBufferDescriptor.m_memoryType = rhi::MemoryType::CPU_GPU;
-		indexBufferDescriptor.m_name = fmt::format("SubMesh IB #{} | '{}'", index, path.generic_u8string());
-		ib = rs.CreateBuffer(indexBufferDescriptor, indexes.data());
+		indexRange = arena->AllocateIndices(indexes.data(), static_cast<uint32_t>(indexes.size()));
+		if (!indexRange.Valid())
+		{
+			core::log::error("[MeshLoader] Failed to allocate indices of submesh #{} | '{}'", index, path.generic_u8string());
+			arena->Free(vertexRange, {});
+			return {};
+		}
 	}
 
-	return std::make_shared<engine::render::SubMesh>(vb, ib);
+	return std::make_shared<engine::render::SubMesh>(arena, vertexRange, indexRange);
 }
 
 } // unnamed
@@ -158,6 +159,9 @@ void MeshLoader::ProcessAiMesh(const aiMesh* mesh, const ResPtr<MeshResource>& r
 {
 	eastl::vector<Vertex> vertices;
 	eastl::vector<uint32_t> indexes;
+	render::AABB aabb;
+
+	vertices.reserve(mesh->mNumVertices);
 
 	for (uint32_t i = 0; i < mesh->mNumVertices; i++)
 	{
@@ -168,6 +172,7 @@ void MeshLoader::ProcessAiMesh(const aiMesh* mesh, const ResPtr<MeshResource>& r
 		vector.y = mesh->mVertices[i].y;
 		vector.z = mesh->mVertices[i].z;
 		vertex.position = vector;
+		aabb.Expand(vector);
 
 		if (mesh->HasNormals())
 		{
@@ -222,7 +227,19 @@ void MeshLoader::ProcessAiMesh(const aiMesh* mesh, const ResPtr<MeshResource>& r
 		}
 	}
 
+	render::BoundingSphere sphere;
+	sphere.m_center = aabb.Center();
+	for (const auto& vertex : vertices)
+	{
+		sphere.m_radius = glm::max(sphere.m_radius, glm::distance(sphere.m_center, vertex.position));
+	}
+
 	auto builtMesh = BuildSubMesh(vertices, indexes, resource->SourcePath(), resource->m_mesh->GetSubMeshList().size());
+	if (!builtMesh)
+	{
+		return;
+	}
+	builtMesh->SetBounds(aabb, sphere);
 	resource->m_mesh->AddSubMesh(builtMesh);
 }
 
@@ -135,6 +135,17 @@ tf::Future<void> ThreadService::AddForegroundTaskflow(tf::Taskflow& taskflow)
     return m_fgExecutor->run(taskflow);
 }
 
+void ThreadService::RunForegroundTaskflowAndWait(tf::Taskflow& taskflow)
+{
+    if (m_fgExecutor->this_worker_id() >= 0)
+    {
+        m_fgExecutor->corun(taskflow);
+        return;
+    }
+
+    m_fgExecutor->run(taskflow).wait();
+}
+
 std::unique_ptr<CustomThread> ThreadService::SpawnThread(std::string_view name)
 {
     return std::make_unique<CustomThread>(name);
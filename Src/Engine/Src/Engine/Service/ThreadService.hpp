@@ -28,6 +28,12 @@ public:
 
     tf::Future<void>                AddForegroundTaskflow(tf::Taskflow& taskflow);
 
+    // Runs taskflow on the foreground executor and blocks until it is finished.
+    // Can be called from foreground worker (e.g. from system update), in that case worker joins the execution instead of waiting
+    void                            RunForegroundTaskflowAndWait(tf::Taskflow& taskflow);
+
+    size_t                          ForegroundWorkersAmount() const { return m_fgExecutor->num_workers(); }
+
     std::unique_ptr<CustomThread>   SpawnThread(std::string_view name);
 
     // Consider using SpawnThread at first time
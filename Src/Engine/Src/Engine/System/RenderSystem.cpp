@@ -3,8 +3,15 @@
 #include <Engine/Service/Window/WindowService.hpp>
 #include <Engine/Service/EditorService.hpp>
 #include <Engine/Registration.hpp>
+#include <Engine/Service/Render/Material.hpp>
+#include <Engine/Service/Render/GeometryArena.hpp>
+#include <Engine/Service/ThreadService.hpp>
 #include <RHI/Pipeline.hpp>
+#include <RHI/Shader.hpp>
+#include <Core/Math.hpp>
 #include <glm/gtx/euler_angles.hpp>
+#include <algorithm>
+#include <limits>
 
 namespace
 {
@@ -12,6 +19,10 @@ namespace
 constexpr float         C_MOUSE_SENSITIVITY = 0.002f;
 constexpr float         C_EDITOR_CAMERA_SPEED = 20.0f;
 constexpr glm::vec3     C_WORLD_UP = glm::vec3(0, 1, 0);
+constexpr uint32_t      C_MIN_INSTANCE_CAPACITY = 1024;
+constexpr std::string_view C_INSTANCE_BUFFER_NAME = "InstanceBuffer";
+// Smaller lists don't pay off the cost of the worker task and the secondary command buffer
+constexpr uint32_t      C_MIN_DRAWS_PER_LIST = 128;
 
 } // unnamed
 
@@ -39,14 +50,285 @@ namespace engine
 
 RenderSystem::RenderSystem(ecs::World* world) : System(world)
 {
+    m_prepareThread = Instance().Service<ThreadService>().SpawnThread("Render Prepare");
+}
+
+RenderSystem::~RenderSystem()
+{
+    // Preparation task references the frames
+    if (m_prepare.valid())
+    {
+        m_prepare.wait();
+    }
 }
 
 void RenderSystem::Update(float dt)
 {
     PROFILER_CPU_ZONE;
 
+    // Slot of the new frame was recorded during the previous update, the other one was prepared since then
+    auto& extracted = m_frames[m_extractIndex];
+    auto& prepared = m_frames[m_extractIndex ^ 1];
+
+    Extract(extracted.m_snapshot);
+
+    if (m_prepare.valid())
+    {
+        PROFILER_CPU_ZONE_NAME("Wait for frame preparation");
+        m_prepare.wait();
+    }
+
+    // Culling and sorting of the new frame overlap recording of the prepared one and the next simulation step,
+    // so the frame is drawn one update after it was extracted
+    extracted.m_prepared = false;
+    m_prepare = m_prepareThread->AddTask([this, &extracted]
+        {
+            Prepare(extracted);
+        });
+
+    if (prepared.m_prepared)
+    {
+        Record(prepared);
+    }
+
+    m_extractIndex ^= 1;
+}
+
+void RenderSystem::Prepare(Frame& frame)
+{
+    PROFILER_CPU_ZONE;
+
+    const auto& snapshot = frame.m_snapshot;
+    auto& culler = frame.m_culler;
+    auto& queue = frame.m_queue;
+
+    culler.Clear();
+
+    for (const auto& mesh : snapshot.m_meshes)
+    {
+        culler.Push(mesh.m_mesh->Mesh()->BoundingBox(), &mesh.m_transform);
+    }
+
+    culler.Cull(snapshot.m_camera.m_projView);
+
+    queue.Clear();
+
+    for (size_t i = 0; i < snapshot.m_meshes.size(); ++i)
+    {
+        if (!culler.Visible(i))
+        {
+            continue;
+        }
+
+        const auto& mesh = snapshot.m_meshes[i];
+        const auto& transform = mesh.m_transform;
+
+        const auto* pipeline = mesh.m_pipeline.get();
+        const auto passId = queue.PassId(pipeline->Descriptor().m_pass.get());
+        const auto materialId = queue.MaterialId(mesh.m_material.get());
+
+        // Id space of the frame is exhausted, error is already reported by the queue
+        if (!passId || !materialId)
+        {
+            continue;
+        }
+
+        // Front to back order inside the same state, distance is quantized relative to camera far plane
+        const float distance = glm::length(glm::vec3(transform[3]) - glm::vec3(snapshot.m_camera.m_position));
+        const auto depth = static_cast<uint16_t>(glm::clamp(distance / snapshot.m_cameraFar, 0.0f, 1.0f) * std::numeric_limits<uint16_t>::max());
+
+        for (const auto& submesh : mesh.m_mesh->Mesh()->GetSubMeshList())
+        {
+            render::RenderQueue::DrawItem item;
+            item.m_key = render::RenderQueue::MakeKey(*passId, *materialId, queue.MeshId(submesh.get()), depth);
+            item.m_pipeline = pipeline;
+            item.m_material = &mesh.m_material;
+            item.m_submesh = submesh.get();
+            item.m_transform = &transform;
+
+            queue.Push(item);
+        }
+    }
+
+    queue.Sort();
+
+    frame.m_prepared = true;
+}
+
+void RenderSystem::Record(Frame& frame)
+{
+    PROFILER_CPU_ZONE;
+
+    auto& rs = Instance().Service<RenderService>();
+    const auto& queue = frame.m_queue;
+    const auto& cameraUB = frame.snapshot.m_camera;
+
+    // GPU resources of the frame are touched starting from here
+    rs.BeginRenderFrame();
+
+    UpdateInstanceBuffer(queue);
+
+    const uint32_t instanceBase = m_instanceFrame * m_instanceCapacity;
+
+    // Items of the same material are placed together, so each material is updated once
+    const MaterialResource* prevMaterial = nullptr;
+    for (size_t i = 0; i < queue.Size(); ++i)
+    {
+        const auto& material = *queue[i].m_material;
+
+        if (material.get() == prevMaterial)
+        {
+            continue;
+        }
+        prevMaterial = material.get();
+
+        auto& renderMaterial = *material->Material();
+        renderMaterial.UpdateBuffer(1, cameraUB);
+
+        if (const int slot = InstanceBufferSlot(renderMaterial); slot >= 0 && renderMaterial.GPUBuffer(slot) != m_instanceBuffer)
+        {
+            renderMaterial.SetBuffer(m_instanceBuffer, slot, rhi::ShaderStage::VERTEX);
+            renderMaterial.Sync();
+        }
+    }
+
+    // Queue is sorted by render pass first, so each pass is a contiguous range of items
+    for (size_t passBegin = 0; passBegin < queue.Size();)
+    {
+        const auto* pass = queue[passBegin].m_pipeline->Descriptor().m_pass.get();
+
+        size_t passEnd = passBegin + 1;
+        while (passEnd < queue.Size() && queue[passEnd].m_pipeline->Descriptor().m_pass.get() == pass)
+        {
+            ++passEnd;
+        }
+
+        RecordPass(queue, passBegin, passEnd, instanceBase);
+        passBegin = passEnd;
+    }
+}
+
+void RenderSystem::RecordPass(const render::RenderQueue& queue, size_t begin, size_t end, uint32_t instanceBase)
+{
+    PROFILER_CPU_ZONE;
+
+    auto& rs = Instance().Service<RenderService>();
+
+    // Items of the same material are placed together inside of the pass
+    m_passMaterials.clear();
+    for (size_t i = begin; i < end; ++i)
+    {
+        const auto& material = *queue[i].m_material;
+
+        if (m_passMaterials.empty() || m_passMaterials.back() != material)
+        {
+            m_passMaterials.push_back(material);
+        }
+    }
+
+    const auto workersAmount = static_cast<uint32_t>(Instance().Service<ThreadService>().ForegroundWorkersAmount());
+    const auto chunksAmount = std::clamp(static_cast<uint32_t>((end - begin + C_MIN_DRAWS_PER_LIST - 1) / C_MIN_DRAWS_PER_LIST), 1u, std::max(workersAmount, 1u));
+    const size_t chunkSize = (end - begin + chunksAmount - 1) / chunksAmount;
+
+    rs.RecordPass(rs.Pipeline(*queue[begin].m_material), m_passMaterials, chunksAmount, [&](uint32_t chunk, rhi::CommandList& list)
+        {
+            const size_t chunkBegin = begin + chunk * chunkSize;
+            RecordDraws(queue, chunkBegin, std::min(chunkBegin + chunkSize, end), instanceBase, list);
+        });
+}
+
+void RenderSystem::RecordDraws(const render::RenderQueue& queue, size_t begin, size_t end, uint32_t instanceBase, rhi::CommandList& list)
+{
+    auto& rs = Instance().Service<RenderService>();
+
+    const rhi::Pipeline* currentPipeline = nullptr;
+    const MaterialResource* currentMaterial = nullptr;
+    // Pipelines and materials are kept alive by the queue items, so the list references them by handles
+    rhi::PipelineHandle pipeline;
+    bool instanced = false;
+
+    // All submeshes live in the geometry arena, so its buffers are rebound only when the next submesh is in another block
+    const auto& arena = rs.GeometryArena();
+    uint32_t vertexBlock = std::numeric_limits<uint32_t>::max();
+    uint32_t indexBlock = std::numeric_limits<uint32_t>::max();
+
+    for (size_t i = begin; i < end;)
+    {
+        const auto& item = queue[i];
+        const auto& material = *item.m_material;
+
+        // List doesn't inherit any state, so the first item always binds its pipeline
+        if (item.m_pipeline != currentPipeline)
+        {
+            pipeline = item.m_pipeline->GetHandle();
+            list.BindPipeline(pipeline);
+
+            currentPipeline = item.m_pipeline;
+            currentMaterial = nullptr;
+        }
+
+        if (material.get() != currentMaterial)
+        {
+            rs.BindMaterial(material, pipeline, list);
+            currentMaterial = material.get();
+            instanced = InstanceBufferSlot(*material->Material()) >= 0;
+        }
+
+        // Materials which read transforms from the instance buffer draw whole run of the same submesh at once,
+        // others receive transform through push constant. Runs are split on the chunk boundaries
+        size_t runEnd = i + 1;
+
+        if (instanced)
+        {
+            while (runEnd < end && queue[runEnd].m_submesh == item.m_submesh && queue[runEnd].m_material->get() == currentMaterial)
+            {
+                ++runEnd;
+            }
+        }
+        else
+        {
+            list.PushConstant(item.m_transform, sizeof(glm::mat4), pipeline);
+        }
+
+        const auto instanceCount = static_cast<uint32_t>(runEnd - i);
+        const auto firstInstance = instanced ? instanceBase + static_cast<uint32_t>(i) : 0;
+
+        const auto& submesh = *item.m_submesh;
+
+        if (submesh.VertexBlock() != vertexBlock)
+        {
+            vertexBlock = submesh.VertexBlock();
+            list.BindVertexBuffer(arena->VertexBuffer(vertexBlock)->GetHandle());
+        }
+
+        if (submesh.Indexed() && submesh.IndexBlock() != indexBlock)
+        {
+            indexBlock = submesh.IndexBlock();
+            list.BindIndexBuffer(arena->IndexBuffer(indexBlock)->GetHandle());
+        }
+
+        if (submesh.Indexed())
+        {
+            list.DrawIndexed(submesh.IndexCount(), instanceCount, submesh.FirstIndex(), static_cast<int32_t>(submesh.VertexOffset()), firstInstance);
+        }
+        else
+        {
+            list.Draw(submesh.VertexCount(), instanceCount, submesh.VertexOffset(), firstInstance);
+        }
+
+        i = runEnd;
+    }
+}
+
+void RenderSystem::Extract(Snapshot& snapshot)
+{
+    PROFILER_CPU_ZONE;
+
+    auto& rs = Instance().Service<RenderService>();
+
     // Currently we support only one active camera at a time
-    CameraUB cameraUB{};
+    snapshot.m_camera = {};
+    snapshot.m_cameraFar = 1.0f;
 
     for (const auto [e, c, t] : W()->View<CameraComponent, TransformComponent>())
     {
@@ -55,84 +337,103 @@ void RenderSystem::Update(float dt)
             continue;
         }
 
-        cameraUB.m_position = glm::vec4(t.m_position, 1.0f);
-        cameraUB.m_projView = c.m_projView;
+        snapshot.m_camera.m_position = glm::vec4(t.m_position, 1.0f);
+        snapshot.m_camera.m_projView = c.m_projView;
+        snapshot.m_cameraFar = c.m_far;
         break;
     }
 
-    LightBufferUB lightBufferUB{};
+    snapshot.m_light = {};
 
     for (const auto [e, l, t] : W()->View<DirectionalLightComponent, TransformComponent>())
     {
-        lightBufferUB.m_directionalLight.m_position = glm::vec4(t.m_position, 1.0f);
-        lightBufferUB.m_directionalLight.m_color = glm::vec4(l.m_color, 1.0f);
-        lightBufferUB.m_directionalLight.m_intensity = l.m_intensity;
-        lightBufferUB.m_directionalLight.m_rotation = glm::vec4(glm::eulerAngles(t.m_rotation), 1.0f);
+        auto& light = snapshot.m_light.m_directionalLight;
+        light.m_position = glm::vec4(t.m_position, 1.0f);
+        light.m_color = glm::vec4(l.m_color, 1.0f);
+        light.m_intensity = l.m_intensity;
+        light.m_rotation = glm::vec4(glm::eulerAngles(t.m_rotation), 1.0f);
     }
 
-    auto& rs = Instance().Service<RenderService>();
-
-    // Sort all meshes by pipelines
-    eastl::vector_map<std::shared_ptr<rhi::Pipeline>, eastl::vector<eastl::reference_wrapper<MeshComponent>>> meshesMap;
-    eastl::vector<eastl::reference_wrapper<TransformComponent>> transforms;
+    snapshot.m_meshes.clear();
 
     for (const auto [e, mesh, t] : W()->View<MeshComponent, TransformComponent>())
     {
         ENGINE_ASSERT(mesh.m_material);
 
-        if (!mesh.m_mesh)
+        if (!mesh.m_mesh || !mesh.m_mesh->Ready())
         {
             continue;
         }
 
-        auto& pipeline = rs.Pipeline(mesh.m_material);
-
-        meshesMap[pipeline].emplace_back(mesh);
-        transforms.emplace_back(t);
+        // Pipelines are built on background workers, so meshes are drawn with the default material until their own is ready.
+        // Pipeline is resolved here, because shader reload may replace it while the frame is prepared
+        const auto& material = mesh.m_material->Ready() ? mesh.m_material : rs.DefaultMaterial();
+        snapshot.m_meshes.push_back({ mesh.m_mesh, material, rs.Pipeline(material), t.m_worldTransform });
     }
+}
+
+void RenderSystem::UpdateInstanceBuffer(const render::RenderQueue& queue)
+{
+    PROFILER_CPU_ZONE;
 
-    ENGINE_ASSERT(meshesMap.size() == transforms.size());
+    auto& rs = Instance().Service<RenderService>();
+    const uint32_t framesInFlight = rs.DeviceParams().m_framesInFlight;
+    const auto instancesAmount = static_cast<uint32_t>(queue.Size());
 
-    eastl::unordered_set<ResPtr<MaterialResource>> materials;
-    for (const auto& [pipeline, meshes] : meshesMap)
+    // Retired buffers could be still referenced by frames in flight
+    m_retiredInstanceBuffers.erase(eastl::remove_if(m_retiredInstanceBuffers.begin(), m_retiredInstanceBuffers.end(),
+        [framesInFlight](auto& retired) { return ++retired.second > framesInFlight; }), m_retiredInstanceBuffers.end());
+
+    if (!m_instanceBuffer || instancesAmount > m_instanceCapacity)
     {
-        for (const auto& mesh : meshes)
+        if (m_instanceBuffer)
         {
-            if (materials.find(mesh.get().m_material) != materials.end())
-            {
-                continue;
-            }
-
-            mesh.get().m_material->Material()->UpdateBuffer(1, cameraUB);
+            m_retiredInstanceBuffers.emplace_back(m_instanceBuffer, 0);
         }
+
+        m_instanceCapacity = core::math::roundUpToNextHighestPowerOfTwo(std::max(instancesAmount, C_MIN_INSTANCE_CAPACITY));
+
+        // Every frame in flight writes its own region of the buffer
+        rhi::BufferDescriptor descriptor{};
+        descriptor.m_size = core::math::roundToDivisible(m_instanceCapacity * framesInFlight * static_cast<uint32_t>(sizeof(glm::mat4)),
+            rs.DeviceParams().m_minUniformBufferAlignment);
+        descriptor.m_memoryType = rhi::MemoryType::CPU_GPU;
+        descriptor.m_type = rhi::BufferType::STORAGE;
+        descriptor.m_name = "InstanceBuffer";
+
+        m_instanceBuffer = rs.CreateBuffer(descriptor);
     }
 
-    int i = 0;
-    for (const auto& [pipeline, meshes] : meshesMap)
+    m_instanceFrame = (m_instanceFrame + 1) % framesInFlight;
+
+    if (instancesAmount == 0)
+    {
+        return;
+    }
+
+    auto* transforms = static_cast<glm::mat4*>(m_instanceBuffer->Map()) + m_instanceFrame * m_instanceCapacity;
+
+    for (uint32_t i = 0; i < instancesAmount; ++i)
     {
-        rs.BeginPass(pipeline);
+        transforms[i] = *queue[i].m_transform;
+    }
+
+    m_instanceBuffer->UnMap();
+}
+
+int RenderSystem::InstanceBufferSlot(render::Material& material)
+{
+    const auto& storageBuffers = material.Shader()->Descriptor().m_reflection.m_storageBufferMap;
 
-        for (const auto& mesh : meshes)
+    for (const auto& [slot, info] : storageBuffers)
+    {
+        if (info.m_name == C_INSTANCE_BUFFER_NAME)
         {
-            for (const auto& submesh : mesh.get().m_mesh->Mesh()->GetSubMeshList())
-            {
-                rs.BindMaterial(mesh.get().m_material);
-                rs.PushConstant(&transforms[i].get().m_worldTransform, sizeof(glm::mat4), pipeline);
-
-                if (submesh->IndexBuffer())
-                {
-                    rs.Draw(submesh->VertexBuffer(), submesh->IndexBuffer());
-                }
-                else
-                {
-                    rs.Draw(submesh->VertexBuffer(), pipeline->VertexCount(submesh->VertexBuffer()));
-                }
-            }
-            i++;
+            return slot;
         }
-
-        rs.EndPass(pipeline);
     }
+
+    return -1;
 }
 
 CameraSystem::CameraSystem(ecs::World* world) : System(world)
@@ -5,10 +5,22 @@
 #include <Engine/ECS/World.hpp>
 #include <Engine/ECS/Component.hpp>
 #include <Engine/Service/Resource/MeshResource.hpp>
+#include <Engine/Service/Render/RenderQueue.hpp>
+#include <Engine/Service/Render/FrustumCuller.hpp>
+#include <RHI/CommandList.hpp>
+#include <EASTL/array.h>
+#include <future>
 
 namespace engine
 {
 
+class CustomThread;
+
+namespace render
+{
+class Material;
+} // render
+
 struct PBRMaterialUB
 {
     // Default value is red plastic
@@ -16,13 +28,6 @@ struct PBRMaterialUB
 
     float m_roughness = 1.0f;
     float m_metallic = 0.0f;
-
-    bool m_useAlbedoTex = false;
-    bool m_useNormalTex = false;
-    bool m_useMetallicTex = false;
-    bool m_useRoughnessTex = false;
-
-    glm::vec2 _padding_;
 };
 
 struct CameraUB
@@ -60,9 +65,66 @@ class ENGINE_API RenderSystem : public ecs::System<RenderSystem>
 {
 public:
     RenderSystem(ecs::World* world);
-    virtual ~RenderSystem() = default;
+    virtual ~RenderSystem();
 
     virtual void Update(float dt) override;
+
+private:
+    struct Frame;
+    struct Snapshot;
+
+    // Copies render relevant state of the world to the snapshot, nothing else reads the world
+    void                Extract(Snapshot& snapshot);
+    // Called on the prepare thread, culls and sorts the frame reading its snapshot only
+    void                Prepare(Frame& frame);
+    // Updates GPU resources and records passes of the prepared frame
+    void                Record(Frame& frame);
+    // Writes transforms of all queued items to the current frame region of the instance buffer
+    void                UpdateInstanceBuffer(const render::RenderQueue& queue);
+    // Items of the range must use the same render pass, they are split into chunks recorded on the foreground workers
+    void                RecordPass(const render::RenderQueue& queue, size_t begin, size_t end, uint32_t instanceBase);
+    // Called on the foreground worker, reads the queue only
+    void                RecordDraws(const render::RenderQueue& queue, size_t begin, size_t end, uint32_t instanceBase, rhi::CommandList& list);
+    // Returns slot of the instance buffer in the material shader or -1 if shader doesn't use it
+    static int          InstanceBufferSlot(render::Material& material);
+
+    // State of the world at the end of simulation, the frame is prepared and recorded from it
+    struct Snapshot
+    {
+        struct Mesh
+        {
+            std::shared_ptr<MeshResource>       m_mesh;
+            // Ready material of the mesh or the default one
+            std::shared_ptr<MaterialResource>   m_material;
+            std::shared_ptr<rhi::Pipeline>      m_pipeline;
+            glm::mat4                           m_transform;
+        };
+
+        CameraUB                m_camera;
+        float                   m_cameraFar = 1.0f;
+        LightBufferUB           m_light;
+        eastl::vector<Mesh>     m_meshes;
+    };
+
+    struct Frame
+    {
+        Snapshot                m_snapshot;
+        render::FrustumCuller   m_culler;
+        render::RenderQueue     m_queue;
+        bool                    m_prepared = false;
+    };
+
+    // One frame is prepared while the other one is recorded
+    eastl::array<Frame, 2>      m_frames;
+    uint32_t                    m_extractIndex = 0;
+    std::future<void>           m_prepare;
+    std::unique_ptr<CustomThread> m_prepareThread;
+    eastl::vector<std::shared_ptr<MaterialResource>> m_passMaterials;
+
+    std::shared_ptr<rhi::Buffer>                                    m_instanceBuffer;
+    eastl::vector<eastl::pair<std::shared_ptr<rhi::Buffer>, uint32_t>>  m_retiredInstanceBuffers;
+    uint32_t                                                        m_instanceCapacity = 0;
+    uint32_t                                                        m_instanceFrame = 0;
 };
 
 struct ENGINE_API CameraComponent : public ecs::Component
@@ -1,7 +1,11 @@
 #include <Engine/System/TransformSystem.hpp>
+#include <Engine/Service/ThreadService.hpp>
+#include <Engine/Engine.hpp>
 #include <Engine/Registration.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <algorithm>
+#include <limits>
 
 RTTR_REGISTRATION
 {
@@ -12,6 +16,42 @@ RTTR_REGISTRATION
     engine::registration::Component<engine::TransformComponent>(Component::Type::ENGINE, "engine::TransformComponent");
 }
 
+namespace
+{
+
+// Amount of components processed by a single task
+constexpr size_t C_CHUNK_SIZE = 4096;
+constexpr uint32_t C_INVALID_DEPTH = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t C_MAX_DEPTH = 1024;
+
+template<typename Storage>
+uint32_t CalculateDepth(Storage& storage, engine::TransformComponent& t, uint32_t recursionDepth = 0)
+{
+    if (t.m_depth != C_INVALID_DEPTH)
+    {
+        return t.m_depth;
+    }
+
+    if (recursionDepth >= C_MAX_DEPTH)
+    {
+        core::log::error("[TransformSystem] Transform hierarchy is too deep or has a cycle, detaching transform");
+        t.m_parent = entt::null;
+    }
+
+    // Parent could be removed, in that case transform becomes a root
+    if (t.m_parent == entt::null || !storage.contains(t.m_parent))
+    {
+        t.m_parent = entt::null;
+        t.m_depth = 0;
+        return t.m_depth;
+    }
+
+    t.m_depth = CalculateDepth(storage, storage.get(t.m_parent), recursionDepth + 1) + 1;
+    return t.m_depth;
+}
+
+} // unnamed
+
 namespace engine
 {
 
@@ -23,12 +63,175 @@ void TransformSystem::Update(float dt)
 {
     PROFILER_CPU_ZONE;
 
-    for (auto [e, t] : W()->View<TransformComponent>())
+    if (W()->Storage<TransformComponent>().size() != m_componentsAmount)
+    {
+        RebuildHierarchy();
+    }
+
+    m_dirtyCounter = 0;
+    m_hierarchyInvalid = false;
+    m_forceUpdate = false;
+
+    UpdateLevels();
+
+    // Parent was changed or removed, so storage order doesn't match hierarchy anymore and some transforms
+    // could be calculated using stale parent data
+    if (m_hierarchyInvalid)
+    {
+        RebuildHierarchy();
+
+        m_dirtyCounter = 0;
+        m_hierarchyInvalid = false;
+        m_forceUpdate = true;
+
+        UpdateLevels();
+    }
+}
+
+void TransformSystem::RebuildHierarchy()
+{
+    PROFILER_CPU_ZONE;
+
+    auto& storage = W()->Storage<TransformComponent>();
+
+    for (auto& t : storage)
+    {
+        t.m_depth = C_INVALID_DEPTH;
+    }
+
+    uint32_t maxDepth = 0;
+    for (auto& t : storage)
     {
+        maxDepth = std::max(maxDepth, CalculateDepth(storage, t));
+    }
+
+    W()->Sort<TransformComponent>([](const TransformComponent& lhs, const TransformComponent& rhs)
+    {
+        return lhs.m_depth < rhs.m_depth;
+    });
+
+    m_componentsAmount = storage.size();
+
+    m_levelOffsets.clear();
+    m_levelOffsets.reserve(maxDepth + 2);
+
+    size_t index = 0;
+    for (auto it = storage.begin(); it != storage.end(); ++it, ++index)
+    {
+        while (m_levelOffsets.size() <= it->m_depth)
+        {
+            m_levelOffsets.push_back(index);
+        }
+    }
+    m_levelOffsets.push_back(m_componentsAmount);
+
+    // Levels are executed one after another, chunks of the same level are executed in parallel
+    m_taskflow.clear();
+
+    if (m_componentsAmount <= C_CHUNK_SIZE)
+    {
+        return;
+    }
+
+    tf::Task prevLevelSync;
+
+    for (size_t level = 0; level + 1 < m_levelOffsets.size(); ++level)
+    {
+        const size_t levelBegin = m_levelOffsets[level];
+        const size_t levelEnd = m_levelOffsets[level + 1];
+
+        tf::Task levelSync = m_taskflow.emplace([] {});
+
+        for (size_t begin = levelBegin; begin < levelEnd; begin += C_CHUNK_SIZE)
+        {
+            const size_t end = std::min(begin + C_CHUNK_SIZE, levelEnd);
+
+            auto task = m_taskflow.emplace([this, begin, end, levelBegin]
+            {
+                PROFILER_CPU_ZONE_NAME("TransformSystem chunk");
+                m_dirtyCounter.fetch_add(UpdateRange(begin, end, levelBegin), std::memory_order_relaxed);
+            });
+
+            task.precede(levelSync);
+
+            if (!prevLevelSync.empty())
+            {
+                task.succeed(prevLevelSync);
+            }
+        }
+
+        prevLevelSync = levelSync;
+    }
+}
+
+void TransformSystem::UpdateLevels()
+{
+    if (m_componentsAmount <= C_CHUNK_SIZE)
+    {
+        for (size_t level = 0; level + 1 < m_levelOffsets.size(); ++level)
+        {
+            m_dirtyCounter += UpdateRange(m_levelOffsets[level], m_levelOffsets[level + 1], m_levelOffsets[level]);
+        }
+        return;
+    }
+
+    if (m_executor)
+    {
+        m_executor->run(m_taskflow).wait();
+        return;
+    }
+
+    Instance().Service<ThreadService>().RunForegroundTaskflowAndWait(m_taskflow);
+}
+
+uint32_t TransformSystem::UpdateRange(size_t begin, size_t end, size_t levelBegin)
+{
+    auto& storage = W()->Storage<TransformComponent>();
+    const size_t size = storage.size();
+    uint32_t dirtyAmount = 0;
+
+    auto it = storage.begin() + begin;
+    for (size_t i = begin; i < end; ++i, ++it)
+    {
+        TransformComponent& t = *it;
+        const TransformComponent* parent = nullptr;
+
+        if (t.m_parent != entt::null)
+        {
+            if (storage.contains(t.m_parent))
+            {
+                // Parent must be placed in one of the previous levels, otherwise it might be not updated yet.
+                // Storage is iterated in reverse order of the packed array
+                if (size - 1 - storage.index(t.m_parent) >= levelBegin)
+                {
+                    m_hierarchyInvalid.store(true, std::memory_order_relaxed);
+                }
+                parent = &storage.get(t.m_parent);
+            }
+            else
+            {
+                m_hierarchyInvalid.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        const bool dirty = m_forceUpdate || t.IsModified() || t.IsRecentlyCreated() || (parent && parent->m_worldChanged);
+        t.m_worldChanged = dirty;
+
+        if (!dirty)
+        {
+            continue;
+        }
+
         const glm::mat4 rotationMatrix = glm::toMat4(glm::quat(t.m_rotation));
+        const glm::mat4 localTransform = glm::translate(glm::mat4(1.0f), t.m_position) * rotationMatrix * glm::scale(glm::mat4(1.0f), t.m_scale);
 
-        t.m_worldTransform = glm::translate(glm::mat4(1.0f), t.m_position) * rotationMatrix * glm::scale(glm::mat4(1.0f), t.m_scale);
+        t.m_worldTransform = parent ? parent->m_worldTransform * localTransform : localTransform;
+        t.Reset();
+        t.Init();
+        ++dirtyAmount;
     }
+
+    return dirtyAmount;
 }
 
 } // engine
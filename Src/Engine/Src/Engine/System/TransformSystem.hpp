@@ -6,6 +6,8 @@
 #include <Engine/ECS/Component.hpp>
 #include <glm/ext/quaternion_float.hpp>
 #include <glm/glm.hpp>
+#include <taskflow/taskflow.hpp>
+#include <atomic>
 
 namespace engine
 {
@@ -16,7 +18,14 @@ struct ENGINE_API TransformComponent : public ecs::Component
     glm::vec3 m_position = glm::vec3(0.0f, 0.0f, 0.0f);
     glm::vec3 m_scale = glm::vec3(1.0f, 1.0f, 1.0f);
 
+    // Position, rotation and scale are relative to the parent. Component must be modified after the parent change
+    entt::entity m_parent = entt::null;
+
     glm::mat4 m_worldTransform = glm::mat4(1.0f);
+
+    // Filled by TransformSystem
+    uint32_t  m_depth = 0;
+    bool      m_worldChanged = false;
 };
 
 class ENGINE_API TransformSystem : public ecs::System<TransformSystem>
@@ -26,6 +35,25 @@ public:
     virtual ~TransformSystem() = default;
 
     virtual void Update(float dt) override;
+
+    // Chunks are executed on the given executor instead of the foreground workers, so the system can run without engine instance,
+    // e.g. in benchmarks. Null restores the default
+    void         SetExecutor(tf::Executor* executor) { m_executor = executor; }
+
+private:
+    // Recalculates hierarchy depths, sorts storage by them and rebuilds per level tasks
+    void        RebuildHierarchy();
+    void        UpdateLevels();
+    uint32_t    UpdateRange(size_t begin, size_t end, size_t levelBegin);
+
+    tf::Taskflow            m_taskflow;
+    // Begin of each hierarchy level in the sorted storage, last element is the storage size
+    eastl::vector<size_t>   m_levelOffsets;
+    size_t                  m_componentsAmount = 0;
+    std::atomic<uint32_t>   m_dirtyCounter = 0;
+    std::atomic<bool>       m_hierarchyInvalid = false;
+    bool                    m_forceUpdate = false;
+    tf::Executor*           m_executor = nullptr;
 };
 
 } // engine
\ No newline at end of file
@@ -4,13 +4,13 @@
 
 namespace rhi
 {
-    std::shared_ptr<Device> Device::Create(const std::shared_ptr<IContext>& context)
+    std::shared_ptr<Device> Device::Create(const std::shared_ptr<IContext>& context, const Options& options)
     {
         static bool created = false;
         if (!created)
         {
             created = true;
-            return std::make_shared<vulkan::VulkanDevice>(std::static_pointer_cast<vulkan::VulkanContext>(context));
+            return std::make_shared<vulkan::VulkanDevice>(std::static_pointer_cast<vulkan::VulkanContext>(context), options);
         }
         RHI_ASSERT(false);
         return nullptr;
@@ -3,6 +3,7 @@
 #include <RHI/Config.hpp>
 #include <RHI/Assert.hpp>
 #include <RHI/BufferDescriptor.hpp>
+#include <RHI/Handle.hpp>
 #include <Core/Type.hpp>
 
 namespace rhi
@@ -33,8 +34,13 @@ public:
     const BufferDescriptor& Descriptor() const
     { return m_descriptor; }
 
+    // Invalid for constant buffers, they live only on CPU
+    BufferHandle            GetHandle() const
+    { return m_handle; }
+
 protected:
     BufferDescriptor    m_descriptor;
+    BufferHandle        m_handle;
     std::mutex          m_copyMutex;
 };
 
@@ -12,6 +12,7 @@ namespace rhi
         INDEX =         Bit(3),
         UNIFORM =       Bit(4),
         CONSTANT =      Bit(5),
+        STORAGE =       Bit(6),
     };
 
     struct BufferDescriptor
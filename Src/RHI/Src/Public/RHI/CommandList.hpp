@@ -0,0 +1,43 @@
+#pragma once
+
+#include <RHI/Config.hpp>
+#include <RHI/Device.hpp>
+#include <RHI/Handle.hpp>
+#include <Core/Type.hpp>
+
+namespace rhi
+{
+
+class Buffer;
+class Pipeline;
+class GPUMaterial;
+
+// Commands of the part of the render pass which are recorded on any thread, e.g. by foreground worker.
+// List must be recorded and ended on the thread which began it, no state is inherited from the pass or the other lists,
+// so pipeline must be bound before drawing
+class RHI_API CommandList : public core::NonCopyable
+{
+public:
+    virtual ~CommandList() = default;
+
+    // Pipeline must use the render pass the list was begun for
+    virtual void    BindPipeline(const std::shared_ptr<Pipeline>& pipeline) = 0;
+    virtual void    BindVertexBuffer(const std::shared_ptr<Buffer>& buffer) = 0;
+    virtual void    BindIndexBuffer(const std::shared_ptr<Buffer>& buffer) = 0;
+    virtual void    BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const DynamicOffsets& offsets = {}) = 0;
+    // Data is copied into the list right away
+    virtual void    PushConstant(const void* data, uint32_t size, const std::shared_ptr<Pipeline>& pipeline) = 0;
+    // Same as above, handles don't own the objects, caller keeps them alive until the list is executed
+    virtual void    BindPipeline(PipelineHandle pipeline) = 0;
+    virtual void    BindVertexBuffer(BufferHandle buffer) = 0;
+    virtual void    BindIndexBuffer(BufferHandle buffer) = 0;
+    virtual void    BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const DynamicOffsets& offsets = {}) = 0;
+    virtual void    PushConstant(const void* data, uint32_t size, PipelineHandle pipeline) = 0;
+    virtual void    Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) = 0;
+    virtual void    DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) = 0;
+
+    // No commands can be recorded after the list is ended
+    virtual void    End() = 0;
+};
+
+} // rhi
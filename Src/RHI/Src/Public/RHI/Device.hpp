@@ -7,7 +7,9 @@
 #include <RHI/IContext.hpp>
 #include <RHI/RenderPassDescriptor.hpp>
 #include <RHI/PipelineDescriptor.hpp>
+#include <RHI/Handle.hpp>
 #include <Core/Type.hpp>
+#include <EASTL/fixed_vector.h>
 
 namespace rhi
 {
@@ -19,8 +21,22 @@ class Texture;
 class RenderPass;
 class Pipeline;
 class GPUMaterial;
+class CommandList;
 struct ComputeState;
 
+constexpr uint8_t C_MAX_FRAMES_IN_FLIGHT = 3;
+
+// Offsets of dynamic uniform buffers in the order of their slots
+using DynamicOffsets = eastl::fixed_vector<uint32_t, 16, false>;
+
+struct TextureBarrier
+{
+    std::shared_ptr<Texture>    m_texture;
+    TextureLayout               m_layout = TextureLayout::SHADER_READ_ONLY;
+    // Previous content isn't needed, e.g. attachment is cleared on load
+    bool                        m_discard = false;
+};
+
 class RHI_API Device : public core::NonCopyable
 {
 public:
@@ -28,44 +44,121 @@ public:
     {}
     virtual ~Device() = default;
 
+    // Creation methods may be called from any thread at the same time, including while the frame is recorded.
+    // Created resources are visible to the GPU work submitted after the call returns. Texture data past the upload budget
+    // arrives in the later frames, unless the texture is bound or transitioned earlier
     virtual std::shared_ptr<ShaderCompiler>     CreateShaderCompiler(const ShaderCompiler::Options& options = {}) = 0;
     virtual std::shared_ptr<Buffer>             CreateBuffer(const BufferDescriptor& desc, const void* data) = 0;
     virtual std::shared_ptr<Shader>             CreateShader(const ShaderDescriptor& desc) = 0;
     virtual std::shared_ptr<Sampler>            CreateSampler(const SamplerDescriptor& desc) = 0;
     virtual std::shared_ptr<Texture>            CreateTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const void* data = {}) = 0;
+    // Creates texture which shares memory with the given one, returns null if it doesn't fit into that memory.
+    // Textures mustn't be used at the same time and each of them must be transitioned with discarding barrier before use
+    virtual std::shared_ptr<Texture>            CreateAliasedTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const std::shared_ptr<Texture>& memory) = 0;
     virtual std::shared_ptr<RenderPass>         CreateRenderPass(const RenderPassDescriptor& desc) = 0;
     virtual std::shared_ptr<Pipeline>           CreatePipeline(const PipelineDescriptor& desc) = 0;
     virtual std::shared_ptr<GPUMaterial>        CreateGPUMaterial(const std::shared_ptr<Shader>& shader) = 0;
 
+    // Writes data to the part of buffer, device local buffers are updated through the upload batch
+    virtual void                                UpdateBuffer(const std::shared_ptr<Buffer>& buffer, const void* data, uint32_t size, uint32_t offset = 0) = 0;
+
     virtual void                                BeginFrame() = 0;
     virtual void                                EndFrame() = 0;
     virtual void                                Present() = 0;
-    virtual void                                BeginPipeline(const std::shared_ptr<Pipeline>& pipeline) = 0;
+    // Transitions textures with a single barrier, textures which are already in the requested layout are skipped
+    virtual void                                Barrier(const eastl::vector<TextureBarrier>& barriers) = 0;
+    // Attachments are expected to be transitioned with Barrier beforehand, the ones which aren't are transitioned here.
+    // Attachments are left in attachment layouts when the pipeline ends.
+    // If command lists are used, contents of the pass can be only executed with ExecuteCommandLists
+    virtual void                                BeginPipeline(const std::shared_ptr<Pipeline>& pipeline, bool commandLists = false) = 0;
     virtual void                                EndPipeline(const std::shared_ptr<Pipeline>& pipeline) = 0;
+    // Switches pipeline inside of already begun one, both pipelines must use the same render pass
+    virtual void                                BindPipeline(const std::shared_ptr<Pipeline>& pipeline) = 0;
     virtual void                                BeginComputePipeline(const std::shared_ptr<Pipeline>& pipeline) = 0;
     virtual void                                EndComputePipeline(const std::shared_ptr<Pipeline>& pipeline) = 0;
     virtual std::shared_ptr<ComputeState>       BeginComputePipelineImmediate(const std::shared_ptr<Pipeline>& pipeline) = 0;
     virtual void                                EndComputePipeline(const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state) = 0;
     virtual void                                PushConstantComputeImmediate(const void* data, uint32_t size, const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state) = 0;
-    virtual void                                Draw(const std::shared_ptr<Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount) = 0;
-    virtual void                                Draw(const std::shared_ptr<Buffer>& vb, const std::shared_ptr<Buffer>& ib, uint32_t indexCount, uint32_t instanceCount) = 0;
+    virtual void                                Draw(const std::shared_ptr<Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance = 0) = 0;
+    virtual void                                Draw(const std::shared_ptr<Buffer>& vb, const std::shared_ptr<Buffer>& ib, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance = 0) = 0;
+    // Draws from currently bound vertex and index buffers
+    virtual void                                BindVertexBuffer(const std::shared_ptr<Buffer>& buffer) = 0;
+    virtual void                                BindIndexBuffer(const std::shared_ptr<Buffer>& buffer) = 0;
+    virtual void                                Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) = 0;
+    virtual void                                DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) = 0;
     virtual void                                Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
     virtual void                                Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, const std::shared_ptr<ComputeState>& state) = 0;
-    virtual void                                BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline) = 0;
-    virtual void                                BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state) = 0;
+    virtual void                                BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const DynamicOffsets& offsets = {}) = 0;
+    virtual void                                BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state, const DynamicOffsets& offsets = {}) = 0;
     virtual void                                PushConstant(const void* data, uint32_t size, const std::shared_ptr<Pipeline>& pipeline) = 0;
 
+    // Handle based submission for the per draw path, handles are resolved through the backend tables without touching reference counts.
+    // Handles don't own the objects, caller keeps the objects alive until the frame which uses them is recorded
+    virtual void                                BindPipeline(PipelineHandle pipeline) = 0;
+    virtual void                                BindVertexBuffer(BufferHandle buffer) = 0;
+    virtual void                                BindIndexBuffer(BufferHandle buffer) = 0;
+    virtual void                                BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const DynamicOffsets& offsets = {}) = 0;
+    virtual void                                BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const std::shared_ptr<ComputeState>& state, const DynamicOffsets& offsets = {}) = 0;
+    virtual void                                PushConstant(const void* data, uint32_t size, PipelineHandle pipeline) = 0;
+
+    // Begins list of commands for the offscreen render pass, may be called from any thread between BeginFrame and EndFrame.
+    // Lists are allocated from per thread pools, so threads record their lists in parallel without locking
+    virtual std::shared_ptr<CommandList>        BeginCommandList(const std::shared_ptr<RenderPass>& pass) = 0;
+    // Lists must be ended and begun for the pass of the current pipeline, they are executed in the given order
+    virtual void                                ExecuteCommandLists(const eastl::vector<std::shared_ptr<CommandList>>& lists) = 0;
+
     virtual void                                OnResize(uint32_t x, uint32_t y) = 0;
 
     virtual void                                WaitForIdle() = 0;
 
-    static std::shared_ptr<Device>              Create(const std::shared_ptr<IContext>& ctx);
+    struct Options
+    {
+        // File where driver pipeline cache is persisted between launches, cache is kept only in memory if empty
+        std::string m_pipelineCachePath;
+        // Amount of frames CPU may record ahead of GPU, clamped to [1, C_MAX_FRAMES_IN_FLIGHT]
+        uint8_t     m_framesInFlight = 2;
+    };
+
+    struct PipelineStats
+    {
+        uint32_t    m_createdPipelines = 0;
+        float       m_creationTimeMs = 0.0f;
+        // True if pipeline cache was loaded from disk
+        bool        m_warmCache = false;
+    };
+
+    virtual PipelineStats                       GetPipelineStats() const { return {}; }
+
+    // Counted for the last finished frame command buffer, immediate command buffers aren't included
+    struct BarrierStats
+    {
+        // Amount of barrier commands and image or buffer barriers batched in them
+        uint32_t    m_barriers = 0;
+        uint32_t    m_imageBarriers = 0;
+        uint32_t    m_bufferBarriers = 0;
+    };
+
+    virtual BarrierStats                        GetBarrierStats() const { return {}; }
+
+    struct FrameStats
+    {
+        // Time CPU waited for GPU to finish the frame which resources are reused, it is ~0 when CPU and GPU overlap
+        float       m_gpuWaitMs = 0.0f;
+        // Time between two frame begins
+        float       m_frameTimeMs = 0.0f;
+    };
+
+    virtual FrameStats                          GetFrameStats() const { return {}; }
+
+    static std::shared_ptr<Device>              Create(const std::shared_ptr<IContext>& ctx, const Options& options = {});
 
     struct Parameters
     {
         uint32_t    m_minUniformBufferAlignment = 64;
         uint8_t     m_framesInFlight = 1;
         float       m_maxSamplerAnisotropy = 0;
+        // Amount of bytes which are uploaded per frame, textures past the budget are queued to the next frames. 0 means no limit
+        uint32_t    m_uploadBudget = 32 * 1024 * 1024;
     };
 
     Parameters m_parameters;
@@ -19,8 +19,12 @@ public:
 
     virtual void Sync() = 0;
 
+    // Handle is replaced on every sync which switches the bindings, so it must be taken after the sync
+    GPUMaterialHandle GetHandle() const { return m_handle; }
+
 protected:
-    bool m_dirty = false;
+    bool              m_dirty = false;
+    GPUMaterialHandle m_handle;
 };
 
 } // rhi
\ No newline at end of file
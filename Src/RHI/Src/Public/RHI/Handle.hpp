@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rhi
+{
+
+// 32-bit reference to the device object, it doesn't own the object and costs nothing to copy.
+// Index addresses the slot of the backend pool, generation is bumped every time the slot is freed, so stale handles are detected.
+// Zero handle is invalid, generation of the live object is never zero
+template <typename T>
+class Handle
+{
+public:
+    static constexpr uint32_t C_INDEX_BITS = 20;
+    static constexpr uint32_t C_MAX_INDEX = (1u << C_INDEX_BITS) - 1;
+    static constexpr uint32_t C_MAX_GENERATION = (1u << (32 - C_INDEX_BITS)) - 1;
+
+    constexpr Handle() = default;
+    constexpr Handle(uint32_t index, uint32_t generation) : m_value((generation << C_INDEX_BITS) | index)
+    {}
+
+    constexpr uint32_t  Index() const { return m_value & C_MAX_INDEX; }
+    constexpr uint32_t  Generation() const { return m_value >> C_INDEX_BITS; }
+    constexpr uint32_t  Raw() const { return m_value; }
+    constexpr bool      Valid() const { return m_value != 0; }
+
+    constexpr bool      operator==(Handle other) const { return m_value == other.m_value; }
+    constexpr bool      operator!=(Handle other) const { return m_value != other.m_value; }
+
+    static constexpr uint32_t NextGeneration(uint32_t generation) { return generation == C_MAX_GENERATION ? 1 : generation + 1; }
+
+private:
+    uint32_t m_value = 0;
+};
+
+class Buffer;
+class Texture;
+class Pipeline;
+class GPUMaterial;
+
+using BufferHandle = Handle<Buffer>;
+using TextureHandle = Handle<Texture>;
+using PipelineHandle = Handle<Pipeline>;
+using GPUMaterialHandle = Handle<GPUMaterial>;
+
+} // rhi
@@ -14,7 +14,8 @@ public:
     virtual ~IImguiProvider() {}
 
     virtual void                        Begin() = 0;
-    virtual void                        End() = 0;
+    // Draw data must stay valid until the call is finished
+    virtual void                        End(ImDrawData* drawData) = 0;
     [[nodiscard]] virtual ImTextureID   Image(const std::shared_ptr<Texture>& texture, const ImVec2& size, const ImVec2& uv0, const ImVec2& uv1) = 0;
 
     // Removes image of the internal cache
@@ -4,6 +4,8 @@
 #include <RHI/Shader.hpp>
 #include <RHI/Buffer.hpp>
 #include <RHI/PipelineDescriptor.hpp>
+#include <RHI/RenderPass.hpp>
+#include <RHI/Handle.hpp>
 #include <cstdint>
 
 namespace rhi
@@ -16,6 +18,19 @@ public:
 
     const PipelineDescriptor& Descriptor() const { return m_descriptor; }
 
+    PipelineHandle GetHandle() const { return m_handle; }
+
+    // Pipelines are created against attachment formats only, so the pass with the same attachment layout
+    // (e.g. resized one) can replace the current one without pipeline recreation.
+    // Must be called only when render thread doesn't record commands with this pipeline
+    void SetRenderPass(const std::shared_ptr<RenderPass>& pass)
+    {
+        RHI_ASSERT(!m_descriptor.m_compute && pass);
+        RHI_ASSERT(pass->Descriptor().m_colorAttachments.size() == m_descriptor.m_pass->Descriptor().m_colorAttachments.size());
+        RHI_ASSERT(pass->HasDepth() == m_descriptor.m_pass->HasDepth());
+        m_descriptor.m_pass = pass;
+    }
+
     inline uint32_t VertexCount(const std::shared_ptr<rhi::Buffer>& buffer) const
     {
         const auto& desc = buffer->Descriptor();
@@ -25,6 +40,7 @@ public:
 
 protected:
     PipelineDescriptor m_descriptor;
+    PipelineHandle     m_handle;
 
     Pipeline(const PipelineDescriptor& descriptor) : m_descriptor(descriptor)
     {
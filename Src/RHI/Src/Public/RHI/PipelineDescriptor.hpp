@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 
 namespace rhi
 {
@@ -22,21 +23,36 @@ enum class CullMode : uint8_t
     FRONT
 };
 
+struct StorageTexture
+{
+    std::shared_ptr<Texture>    m_texture;
+    // Mip which is written by the pass, only it is transitioned to the storage layout. All mips are transitioned if it isn't set
+    std::optional<uint8_t>      m_mipLevel;
+};
+
 struct ComputePass
 {
     eastl::vector<std::shared_ptr<Texture>> m_textures;
-    eastl::vector<std::shared_ptr<Texture>> m_storageTextures;
+    eastl::vector<StorageTexture>           m_storageTextures;
+};
+
+// Value for the shader specialization constant, booleans are passed as 0 or 1
+struct SpecializationConstant
+{
+    uint32_t    m_id = 0;
+    uint32_t    m_value = 0;
 };
 
 struct PipelineDescriptor
 {
-    std::shared_ptr<Shader>         m_shader;
-    std::shared_ptr<ComputePass>    m_computePass;
-    std::shared_ptr<RenderPass>     m_pass; // ignored in compute
-    CompareOp                       m_depthCompareOp = CompareOp::LESS; // ignored in compute
-    CullMode                        m_cullMode = CullMode::BACK; // ignored in compute
-    bool                            m_offscreen = true; // ignored in compute
-    bool                            m_compute = false;
+    std::shared_ptr<Shader>                 m_shader;
+    std::shared_ptr<ComputePass>            m_computePass;
+    std::shared_ptr<RenderPass>             m_pass; // ignored in compute
+    CompareOp                               m_depthCompareOp = CompareOp::LESS; // ignored in compute
+    CullMode                                m_cullMode = CullMode::BACK; // ignored in compute
+    bool                                    m_offscreen = true; // ignored in compute
+    bool                                    m_compute = false;
+    eastl::vector<SpecializationConstant>   m_specializationConstants;
 };
 
 }
\ No newline at end of file
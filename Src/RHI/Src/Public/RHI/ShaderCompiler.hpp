@@ -3,6 +3,7 @@
 #include <RHI/Config.hpp>
 #include <RHI/ShaderDescriptor.hpp>
 #include <Core/Blob.hpp>
+#include <memory>
 
 namespace rhi
 {
@@ -11,16 +12,55 @@ namespace rhi
     {
         ShaderReflection                                m_reflection;
         eastl::unordered_map<ShaderStage, core::Blob>    m_stageBlob;
+        // Absolute paths of all files shader source was assembled from, including shader itself
+        eastl::vector<std::string>                      m_dependencies;
         bool                                            m_valid = false;
     };
 
-    // API assumes that there will be only one instance of shader compiler in application, please follow that rule!
+    enum class ShaderProfile : uint8_t
+    {
+        // Unoptimized shaders with full debug info, disassembly is produced
+        DEBUG,
+        // SPIR-V optimizer is run and source level debug info is stripped
+        RELEASE
+    };
+
+    inline std::string_view ShaderProfileToString(ShaderProfile profile)
+    {
+        switch (profile)
+        {
+        case ShaderProfile::DEBUG: return "Debug";
+        case ShaderProfile::RELEASE: return "Release";
+        default:
+            {
+                RHI_ASSERT(false);
+                return "";
+            }
+        }
+    }
+
+    // Compile is reentrant, shaders can be compiled from any amount of threads at once
     class RHI_API ShaderCompiler
     {
     public:
         // TODO: Implement options: switch Vulkan API version, shader code version, etc
         struct Options
-        {};
+        {
+            // Directory where compiled shaders are cached between launches, cache is disabled if empty
+            std::string     m_cacheDirectory;
+            ShaderProfile   m_profile = ShaderProfile::DEBUG;
+            // Release profile only, optimizer prefers smaller code over performance
+            bool            m_optimizeSize = false;
+        };
+
+        struct Stats
+        {
+            uint32_t    m_cacheHits = 0;
+            uint32_t    m_cacheMisses = 0;
+            // Only shaders which were actually compiled, cached ones are not counted
+            uint64_t    m_compiledBlobSize = 0;
+            float       m_compileTimeMs = 0.0f;
+        };
 
         ShaderCompiler(Options options) : m_options(options)
         {}
@@ -31,8 +71,21 @@ namespace rhi
         // Path must be absolute
         virtual CompiledShaderData Compile(std::string_view path, ShaderType type = ShaderType::FX) = 0;
 
+        // Drops everything compiler keeps in memory for the file, so the next compile reads it from disk again
+        virtual void    Invalidate(std::string_view path) {}
+
+        virtual Stats   GetStats() const { return {}; }
+
+        const Options&  GetOptions() const { return m_options; }
+
     protected:
         Options m_options;
     };
 
+    namespace vulkan
+    {
+        // Compiler doesn't depend on the device, so shaders can be compiled without creating one, e.g. in benchmarks
+        std::shared_ptr<ShaderCompiler> RHI_API CreateShaderCompiler(const ShaderCompiler::Options& options = {});
+    }
+
 }
\ No newline at end of file
@@ -63,18 +63,26 @@ struct ShaderReflection
         }
     };
 
+    struct SpecializationConstantInfo
+    {
+        std::string m_name;
+        uint32_t    m_id = 0;
+    };
+
     using BufferMap = eastl::unordered_map<uint8_t, BufferInfo>;
     using TextureList = eastl::vector_set<TextureInfo>;
 
-    BufferMap           m_bufferMap;
-    BufferMap           m_storageBufferMap;
+    BufferMap                                   m_bufferMap;
+    BufferMap                                   m_storageBufferMap;
     // Only in vertex shader now
-    BufferInfo          m_pushConstant;
-    TextureList         m_textures;
-    TextureList         m_storageImages;
-    VertexBufferLayout  m_inputLayout;
+    BufferInfo                                  m_pushConstant;
+    TextureList                                 m_textures;
+    TextureList                                 m_storageImages;
+    VertexBufferLayout                          m_inputLayout;
     // Only in fragment shader now
-    uint8_t             m_outputAmount;
+    uint8_t                                     m_outputAmount;
+    // Constants of all stages, constant with the same id is listed once
+    eastl::vector<SpecializationConstantInfo>   m_specializationConstants;
 };
 
 struct ShaderDescriptor
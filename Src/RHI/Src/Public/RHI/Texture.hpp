@@ -3,6 +3,7 @@
 #include <RHI/Config.hpp>
 #include <RHI/TextureDescriptor.hpp>
 #include <RHI/Sampler.hpp>
+#include <RHI/Handle.hpp>
 
 namespace rhi
 {
@@ -16,6 +17,8 @@ public:
 
     const std::shared_ptr<Sampler>& GetSampler() const { return m_sampler; }
 
+    TextureHandle                   GetHandle() const { return m_handle; }
+
     uint16_t                        Width() const { return m_descriptor.m_width; }
     uint16_t                        Height() const { return m_descriptor.m_height; }
 
@@ -33,6 +36,7 @@ protected:
     TextureDescriptor           m_descriptor;
     InternalParams              m_params;
     std::shared_ptr<Sampler>    m_sampler;
+    TextureHandle               m_handle;
 
     Texture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler) : m_descriptor(desc), m_sampler(sampler)
     {
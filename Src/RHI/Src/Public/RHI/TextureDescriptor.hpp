@@ -16,6 +16,14 @@ enum class TextureType : uint8_t
     TEXTURE_CUBEMAP
 };
 
+enum class TextureLayout : uint8_t
+{
+    UNDEFINED,
+    SHADER_READ_ONLY,
+    COLOR_ATTACHMENT,
+    DEPTH_STENCIL_ATTACHMENT
+};
+
 constexpr uint8_t C_MAX_MIPMAP = 255;
 
 struct RHI_API TextureDescriptor
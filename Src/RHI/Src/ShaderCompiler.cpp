@@ -1,6 +1,17 @@
 #include <RHI/ShaderCompiler.hpp>
+#include "Vulkan/VulkanShaderCompiler.hpp"
 
 namespace rhi
 {
-    
+
+namespace vulkan
+{
+
+std::shared_ptr<ShaderCompiler> CreateShaderCompiler(const ShaderCompiler::Options& options)
+{
+    return std::make_shared<VulkanShaderCompiler>(options);
 }
+
+} // namespace vulkan
+
+} // namespace rhi
@@ -0,0 +1,171 @@
+#include "BarrierBatcher.hpp"
+#include "VulkanTexture.hpp"
+#include "VulkanHelpers.hpp"
+
+namespace rhi::vulkan
+{
+
+void BarrierBatcher::Transition(VulkanTexture& texture, VkImageLayout newLayout, bool discard, uint32_t baseMip, uint32_t mipCount)
+{
+    const uint32_t mipLevels = texture.MipLevels();
+    const uint32_t layers = texture.LayerCount();
+
+    RHI_ASSERT(baseMip < mipLevels);
+
+    if (mipCount == VK_REMAINING_MIP_LEVELS)
+    {
+        mipCount = mipLevels - baseMip;
+    }
+
+    RHI_ASSERT(baseMip + mipCount <= mipLevels);
+
+    // Memory of aliased texture could be overwritten by the other one, so discard is never skipped for it
+    // and it must wait for all previous users of the memory
+    const bool discardAliased = discard && texture.Aliased();
+
+    for (uint32_t mip = baseMip; mip < baseMip + mipCount; ++mip)
+    {
+        // Layers with the same layout are transitioned by one barrier
+        for (uint32_t layer = 0; layer < layers;)
+        {
+            const auto oldLayout = texture.Layout(mip, layer);
+
+            uint32_t lastLayer = layer + 1;
+            while (lastLayer < layers && texture.Layout(mip, lastLayer) == oldLayout)
+            {
+                ++lastLayer;
+            }
+
+            if (oldLayout != newLayout || discardAliased)
+            {
+                const auto srcLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : oldLayout;
+
+                VkImageMemoryBarrier2 barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                barrier.srcStageMask = discardAliased ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : helpers::LayoutStages(srcLayout);
+                barrier.srcAccessMask = discardAliased ? VK_ACCESS_2_MEMORY_WRITE_BIT : helpers::LayoutAccess(srcLayout);
+                barrier.dstStageMask = helpers::LayoutStages(newLayout);
+                barrier.dstAccessMask = helpers::LayoutAccess(newLayout);
+                barrier.oldLayout = srcLayout;
+                barrier.newLayout = newLayout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = texture.Image();
+                barrier.subresourceRange.aspectMask = texture.Aspect();
+                barrier.subresourceRange.baseMipLevel = mip;
+                barrier.subresourceRange.levelCount = 1;
+                barrier.subresourceRange.baseArrayLayer = layer;
+                barrier.subresourceRange.layerCount = lastLayer - layer;
+
+                AddImageBarrier(barrier);
+            }
+
+            layer = lastLayer;
+        }
+    }
+
+    texture.SetLayout(newLayout, baseMip, mipCount);
+}
+
+void BarrierBatcher::Transition(VkImage image,
+                                const VkImageSubresourceRange& range,
+                                VkImageLayout oldLayout,
+                                VkImageLayout newLayout,
+                                VkPipelineStageFlags2 srcStages,
+                                VkPipelineStageFlags2 dstStages)
+{
+    VkImageMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = helpers::LayoutAccess(oldLayout);
+    barrier.dstStageMask = dstStages;
+    barrier.dstAccessMask = helpers::LayoutAccess(newLayout);
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = range;
+
+    AddImageBarrier(barrier);
+}
+
+void BarrierBatcher::BufferBarrier(VkBuffer buffer,
+                                   VkPipelineStageFlags2 srcStages,
+                                   VkAccessFlags2 srcAccess,
+                                   VkPipelineStageFlags2 dstStages,
+                                   VkAccessFlags2 dstAccess)
+{
+    VkBufferMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = dstStages;
+    barrier.dstAccessMask = dstAccess;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+
+    m_bufferBarriers.push_back(barrier);
+}
+
+bool BarrierBatcher::Flush(VkCommandBuffer cmdBuffer)
+{
+    if (Empty())
+    {
+        return false;
+    }
+
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_imageBarriers.size());
+    dependencyInfo.pImageMemoryBarriers = m_imageBarriers.data();
+    dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferBarriers.size());
+    dependencyInfo.pBufferMemoryBarriers = m_bufferBarriers.data();
+
+    vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+
+    m_stats.m_barriers++;
+    m_stats.m_imageBarriers += static_cast<uint32_t>(m_imageBarriers.size());
+    m_stats.m_bufferBarriers += static_cast<uint32_t>(m_bufferBarriers.size());
+
+    m_imageBarriers.clear();
+    m_bufferBarriers.clear();
+
+    return true;
+}
+
+void BarrierBatcher::AddImageBarrier(const VkImageMemoryBarrier2& barrier)
+{
+    // Barrier of the next mip with the same layers and layouts extends the previous one, so uniformly laid out images
+    // are transitioned by a single barrier
+    if (!m_imageBarriers.empty())
+    {
+        auto& last = m_imageBarriers.back();
+        auto& lastRange = last.subresourceRange;
+        const auto& range = barrier.subresourceRange;
+
+        if (last.image == barrier.image
+            && last.oldLayout == barrier.oldLayout
+            && last.newLayout == barrier.newLayout
+            && last.srcStageMask == barrier.srcStageMask
+            && last.srcAccessMask == barrier.srcAccessMask
+            && last.dstStageMask == barrier.dstStageMask
+            && lastRange.aspectMask == range.aspectMask
+            && lastRange.baseArrayLayer == range.baseArrayLayer
+            && lastRange.layerCount == range.layerCount
+            && lastRange.levelCount != VK_REMAINING_MIP_LEVELS
+            && range.levelCount != VK_REMAINING_MIP_LEVELS
+            && lastRange.baseMipLevel + lastRange.levelCount == range.baseMipLevel)
+        {
+            lastRange.levelCount += range.levelCount;
+            return;
+        }
+    }
+
+    m_imageBarriers.push_back(barrier);
+}
+
+} // rhi::vulkan
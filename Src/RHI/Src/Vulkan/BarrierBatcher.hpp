@@ -0,0 +1,59 @@
+#pragma once
+
+#include <RHI/Config.hpp>
+#include <EASTL/vector.h>
+#include <vulkan/vulkan.h>
+
+namespace rhi::vulkan
+{
+
+class VulkanTexture;
+
+// Accumulates image and buffer barriers of one command buffer and issues them with a single vkCmdPipelineBarrier2 on flush.
+// Texture layouts are tracked per mip and layer, so only subresources which layout actually changes are transitioned
+class RHI_API BarrierBatcher
+{
+public:
+    struct Stats
+    {
+        // Amount of vkCmdPipelineBarrier2 calls and barriers in them
+        uint32_t    m_barriers = 0;
+        uint32_t    m_imageBarriers = 0;
+        uint32_t    m_bufferBarriers = 0;
+    };
+
+    // Texture is considered transitioned right after the call. Previous content is dropped if discard is set
+    void            Transition(VulkanTexture& texture,
+                               VkImageLayout newLayout,
+                               bool discard = false,
+                               uint32_t baseMip = 0,
+                               uint32_t mipCount = VK_REMAINING_MIP_LEVELS);
+    // Transition of the image which layout isn't tracked, e.g. swapchain image
+    void            Transition(VkImage image,
+                               const VkImageSubresourceRange& range,
+                               VkImageLayout oldLayout,
+                               VkImageLayout newLayout,
+                               VkPipelineStageFlags2 srcStages,
+                               VkPipelineStageFlags2 dstStages);
+    void            BufferBarrier(VkBuffer buffer,
+                                  VkPipelineStageFlags2 srcStages,
+                                  VkAccessFlags2 srcAccess,
+                                  VkPipelineStageFlags2 dstStages,
+                                  VkAccessFlags2 dstAccess);
+
+    // Records all accumulated barriers, returns false if there was nothing to record
+    bool            Flush(VkCommandBuffer cmdBuffer);
+
+    bool            Empty() const { return m_imageBarriers.empty() && m_bufferBarriers.empty(); }
+    const Stats&    GetStats() const { return m_stats; }
+    void            ResetStats() { m_stats = {}; }
+
+private:
+    void            AddImageBarrier(const VkImageMemoryBarrier2& barrier);
+
+    eastl::vector<VkImageMemoryBarrier2>    m_imageBarriers;
+    eastl::vector<VkBufferMemoryBarrier2>   m_bufferBarriers;
+    Stats                                   m_stats;
+};
+
+} // rhi::vulkan
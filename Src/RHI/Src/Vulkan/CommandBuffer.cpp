@@ -8,7 +8,8 @@ CommandBuffer::CommandBuffer()
 {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = VulkanDevice::s_ctx.m_instance->CommandPool();
+    // Immediate command buffers are recorded on any thread, e.g. by resource loaders
+    allocInfo.commandPool = VulkanDevice::s_ctx.m_instance->ThreadCommandPool();
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     allocInfo.commandBufferCount = 1;
 
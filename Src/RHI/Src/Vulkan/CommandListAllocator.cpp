@@ -0,0 +1,97 @@
+#include "CommandListAllocator.hpp"
+#include "VulkanDevice.hpp"
+
+namespace rhi::vulkan
+{
+
+namespace
+{
+
+// Buffers are allocated in batches, so a thread rarely goes to the driver in the middle of recording
+constexpr uint32_t C_ALLOCATION_BATCH = 8;
+
+} // unnamed
+
+CommandListAllocator::CommandListAllocator(uint32_t queueFamily, uint32_t framesInFlight) : m_queueFamily(queueFamily), m_framesInFlight(framesInFlight)
+{
+    RHI_ASSERT(m_framesInFlight > 0);
+}
+
+CommandListAllocator::~CommandListAllocator()
+{
+    for (auto& [id, pools] : m_threadPools)
+    {
+        for (auto& framePool : *pools)
+        {
+            vkDestroyCommandPool(VulkanDevice::s_ctx.m_device, framePool.m_pool, nullptr);
+        }
+    }
+}
+
+VkCommandBuffer CommandListAllocator::Allocate(uint32_t frameIndex)
+{
+    RHI_ASSERT(frameIndex < m_framesInFlight);
+
+    // Pools of the thread are touched only by this thread until the next frame, so the lock is needed just for the lookup
+    auto& framePool = CurrentThreadPools()[frameIndex];
+
+    if (framePool.m_used == framePool.m_buffers.size())
+    {
+        const auto prevSize = framePool.m_buffers.size();
+        framePool.m_buffers.resize(prevSize + C_ALLOCATION_BATCH);
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = framePool.m_pool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = C_ALLOCATION_BATCH;
+
+        RHI_ASSERT(vkAllocateCommandBuffers(VulkanDevice::s_ctx.m_device, &allocInfo, framePool.m_buffers.data() + prevSize) == VK_SUCCESS);
+    }
+
+    return framePool.m_buffers[framePool.m_used++];
+}
+
+void CommandListAllocator::NextFrame(uint32_t frameIndex)
+{
+    RHI_ASSERT(frameIndex < m_framesInFlight);
+
+    std::lock_guard l(m_mutex);
+
+    for (auto& [id, pools] : m_threadPools)
+    {
+        auto& framePool = (*pools)[frameIndex];
+
+        if (framePool.m_used > 0)
+        {
+            RHI_ASSERT(vkResetCommandPool(VulkanDevice::s_ctx.m_device, framePool.m_pool, 0) == VK_SUCCESS);
+            framePool.m_used = 0;
+        }
+    }
+}
+
+CommandListAllocator::ThreadPools& CommandListAllocator::CurrentThreadPools()
+{
+    std::lock_guard l(m_mutex);
+
+    auto& pools = m_threadPools[std::this_thread::get_id()];
+
+    if (!pools)
+    {
+        pools = std::make_unique<ThreadPools>(m_framesInFlight);
+
+        for (auto& framePool : *pools)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = m_queueFamily;
+
+            RHI_ASSERT(vkCreateCommandPool(VulkanDevice::s_ctx.m_device, &poolInfo, nullptr, &framePool.m_pool) == VK_SUCCESS);
+        }
+    }
+
+    return *pools;
+}
+
+} // rhi::vulkan
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <RHI/Config.hpp>
+#include <vulkan/vulkan.h>
+#include <EASTL/vector.h>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+
+namespace rhi::vulkan
+{
+
+// Secondary command buffers for the command lists recorded on arbitrary threads.
+// Every thread gets its own command pool per frame in flight, so threads allocate and record without synchronizing with each other.
+// Pools of the frame are reset in bulk once the frame is finished, buffers are reused by the next frames
+class RHI_API CommandListAllocator
+{
+public:
+    CommandListAllocator(uint32_t queueFamily, uint32_t framesInFlight);
+    ~CommandListAllocator();
+
+    // Buffer is valid until the frame is finished, it can be used only by the calling thread
+    VkCommandBuffer     Allocate(uint32_t frameIndex);
+
+    // Must be called once the frame with the given index is finished on GPU and no lists are recorded
+    void                NextFrame(uint32_t frameIndex);
+
+private:
+    struct FramePool
+    {
+        VkCommandPool                   m_pool = nullptr;
+        eastl::vector<VkCommandBuffer>  m_buffers;
+        uint32_t                        m_used = 0;
+    };
+
+    using ThreadPools = eastl::vector<FramePool>;
+
+    ThreadPools&        CurrentThreadPools();
+
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadPools>>   m_threadPools;
+    uint32_t                                                            m_queueFamily = 0;
+    uint32_t                                                            m_framesInFlight = 1;
+    std::mutex                                                          m_mutex;
+};
+
+} // rhi::vulkan
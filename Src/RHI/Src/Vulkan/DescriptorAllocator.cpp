@@ -0,0 +1,256 @@
+#include "DescriptorAllocator.hpp"
+#include "VulkanDevice.hpp"
+#include <Core/Hash.hpp>
+#include <EASTL/fixed_vector.h>
+#include <iterator>
+
+namespace rhi::vulkan
+{
+
+namespace
+{
+
+constexpr uint32_t C_INITIAL_POOL_SIZE = 128;
+constexpr uint32_t C_MAX_POOL_SIZE = 4096;
+// Unreferenced sets are kept for a while, materials are often recreated with the same bindings
+constexpr uint32_t C_UNUSED_SET_LIFETIME = 120;
+
+struct PoolRatio
+{
+    VkDescriptorType    m_type;
+    float               m_ratio;
+};
+
+// Amount of descriptors of each type per set
+constexpr PoolRatio C_POOL_RATIOS[] =
+{
+    { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2.0f },
+    { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+    { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+    { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f },
+};
+
+} // unnamed
+
+DescriptorAllocator::DescriptorAllocator(uint32_t framesInFlight) : m_framesInFlight(framesInFlight), m_nextPoolSize(C_INITIAL_POOL_SIZE)
+{
+    RHI_ASSERT(m_framesInFlight > 0);
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+    for (auto pool : m_persistentPools)
+    {
+        vkDestroyDescriptorPool(VulkanDevice::s_ctx.m_device, pool, nullptr);
+    }
+}
+
+void DescriptorAllocator::SetKey::Add(const VkWriteDescriptorSet& write)
+{
+    Binding binding;
+    binding.m_binding = write.dstBinding;
+    binding.m_type = write.descriptorType;
+
+    if (write.pBufferInfo)
+    {
+        binding.m_buffer = write.pBufferInfo->buffer;
+        binding.m_offset = write.pBufferInfo->offset;
+        binding.m_range = write.pBufferInfo->range;
+    }
+
+    if (write.pImageInfo)
+    {
+        binding.m_imageView = write.pImageInfo->imageView;
+        binding.m_sampler = write.pImageInfo->sampler;
+        binding.m_imageLayout = write.pImageInfo->imageLayout;
+    }
+
+    core::hash::CombineHash(m_hash, binding.m_binding);
+    core::hash::CombineHash(m_hash, static_cast<uint32_t>(binding.m_type));
+    core::hash::CombineHash(m_hash, binding.m_buffer);
+    core::hash::CombineHash(m_hash, static_cast<uint64_t>(binding.m_offset));
+    core::hash::CombineHash(m_hash, static_cast<uint64_t>(binding.m_range));
+    core::hash::CombineHash(m_hash, binding.m_imageView);
+    core::hash::CombineHash(m_hash, binding.m_sampler);
+    core::hash::CombineHash(m_hash, static_cast<uint32_t>(binding.m_imageLayout));
+
+    m_bindings.push_back(binding);
+}
+
+VkDescriptorSet DescriptorAllocator::Acquire(const SetKey& key, const std::function<void(VkDescriptorSet set)>& write)
+{
+    std::unique_lock l(m_mutex);
+
+    if (const auto it = m_cache.find(key); it != m_cache.end())
+    {
+        const auto set = it->second;
+        auto& cached = m_sets[set];
+        cached.m_refs++;
+        cached.m_unusedFrames = 0;
+
+        // Reference is taken before waiting, so the set can't be freed meanwhile
+        m_writtenCondition.wait(l, [this, set]() { return m_sets.find(set)->second.m_written; });
+        return set;
+    }
+
+    CachedSet cached;
+    cached.m_key = key;
+    cached.m_refs = 1;
+
+    const auto set = AllocateFromChain(m_persistentPools, key.m_layout, &cached.m_pool);
+
+    m_sets[set] = cached;
+    m_cache[key] = set;
+
+    // Writes of the other sets don't block the allocator
+    l.unlock();
+    write(set);
+    l.lock();
+
+    m_sets.find(set)->second.m_written = true;
+    m_writtenCondition.notify_all();
+
+    return set;
+}
+
+void DescriptorAllocator::Release(VkDescriptorSet set)
+{
+    std::lock_guard l(m_mutex);
+
+    const auto it = m_sets.find(set);
+    RHI_ASSERT(it != m_sets.end() && it->second.m_refs > 0);
+
+    it->second.m_refs--;
+    it->second.m_unusedFrames = 0;
+}
+
+bool DescriptorAllocator::Cached(VkDescriptorSet set)
+{
+    std::lock_guard l(m_mutex);
+
+    const auto it = m_sets.find(set);
+    return it != m_sets.end() && it->second.m_cached;
+}
+
+void DescriptorAllocator::InvalidateBuffer(VkBuffer buffer)
+{
+    Invalidate([buffer](const Binding& binding) { return binding.m_buffer == buffer; });
+}
+
+void DescriptorAllocator::InvalidateImageViews(const eastl::vector<VkImageView>& views)
+{
+    Invalidate([&views](const Binding& binding)
+        {
+            return binding.m_imageView && eastl::find(views.begin(), views.end(), binding.m_imageView) != views.end();
+        });
+}
+
+void DescriptorAllocator::InvalidateSampler(VkSampler sampler)
+{
+    Invalidate([sampler](const Binding& binding) { return binding.m_sampler == sampler; });
+}
+
+template <typename F>
+void DescriptorAllocator::Invalidate(F&& references)
+{
+    std::lock_guard l(m_mutex);
+
+    for (auto& [set, cached] : m_sets)
+    {
+        if (!cached.m_cached || eastl::none_of(cached.m_key.m_bindings.begin(), cached.m_key.m_bindings.end(), references))
+        {
+            continue;
+        }
+
+        m_cache.erase(cached.m_key);
+        cached.m_cached = false;
+        cached.m_unusedFrames = 0;
+    }
+}
+
+void DescriptorAllocator::NextFrame()
+{
+    std::lock_guard l(m_mutex);
+
+    for (auto it = m_sets.begin(); it != m_sets.end();)
+    {
+        auto& cached = it->second;
+
+        // Invalidated set can't be acquired anymore, so it is kept only while the frames in flight may use it
+        const uint32_t lifetime = cached.m_cached ? eastl::max(C_UNUSED_SET_LIFETIME, m_framesInFlight) : m_framesInFlight;
+
+        if (cached.m_refs > 0 || ++cached.m_unusedFrames <= lifetime)
+        {
+            ++it;
+            continue;
+        }
+
+        if (cached.m_cached)
+        {
+            m_cache.erase(cached.m_key);
+        }
+
+        vkFreeDescriptorSets(VulkanDevice::s_ctx.m_device, cached.m_pool, 1, &it->first);
+        it = m_sets.erase(it);
+    }
+}
+
+VkDescriptorSet DescriptorAllocator::AllocateFromChain(eastl::vector<VkDescriptorPool>& pools, VkDescriptorSetLayout layout, VkDescriptorPool* usedPool)
+{
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet set = nullptr;
+
+    // The newest pool is the most likely to have free space
+    for (auto it = pools.rbegin(); it != pools.rend(); ++it)
+    {
+        allocInfo.descriptorPool = *it;
+        const auto result = vkAllocateDescriptorSets(VulkanDevice::s_ctx.m_device, &allocInfo, &set);
+
+        if (result == VK_SUCCESS)
+        {
+            *usedPool = *it;
+            return set;
+        }
+
+        RHI_ASSERT(result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL);
+    }
+
+    log::debug("[Vulkan] All descriptor pools are exhausted, allocating new one for {} sets", m_nextPoolSize);
+
+    pools.push_back(CreatePool(m_nextPoolSize));
+    m_nextPoolSize = eastl::min(m_nextPoolSize * 2, C_MAX_POOL_SIZE);
+
+    allocInfo.descriptorPool = pools.back();
+    RHI_ASSERT(vkAllocateDescriptorSets(VulkanDevice::s_ctx.m_device, &allocInfo, &set) == VK_SUCCESS);
+
+    *usedPool = pools.back();
+    return set;
+}
+
+VkDescriptorPool DescriptorAllocator::CreatePool(uint32_t maxSets)
+{
+    eastl::fixed_vector<VkDescriptorPoolSize, std::size(C_POOL_RATIOS), false> poolSizes;
+
+    for (const auto& ratio : C_POOL_RATIOS)
+    {
+        poolSizes.push_back({ ratio.m_type, static_cast<uint32_t>(ratio.m_ratio * maxSets) });
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = maxSets;
+
+    VkDescriptorPool pool = nullptr;
+    RHI_ASSERT(vkCreateDescriptorPool(VulkanDevice::s_ctx.m_device, &poolInfo, nullptr, &pool) == VK_SUCCESS);
+
+    return pool;
+}
+
+} // rhi::vulkan
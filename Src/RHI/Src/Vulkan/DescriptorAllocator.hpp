@@ -0,0 +1,111 @@
+#pragma once
+
+#include <RHI/Config.hpp>
+#include <vulkan/vulkan.h>
+#include <EASTL/vector.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/fixed_vector.h>
+#include <EASTL/algorithm.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace rhi::vulkan
+{
+
+// Descriptor sets allocator.
+// Persistent sets are allocated from a chain of pools, new pool is added once all previous ones are exhausted.
+// Persistent sets are cached by their layout and full list of bindings, so materials with identical bindings share the same set.
+// Cached sets which reference destroyed buffer, image view or sampler are dropped from the cache, as the driver may reuse the handle
+class RHI_API DescriptorAllocator
+{
+public:
+    struct Binding
+    {
+        uint32_t            m_binding = 0;
+        VkDescriptorType    m_type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+        VkBuffer            m_buffer = nullptr;
+        VkDeviceSize        m_offset = 0;
+        VkDeviceSize        m_range = 0;
+        VkImageView         m_imageView = nullptr;
+        VkSampler           m_sampler = nullptr;
+        VkImageLayout       m_imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        bool operator==(const Binding& other) const
+        {
+            return m_binding == other.m_binding && m_type == other.m_type
+                && m_buffer == other.m_buffer && m_offset == other.m_offset && m_range == other.m_range
+                && m_imageView == other.m_imageView && m_sampler == other.m_sampler && m_imageLayout == other.m_imageLayout;
+        }
+    };
+
+    struct SetKey
+    {
+        VkDescriptorSetLayout                   m_layout = nullptr;
+        eastl::fixed_vector<Binding, 8, true>   m_bindings;
+        // Hash of all bindings, it is only used for lookup
+        size_t                                  m_hash = 0;
+
+        void Add(const VkWriteDescriptorSet& write);
+
+        bool operator==(const SetKey& other) const
+        {
+            return m_hash == other.m_hash && m_layout == other.m_layout && m_bindings.size() == other.m_bindings.size()
+                && eastl::equal(m_bindings.begin(), m_bindings.end(), other.m_bindings.begin());
+        }
+    };
+
+    DescriptorAllocator(uint32_t framesInFlight);
+    ~DescriptorAllocator();
+
+    // Returns cached set for the key, if there is none the set is allocated and written with the given callback outside of the lock.
+    // Threads which acquire the set while it is written wait until the write is finished.
+    // Every acquired set must be released once it is not needed anymore, it is freed once unused by the frames in flight
+    VkDescriptorSet     Acquire(const SetKey& key, const std::function<void(VkDescriptorSet set)>& write);
+    void                Release(VkDescriptorSet set);
+    // False if the set was dropped from the cache because one of its bindings was destroyed
+    bool                Cached(VkDescriptorSet set);
+
+    // Must be called before the object is destroyed
+    void                InvalidateBuffer(VkBuffer buffer);
+    void                InvalidateImageViews(const eastl::vector<VkImageView>& views);
+    void                InvalidateSampler(VkSampler sampler);
+
+    // Must be called once per frame after GPU finished the oldest frame in flight
+    void                NextFrame();
+
+private:
+    struct SetKeyHash
+    {
+        size_t operator()(const SetKey& key) const { return key.m_hash ^ eastl::hash<VkDescriptorSetLayout>{}(key.m_layout); }
+    };
+
+    struct CachedSet
+    {
+        SetKey              m_key;
+        VkDescriptorPool    m_pool = nullptr;
+        uint32_t            m_refs = 0;
+        // Frames passed since the last reference was released
+        uint32_t            m_unusedFrames = 0;
+        // Set is visible to the other threads only once it is written
+        bool                m_written = false;
+        // Invalidated sets stay alive until they are released and not used by the frames in flight
+        bool                m_cached = true;
+    };
+
+    template <typename F>
+    void                Invalidate(F&& references);
+
+    VkDescriptorSet     AllocateFromChain(eastl::vector<VkDescriptorPool>& pools, VkDescriptorSetLayout layout, VkDescriptorPool* usedPool);
+    VkDescriptorPool    CreatePool(uint32_t maxSets);
+
+    eastl::unordered_map<SetKey, VkDescriptorSet, SetKeyHash>   m_cache;
+    eastl::unordered_map<VkDescriptorSet, CachedSet>            m_sets;
+    eastl::vector<VkDescriptorPool>                             m_persistentPools;
+    uint32_t                                                    m_framesInFlight = 1;
+    uint32_t                                                    m_nextPoolSize;
+    std::mutex                                                  m_mutex;
+    std::condition_variable                                     m_writtenCondition;
+};
+
+} // rhi::vulkan
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <RHI/Handle.hpp>
+#include <RHI/Assert.hpp>
+#include <EASTL/array.h>
+#include <EASTL/vector.h>
+#include <memory>
+#include <mutex>
+
+namespace rhi::vulkan
+{
+
+// Dense table of raw Vulkan objects addressed by generational handles.
+// Slots are stored in fixed chunks which never move, so the render thread resolves handles without locks and atomics
+// while the other threads create objects. Handle must reach the resolving thread through a synchronized channel, e.g. render thread queue
+template <typename T, typename Entry>
+class HandlePool
+{
+public:
+    Handle<T> Allocate(const Entry& entry)
+    {
+        std::lock_guard l(m_mutex);
+
+        uint32_t index = 0;
+
+        if (!m_freeIndices.empty())
+        {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        }
+        else
+        {
+            RHI_ASSERT(m_size <= Handle<T>::C_MAX_INDEX);
+            index = m_size++;
+
+            auto& chunk = m_chunks[index >> C_CHUNK_SHIFT];
+
+            if (!chunk)
+            {
+                chunk = std::make_unique<Chunk>();
+            }
+        }
+
+        auto& slot = GetSlot(index);
+        slot.m_entry = entry;
+        return Handle<T>(index, slot.m_generation);
+    }
+
+    void Free(Handle<T> handle)
+    {
+        std::lock_guard l(m_mutex);
+
+        auto& slot = GetSlot(handle.Index());
+        RHI_ASSERT(slot.m_generation == handle.Generation());
+
+        slot.m_generation = Handle<T>::NextGeneration(slot.m_generation);
+        slot.m_entry = {};
+        m_freeIndices.push_back(handle.Index());
+    }
+
+    // Entry can be changed only by the owner of the object, e.g. when descriptor set of the material is replaced
+    Entry& Get(Handle<T> handle)
+    {
+        auto& slot = GetSlot(handle.Index());
+        RHI_ASSERT(handle.Valid() && slot.m_generation == handle.Generation());
+        return slot.m_entry;
+    }
+
+    const Entry& Get(Handle<T> handle) const
+    {
+        return const_cast<HandlePool*>(this)->Get(handle);
+    }
+
+private:
+    static constexpr uint32_t C_CHUNK_SHIFT = 10;
+    static constexpr uint32_t C_CHUNK_SIZE = 1u << C_CHUNK_SHIFT;
+
+    struct Slot
+    {
+        Entry       m_entry;
+        uint32_t    m_generation = 1;
+    };
+
+    using Chunk = eastl::array<Slot, C_CHUNK_SIZE>;
+
+    Slot& GetSlot(uint32_t index) const
+    {
+        return (*m_chunks[index >> C_CHUNK_SHIFT])[index & (C_CHUNK_SIZE - 1)];
+    }
+
+    eastl::array<std::unique_ptr<Chunk>, (Handle<T>::C_MAX_INDEX >> C_CHUNK_SHIFT) + 1>    m_chunks;
+    eastl::vector<uint32_t>                                                                 m_freeIndices;
+    uint32_t                                                                                m_size = 0;
+    std::mutex                                                                              m_mutex;
+};
+
+} // rhi::vulkan
@@ -60,10 +60,13 @@ VulkanImguiProvider::~VulkanImguiProvider()
 void VulkanImguiProvider::Begin()
 {
     RHI_ASSERT(core::IsRenderThread());
+
+    // The first frame uploads fonts through the graphics queue, resources may be created on the other threads meanwhile
+    std::lock_guard l(VulkanDevice::s_ctx.m_instance->QueueMutex());
     ImGui_ImplVulkan_NewFrame();
 }
 
-void VulkanImguiProvider::End()
+void VulkanImguiProvider::End(ImDrawData* drawData)
 {
     RHI_ASSERT(core::IsRenderThread());
     auto renderPass = std::static_pointer_cast<VulkanRenderPass>(m_renderPass);
@@ -83,23 +86,21 @@ void VulkanImguiProvider::End()
 
     auto cmdBuffer = VulkanDevice::s_ctx.m_instance->CurrentCmdBuffer();
 
+    eastl::vector<TextureBarrier> barriers;
+
     for (auto &texture : renderPass->Descriptor().m_colorAttachments) 
     {
-        auto vkTexture = std::static_pointer_cast<VulkanTexture>(texture.m_texture);
-        vkTexture->ChangeImageLayout(cmdBuffer, vkTexture->Layout(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        barriers.push_back({ texture.m_texture, TextureLayout::COLOR_ATTACHMENT });
     }
 
+    // Attachments are expected to be transitioned by the caller already, just like in VulkanDevice::BeginPipeline
+    VulkanDevice::s_ctx.m_instance->Barrier(barriers);
+
     vkCmdBeginRendering(cmdBuffer, &renderingInfo);
 
-    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmdBuffer);
+    ImGui_ImplVulkan_RenderDrawData(drawData, cmdBuffer);
 
     vkCmdEndRendering(cmdBuffer);
-
-    for (auto &texture : renderPass->Descriptor().m_colorAttachments) 
-    {
-        auto vkTexture = std::static_pointer_cast<VulkanTexture>(texture.m_texture);
-        vkTexture->ChangeImageLayout(cmdBuffer, vkTexture->Layout(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    }
 }
 
 ImTextureID VulkanImguiProvider::Image(const std::shared_ptr<Texture>& texture, const ImVec2& size,
@@ -150,6 +151,8 @@ VkDescriptorSet VulkanImguiProvider::GetDescriptorSet(const std::shared_ptr<Text
     const auto vkTexture = std::static_pointer_cast<VulkanTexture>(texture);
     const auto vkSampler = std::static_pointer_cast<VulkanSampler>(vkTexture->GetSampler());
 
+    VulkanDevice::s_ctx.m_instance->GetUploadManager().Require(*vkTexture);
+
     if (m_imageViewToDescSet.find(vkTexture->ImageView(0)) == m_imageViewToDescSet.end())
     {
         m_imageViewToDescSet[vkTexture->ImageView(0)] = ImGui_ImplVulkan_AddTexture(vkSampler->Raw(),
@@ -0,0 +1,204 @@
+#include "PipelineCache.hpp"
+#include "VulkanDevice.hpp"
+#include <fstream>
+#include <cstring>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr uint32_t C_CACHE_MAGIC = 0x43505452; // RTPC
+// Must be bumped on every change of file header layout
+constexpr uint32_t C_CACHE_VERSION = 1;
+
+// Written before the driver data. Driver validates its own header too, but it doesn't include driver version,
+// so data written by the other driver build is dropped here instead of relying on the driver to reject it
+struct FileHeader
+{
+    uint32_t    m_magic = C_CACHE_MAGIC;
+    uint32_t    m_version = C_CACHE_VERSION;
+    uint32_t    m_vendorId = 0;
+    uint32_t    m_deviceId = 0;
+    uint32_t    m_driverVersion = 0;
+    uint8_t     m_pipelineCacheUUID[VK_UUID_SIZE] = {};
+    uint8_t     m_driverUUID[VK_UUID_SIZE] = {};
+    uint64_t    m_dataSize = 0;
+};
+
+FileHeader CurrentDeviceHeader()
+{
+    VkPhysicalDeviceIDProperties idProps{};
+    idProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 props{};
+    props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    props.pNext = &idProps;
+
+    vkGetPhysicalDeviceProperties2(rhi::vulkan::VulkanDevice::s_ctx.m_physicalDevice, &props);
+
+    FileHeader header;
+    header.m_vendorId = props.properties.vendorID;
+    header.m_deviceId = props.properties.deviceID;
+    header.m_driverVersion = props.properties.driverVersion;
+    std::memcpy(header.m_pipelineCacheUUID, props.properties.pipelineCacheUUID, VK_UUID_SIZE);
+    std::memcpy(header.m_driverUUID, idProps.driverUUID, VK_UUID_SIZE);
+
+    return header;
+}
+
+bool ValidDriverData(const FileHeader& header, const eastl::vector<uint8_t>& data)
+{
+    VkPipelineCacheHeaderVersionOne driverHeader{};
+
+    if (data.size() < sizeof(driverHeader))
+    {
+        return false;
+    }
+
+    std::memcpy(&driverHeader, data.data(), sizeof(driverHeader));
+
+    return driverHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        && driverHeader.vendorID == header.m_vendorId
+        && driverHeader.deviceID == header.m_deviceId
+        && std::memcmp(driverHeader.pipelineCacheUUID, header.m_pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+// Returns empty data if file doesn't exist or was written by the other device or driver
+eastl::vector<uint8_t> LoadCacheData(const fs::path& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+    {
+        return {};
+    }
+
+    FileHeader header;
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    const auto current = CurrentDeviceHeader();
+
+    if (!stream
+        || header.m_magic != current.m_magic
+        || header.m_version != current.m_version
+        || header.m_vendorId != current.m_vendorId
+        || header.m_deviceId != current.m_deviceId
+        || header.m_driverVersion != current.m_driverVersion
+        || std::memcmp(header.m_pipelineCacheUUID, current.m_pipelineCacheUUID, VK_UUID_SIZE) != 0
+        || std::memcmp(header.m_driverUUID, current.m_driverUUID, VK_UUID_SIZE) != 0)
+    {
+        rhi::log::info("[PipelineCache] Cache '{}' was written by the other device or driver, it is ignored", path.generic_u8string());
+        return {};
+    }
+
+    // Size is read from the file, so it is checked before anything is allocated. Data must fill the rest of the file exactly
+    std::error_code ec;
+    const uint64_t fileSize = fs::file_size(path, ec);
+
+    if (ec || fileSize < sizeof(header) || header.m_dataSize != fileSize - sizeof(header))
+    {
+        rhi::log::warning("[PipelineCache] Cache '{}' is corrupted", path.generic_u8string());
+        return {};
+    }
+
+    eastl::vector<uint8_t> data(static_cast<size_t>(header.m_dataSize));
+    stream.read(reinterpret_cast<char*>(data.data()), data.size());
+
+    if (!stream || !ValidDriverData(current, data))
+    {
+        rhi::log::warning("[PipelineCache] Cache '{}' is corrupted", path.generic_u8string());
+        return {};
+    }
+
+    return data;
+}
+
+} // unnamed
+
+namespace rhi::vulkan
+{
+
+PipelineCache::PipelineCache(std::string_view path) : m_path(path)
+{
+    eastl::vector<uint8_t> data;
+
+    if (!m_path.empty())
+    {
+        data = LoadCacheData(m_path);
+    }
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    RHI_ASSERT(vkCreatePipelineCache(VulkanDevice::s_ctx.m_device, &createInfo, nullptr, &m_cache) == VK_SUCCESS);
+
+    m_warm = !data.empty();
+
+    if (m_warm)
+    {
+        rhi::log::info("[PipelineCache] Loaded {} bytes from '{}'", data.size(), m_path.generic_u8string());
+    }
+}
+
+PipelineCache::~PipelineCache()
+{
+    vkDestroyPipelineCache(VulkanDevice::s_ctx.m_device, m_cache, nullptr);
+}
+
+void PipelineCache::Save() const
+{
+    if (m_path.empty())
+    {
+        return;
+    }
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(VulkanDevice::s_ctx.m_device, m_cache, &size, nullptr) != VK_SUCCESS || size == 0)
+    {
+        return;
+    }
+
+    eastl::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(VulkanDevice::s_ctx.m_device, m_cache, &size, data.data()) != VK_SUCCESS)
+    {
+        rhi::log::warning("[PipelineCache] Can't get pipeline cache data");
+        return;
+    }
+
+    auto header = CurrentDeviceHeader();
+    header.m_dataSize = size;
+
+    std::error_code error;
+    fs::create_directories(m_path.parent_path(), error);
+
+    // Cache is written to the temporary file first, so the next launch never sees partially written cache
+    auto tmpPath = m_path;
+    tmpPath += ".tmp";
+
+    {
+        std::ofstream stream(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+        {
+            rhi::log::warning("[PipelineCache] Can't write cache '{}'", m_path.generic_u8string());
+            return;
+        }
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(data.data()), size);
+    }
+
+    fs::rename(tmpPath, m_path, error);
+
+    if (error)
+    {
+        rhi::log::warning("[PipelineCache] Can't write cache '{}': {}", m_path.generic_u8string(), error.message());
+        fs::remove(tmpPath, error);
+        return;
+    }
+
+    rhi::log::info("[PipelineCache] Saved {} bytes to '{}'", size, m_path.generic_u8string());
+}
+
+} // rhi::vulkan
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <RHI/Config.hpp>
+#include <vulkan/vulkan.h>
+#include <filesystem>
+
+namespace rhi::vulkan
+{
+
+// Driver pipeline cache which is persisted between launches.
+// Saved data is used only if it was written by the same device and driver, otherwise cache starts empty
+class RHI_API PipelineCache
+{
+public:
+    // Cache is kept only in memory if path is empty
+    PipelineCache(std::string_view path);
+    ~PipelineCache();
+
+    VkPipelineCache Handle() const { return m_cache; }
+    // True if cache was loaded from disk
+    bool            Warm() const { return m_warm; }
+
+    void            Save() const;
+
+private:
+    std::filesystem::path   m_path;
+    VkPipelineCache         m_cache = nullptr;
+    bool                    m_warm = false;
+};
+
+} // rhi::vulkan
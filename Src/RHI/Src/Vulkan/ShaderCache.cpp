@@ -0,0 +1,374 @@
+#include "ShaderCache.hpp"
+#include <fstream>
+#include <thread>
+#include <cstring>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr uint32_t C_CACHE_MAGIC = 0x48535452; // RTSH
+// Must be bumped on every change of entry layout
+constexpr uint32_t C_CACHE_VERSION = 2;
+constexpr std::string_view C_CACHE_EXTENSION = ".shcache";
+
+class Writer
+{
+public:
+    template<typename T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(T));
+    }
+
+    void Write(const std::string& str)
+    {
+        Write(static_cast<uint32_t>(str.size()));
+        WriteBytes(str.data(), str.size());
+    }
+
+    void WriteBytes(const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        m_data.insert(m_data.end(), bytes, bytes + size);
+    }
+
+    const eastl::vector<uint8_t>& Data() const { return m_data; }
+
+private:
+    eastl::vector<uint8_t> m_data;
+};
+
+class Reader
+{
+public:
+    Reader(const eastl::vector<uint8_t>& data) : m_data(data)
+    {}
+
+    template<typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        ReadBytes(&value, sizeof(T));
+        return value;
+    }
+
+    std::string ReadString()
+    {
+        const auto size = Read<uint32_t>();
+        if (!Check(size))
+        {
+            return {};
+        }
+        std::string str(reinterpret_cast<const char*>(m_data.data() + m_offset), size);
+        m_offset += size;
+        return str;
+    }
+
+    void ReadBytes(void* data, size_t size)
+    {
+        if (!Check(size))
+        {
+            return;
+        }
+        std::memcpy(data, m_data.data() + m_offset, size);
+        m_offset += size;
+    }
+
+    const uint8_t* Current() const { return m_data.data() + m_offset; }
+
+    // Returns false and invalidates reader if there is not enough data left
+    bool Check(size_t size)
+    {
+        if (!m_valid || m_offset + size > m_data.size())
+        {
+            m_valid = false;
+            return false;
+        }
+        return true;
+    }
+
+    void Skip(size_t size)
+    {
+        if (Check(size))
+        {
+            m_offset += size;
+        }
+    }
+
+    bool Valid() const { return m_valid; }
+
+private:
+    const eastl::vector<uint8_t>&   m_data;
+    size_t                          m_offset = 0;
+    bool                            m_valid = true;
+};
+
+void WriteBufferInfo(Writer& writer, const rhi::ShaderReflection::BufferInfo& info)
+{
+    writer.Write(info.m_name);
+    writer.Write(info.m_size);
+    writer.Write(info.m_type);
+    writer.Write(info.m_stage);
+}
+
+rhi::ShaderReflection::BufferInfo ReadBufferInfo(Reader& reader)
+{
+    rhi::ShaderReflection::BufferInfo info;
+    info.m_name = reader.ReadString();
+    info.m_size = reader.Read<uint32_t>();
+    info.m_type = reader.Read<rhi::BufferType>();
+    info.m_stage = reader.Read<rhi::ShaderStage>();
+    return info;
+}
+
+void WriteBufferMap(Writer& writer, const rhi::ShaderReflection::BufferMap& map)
+{
+    writer.Write(static_cast<uint32_t>(map.size()));
+    for (const auto& [slot, info] : map)
+    {
+        writer.Write(slot);
+        WriteBufferInfo(writer, info);
+    }
+}
+
+void ReadBufferMap(Reader& reader, rhi::ShaderReflection::BufferMap& map)
+{
+    const auto count = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < count && reader.Valid(); i++)
+    {
+        const auto slot = reader.Read<uint8_t>();
+        map[slot] = ReadBufferInfo(reader);
+    }
+}
+
+void WriteTextureList(Writer& writer, const rhi::ShaderReflection::TextureList& list)
+{
+    writer.Write(static_cast<uint32_t>(list.size()));
+    for (const auto& texture : list)
+    {
+        writer.Write(texture.m_name);
+        writer.Write(texture.m_slot);
+        writer.Write(texture.m_isCubemap);
+    }
+}
+
+void ReadTextureList(Reader& reader, rhi::ShaderReflection::TextureList& list)
+{
+    const auto count = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < count && reader.Valid(); i++)
+    {
+        rhi::ShaderReflection::TextureInfo texture;
+        texture.m_name = reader.ReadString();
+        texture.m_slot = reader.Read<uint8_t>();
+        texture.m_isCubemap = reader.Read<bool>();
+        list.emplace(std::move(texture));
+    }
+}
+
+void WriteInputLayout(Writer& writer, const rhi::VertexBufferLayout& layout)
+{
+    writer.Write(static_cast<uint32_t>(layout.Elements().size()));
+    for (const auto& element : layout.Elements())
+    {
+        writer.Write(element.m_name);
+        writer.Write(element.m_type);
+        writer.Write(element.m_count);
+        writer.Write(element.m_normalized);
+    }
+}
+
+// Layout is rebuilt through the same pushes as in the shader reflection, so stride is recalculated
+bool ReadInputLayout(Reader& reader, rhi::VertexBufferLayout& layout)
+{
+    const auto count = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < count && reader.Valid(); i++)
+    {
+        const auto name = reader.ReadString();
+        const auto format = reader.Read<rhi::Format>();
+        const auto elementCount = reader.Read<uint32_t>();
+        const auto normalized = reader.Read<bool>();
+
+        switch (format)
+        {
+            case rhi::Format::R32_SFLOAT: layout.Push<float>(name, elementCount, normalized); break;
+            case rhi::Format::RG32_SFLOAT: layout.Push<glm::vec2>(name, elementCount, normalized); break;
+            case rhi::Format::RGB32_SFLOAT: layout.Push<glm::vec3>(name, elementCount, normalized); break;
+            case rhi::Format::RGBA32_SFLOAT: layout.Push<glm::vec4>(name, elementCount, normalized); break;
+            case rhi::Format::R32_UINT: layout.Push<uint32_t>(name, elementCount, normalized); break;
+            case rhi::Format::R8_UINT: layout.Push<uint8_t>(name, elementCount, normalized); break;
+            default:
+                return false;
+        }
+    }
+    return reader.Valid();
+}
+
+} // unnamed
+
+namespace rhi::vulkan
+{
+
+ShaderCache::ShaderCache(std::string_view directory) : m_directory(directory)
+{
+    if (m_directory.empty())
+    {
+        return;
+    }
+
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+
+    if (error)
+    {
+        rhi::log::warning("[ShaderCache] Can't create cache directory '{}': {}, cache is disabled", m_directory.generic_u8string(), error.message());
+        m_directory.clear();
+    }
+}
+
+bool ShaderCache::Load(uint64_t key, CompiledShaderData& data) const
+{
+    if (!Enabled())
+    {
+        return false;
+    }
+
+    std::ifstream stream(EntryPath(key), std::ios::binary | std::ios::ate);
+    if (!stream.is_open())
+    {
+        return false;
+    }
+
+    eastl::vector<uint8_t> bytes(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+    if (!stream)
+    {
+        return false;
+    }
+
+    Reader reader(bytes);
+
+    if (reader.Read<uint32_t>() != C_CACHE_MAGIC || reader.Read<uint32_t>() != C_CACHE_VERSION || reader.Read<uint64_t>() != key)
+    {
+        return false;
+    }
+
+    CompiledShaderData result;
+
+    const auto stageCount = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < stageCount && reader.Valid(); i++)
+    {
+        const auto stage = reader.Read<ShaderStage>();
+        const auto size = reader.Read<uint32_t>();
+
+        if (!reader.Check(size))
+        {
+            break;
+        }
+
+        result.m_stageBlob[stage] = core::Blob(reader.Current(), size);
+        reader.Skip(size);
+    }
+
+    auto& reflection = result.m_reflection;
+    ReadBufferMap(reader, reflection.m_bufferMap);
+    ReadBufferMap(reader, reflection.m_storageBufferMap);
+    reflection.m_pushConstant = ReadBufferInfo(reader);
+    ReadTextureList(reader, reflection.m_textures);
+    ReadTextureList(reader, reflection.m_storageImages);
+    const bool validLayout = ReadInputLayout(reader, reflection.m_inputLayout);
+    reflection.m_outputAmount = reader.Read<uint8_t>();
+
+    const auto constantCount = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < constantCount && reader.Valid(); i++)
+    {
+        auto& constant = reflection.m_specializationConstants.emplace_back();
+        constant.m_name = reader.ReadString();
+        constant.m_id = reader.Read<uint32_t>();
+    }
+
+    if (!reader.Valid() || !validLayout || result.m_stageBlob.empty())
+    {
+        rhi::log::warning("[ShaderCache] Cache entry '{}' is corrupted", EntryPath(key).generic_u8string());
+        return false;
+    }
+
+    result.m_valid = true;
+    data = std::move(result);
+
+    return true;
+}
+
+void ShaderCache::Store(uint64_t key, const CompiledShaderData& data) const
+{
+    if (!Enabled() || !data.m_valid)
+    {
+        return;
+    }
+
+    Writer writer;
+    writer.Write(C_CACHE_MAGIC);
+    writer.Write(C_CACHE_VERSION);
+    writer.Write(key);
+
+    writer.Write(static_cast<uint32_t>(data.m_stageBlob.size()));
+    for (const auto& [stage, blob] : data.m_stageBlob)
+    {
+        writer.Write(stage);
+        writer.Write(static_cast<uint32_t>(blob.size()));
+        writer.WriteBytes(blob.raw(), blob.size());
+    }
+
+    const auto& reflection = data.m_reflection;
+    WriteBufferMap(writer, reflection.m_bufferMap);
+    WriteBufferMap(writer, reflection.m_storageBufferMap);
+    WriteBufferInfo(writer, reflection.m_pushConstant);
+    WriteTextureList(writer, reflection.m_textures);
+    WriteTextureList(writer, reflection.m_storageImages);
+    WriteInputLayout(writer, reflection.m_inputLayout);
+    writer.Write(reflection.m_outputAmount);
+
+    writer.Write(static_cast<uint32_t>(reflection.m_specializationConstants.size()));
+    for (const auto& constant : reflection.m_specializationConstants)
+    {
+        writer.Write(constant.m_name);
+        writer.Write(constant.m_id);
+    }
+
+    // Entry is written to the temporary file first, so reader never sees partially written entry
+    const auto path = EntryPath(key);
+    auto tmpPath = path;
+    tmpPath += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream stream(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+        {
+            rhi::log::warning("[ShaderCache] Can't write cache entry '{}'", path.generic_u8string());
+            return;
+        }
+        stream.write(reinterpret_cast<const char*>(writer.Data().data()), writer.Data().size());
+    }
+
+    std::error_code error;
+    fs::rename(tmpPath, path, error);
+
+    if (error)
+    {
+        rhi::log::warning("[ShaderCache] Can't write cache entry '{}': {}", path.generic_u8string(), error.message());
+        fs::remove(tmpPath, error);
+    }
+}
+
+fs::path ShaderCache::EntryPath(uint64_t key) const
+{
+    return m_directory / fmt::format("{:016x}{}", key, C_CACHE_EXTENSION);
+}
+
+} // rhi::vulkan
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <RHI/Config.hpp>
+#include <RHI/ShaderCompiler.hpp>
+#include <filesystem>
+
+namespace rhi::vulkan
+{
+
+// On-disk cache of compiled shaders.
+// Every entry keeps SPIR-V blobs of all stages together with the merged reflection,
+// entries are keyed by the hash of preprocessed shader source and compiler options.
+class RHI_API ShaderCache
+{
+public:
+    // Cache is disabled if directory is empty
+    ShaderCache(std::string_view directory);
+
+    bool    Enabled() const { return !m_directory.empty(); }
+
+    // Returns false if there is no valid entry for the key
+    bool    Load(uint64_t key, CompiledShaderData& data) const;
+    void    Store(uint64_t key, const CompiledShaderData& data) const;
+
+private:
+    std::filesystem::path   EntryPath(uint64_t key) const;
+
+    std::filesystem::path   m_directory;
+};
+
+} // rhi::vulkan
@@ -1,6 +1,6 @@
 #include "Swapchain.hpp"
 #include "VulkanDevice.hpp"
-#include <vk-tools/VulkanTools.h>
+#include "BarrierBatcher.hpp"
 
 #undef max
 
@@ -143,14 +143,18 @@ Swapchain::Swapchain(const SwapchainDescriptor& desc) : m_descriptor(desc)
     srcSubRange.levelCount = 1;
     srcSubRange.layerCount = 1;
 
+    BarrierBatcher batcher;
+
     for (auto& image : m_images)
     {
-        vks::tools::setImageLayout(cmdBuffer.Raw(),
-            image,
+        batcher.Transition(image,
+            srcSubRange,
             VK_IMAGE_LAYOUT_UNDEFINED,
             VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-            srcSubRange);
+            VK_PIPELINE_STAGE_2_NONE,
+            VK_PIPELINE_STAGE_2_NONE);
     }
+    batcher.Flush(cmdBuffer.Raw());
     cmdBuffer.End();
 
     VulkanDevice::s_ctx.m_instance->Execute(cmdBuffer)->Wait();
@@ -0,0 +1,397 @@
+#include "UploadManager.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanTexture.hpp"
+#include <Core/String.hpp>
+#include <Core/Profiling.hpp>
+#include <EASTL/algorithm.h>
+#include <numeric>
+
+namespace rhi::vulkan
+{
+
+namespace
+{
+
+constexpr uint64_t C_STAGING_RING_SIZE = 64 * 1024 * 1024;
+constexpr uint64_t C_BUFFER_COPY_ALIGNMENT = 16;
+
+} // unnamed
+
+UploadManager::UploadManager(uint32_t queueFamily, VkQueue queue, std::mutex& queueMutex) :
+    m_queue(queue),
+    m_queueMutex(queueMutex),
+    m_ringSize(C_STAGING_RING_SIZE)
+{
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    RHI_ASSERT(vkCreateCommandPool(VulkanDevice::s_ctx.m_device, &poolInfo, nullptr, &m_commandPool) == VK_SUCCESS);
+
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    RHI_ASSERT(vkCreateSemaphore(VulkanDevice::s_ctx.m_device, &semaphoreInfo, nullptr, &m_semaphore) == VK_SUCCESS);
+
+    BufferDescriptor ringDesc{};
+    ringDesc.m_name = "Staging ring";
+    ringDesc.m_size = static_cast<uint32_t>(m_ringSize);
+    ringDesc.m_type = BufferType::TRANSFER_SRC;
+    ringDesc.m_memoryType = MemoryType::CPU_ONLY;
+
+    m_ring = std::make_shared<VulkanBuffer>(ringDesc, nullptr);
+    m_ringData = static_cast<uint8_t*>(m_ring->Map());
+    RHI_ASSERT(m_ringData);
+}
+
+UploadManager::~UploadManager()
+{
+    // Nobody is able to use queued textures anymore
+    m_pending.clear();
+
+    Flush();
+    Wait(m_submittedValue);
+    Retire(false);
+
+    vkDestroySemaphore(VulkanDevice::s_ctx.m_device, m_semaphore, nullptr);
+    vkDestroyCommandPool(VulkanDevice::s_ctx.m_device, m_commandPool, nullptr);
+}
+
+void UploadManager::Upload(const std::shared_ptr<VulkanBuffer>& buffer, const void* data, uint64_t size, uint64_t offset)
+{
+    RHI_ASSERT(buffer && data);
+    RHI_ASSERT(offset + size <= buffer->Descriptor().m_size);
+
+    std::lock_guard lock(m_mutex);
+
+    // Buffer may be already in use and updated in parts, so the copy can't be moved to the later frames.
+    // It still consumes the budget, so textures uploaded in the same frame are queued
+    m_frameBytes += size;
+
+    const auto allocation = Allocate(size, C_BUFFER_COPY_ALIGNMENT);
+    memcpy(allocation.m_data, data, size);
+
+    VkBufferCopy region{};
+    region.srcOffset = allocation.m_offset;
+    region.dstOffset = offset;
+    region.size = size;
+
+    vkCmdCopyBuffer(CmdBuffer(), allocation.m_buffer, buffer->Raw(), 1, &region);
+
+    m_batch.m_resources.emplace_back(buffer);
+}
+
+void UploadManager::Upload(const std::shared_ptr<VulkanTexture>& texture, const void* data)
+{
+    RHI_ASSERT(texture);
+
+    std::lock_guard lock(m_mutex);
+
+    // Texture was just created and isn't used yet, so its data can arrive in one of the next frames
+    if (data && !FitsBudget(texture->Descriptor().Size()))
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+
+        auto& upload = m_pending.emplace_back();
+        upload.m_texture = texture;
+        upload.m_data.assign(bytes, bytes + texture->Descriptor().Size());
+        texture->m_uploadPending.store(true, std::memory_order_release);
+        return;
+    }
+
+    RecordUpload(texture, data);
+}
+
+void UploadManager::Require(const VulkanTexture& texture)
+{
+    if (!texture.UploadPending())
+    {
+        return;
+    }
+
+    PROFILER_CPU_ZONE;
+
+    std::lock_guard lock(m_mutex);
+
+    const auto it = eastl::find_if(m_pending.begin(), m_pending.end(), [&texture](const PendingUpload& upload)
+    {
+        return upload.m_texture.get() == &texture;
+    });
+
+    // Upload could be recorded by the other thread meanwhile
+    if (it == m_pending.end())
+    {
+        return;
+    }
+
+    RecordPending(*it);
+    m_pending.erase(it);
+}
+
+void UploadManager::RecordUpload(const std::shared_ptr<VulkanTexture>& texture, const void* data)
+{
+    const auto& desc = texture->Descriptor();
+
+    // Staging memory is allocated before recording, allocation may submit the current batch
+    Allocation allocation{};
+    if (data)
+    {
+        const auto size = desc.Size();
+        m_frameBytes += size;
+
+        // Copy offset must be a multiple of both texel size and 4
+        allocation = Allocate(size, std::lcm<uint64_t>(4, desc.PixelSize()));
+        memcpy(allocation.m_data, data, size);
+    }
+
+    const auto cmdBuffer = CmdBuffer();
+
+    VkImageSubresourceRange range{};
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.baseMipLevel = 0;
+    range.levelCount = texture->MipLevels();
+    range.baseArrayLayer = 0;
+    range.layerCount = desc.m_layersAmount;
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = texture->Image();
+    barrier.subresourceRange = range;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    if (data)
+    {
+        VkBufferImageCopy region{};
+        region.bufferOffset = allocation.m_offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = { desc.m_width, desc.m_height, 1 };
+
+        vkCmdCopyBufferToImage(cmdBuffer, allocation.m_buffer, texture->Image(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+
+    // Visibility for the consumers is guaranteed by the timeline semaphore wait on the graphics queue
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    m_batch.m_resources.emplace_back(texture);
+}
+
+uint64_t UploadManager::Flush()
+{
+    std::lock_guard lock(m_mutex);
+    return FlushLocked();
+}
+
+void UploadManager::NextFrame()
+{
+    std::lock_guard lock(m_mutex);
+    m_frameBytes = 0;
+    Retire(false);
+
+    while (!m_pending.empty() && FitsBudget(m_pending.front().m_data.size()))
+    {
+        auto& upload = m_pending.front();
+
+        // Texture was destroyed while waiting, queue owns the last reference
+        if (upload.m_texture.use_count() > 1)
+        {
+            RecordPending(upload);
+        }
+
+        m_pending.pop_front();
+    }
+}
+
+void UploadManager::Wait(uint64_t value) const
+{
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_semaphore;
+    waitInfo.pValues = &value;
+
+    RHI_ASSERT(vkWaitSemaphores(VulkanDevice::s_ctx.m_device, &waitInfo, UINT64_MAX) == VK_SUCCESS);
+}
+
+UploadManager::Allocation UploadManager::Allocate(uint64_t size, uint64_t alignment)
+{
+    // Oversized uploads get their own staging buffer which lives until the batch is finished
+    if (size > m_ringSize / 2)
+    {
+        log::warning("[Vulkan] Upload of {} doesn't fit into staging ring, allocating dedicated staging buffer", core::string::BytesToHumanReadable(size));
+
+        BufferDescriptor desc{};
+        desc.m_name = "Staging buffer";
+        desc.m_size = static_cast<uint32_t>(size);
+        desc.m_type = BufferType::TRANSFER_SRC;
+        desc.m_memoryType = MemoryType::CPU_ONLY;
+
+        auto buffer = std::make_shared<VulkanBuffer>(desc, nullptr);
+        Allocation allocation{ buffer->Raw(), 0, buffer->Map() };
+        m_batch.m_resources.emplace_back(std::move(buffer));
+        return allocation;
+    }
+
+    uint64_t head = m_ringHead;
+    uint64_t offset = head % m_ringSize;
+    uint64_t alignedOffset = (offset + alignment - 1) / alignment * alignment;
+
+    // Allocations never wrap around the end of the ring
+    if (alignedOffset + size > m_ringSize)
+    {
+        head += m_ringSize - offset;
+        offset = 0;
+        alignedOffset = 0;
+    }
+
+    const uint64_t newHead = head + (alignedOffset - offset) + size;
+
+    while (newHead - m_ringTail > m_ringSize)
+    {
+        PROFILER_CPU_ZONE_NAME("Wait for staging memory");
+
+        if (m_inFlight.empty())
+        {
+            // Everything is occupied by the batch that is being recorded
+            FlushLocked();
+        }
+        Retire(true);
+    }
+
+    m_ringHead = newHead;
+
+    return { m_ring->Raw(), alignedOffset, m_ringData + alignedOffset };
+}
+
+VkCommandBuffer UploadManager::CmdBuffer()
+{
+    if (m_batch.m_cmdBuffer)
+    {
+        return m_batch.m_cmdBuffer;
+    }
+
+    if (!m_freeCmdBuffers.empty())
+    {
+        m_batch.m_cmdBuffer = m_freeCmdBuffers.back();
+        m_freeCmdBuffers.pop_back();
+        RHI_ASSERT(vkResetCommandBuffer(m_batch.m_cmdBuffer, 0) == VK_SUCCESS);
+    }
+    else
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = m_commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        RHI_ASSERT(vkAllocateCommandBuffers(VulkanDevice::s_ctx.m_device, &allocInfo, &m_batch.m_cmdBuffer) == VK_SUCCESS);
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    RHI_ASSERT(vkBeginCommandBuffer(m_batch.m_cmdBuffer, &beginInfo) == VK_SUCCESS);
+
+    return m_batch.m_cmdBuffer;
+}
+
+uint64_t UploadManager::FlushLocked()
+{
+    if (!m_batch.m_cmdBuffer)
+    {
+        return m_submittedValue;
+    }
+
+    PROFILER_CPU_ZONE;
+
+    RHI_ASSERT(vkEndCommandBuffer(m_batch.m_cmdBuffer) == VK_SUCCESS);
+
+    const uint64_t signalValue = m_submittedValue + 1;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &m_batch.m_cmdBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_semaphore;
+
+    {
+        std::lock_guard l(m_queueMutex);
+        RHI_ASSERT(vkQueueSubmit(m_queue, 1, &submitInfo, nullptr) == VK_SUCCESS);
+    }
+
+    m_submittedValue = signalValue;
+    m_batch.m_value = signalValue;
+    m_batch.m_ringHead = m_ringHead;
+    m_inFlight.push_back(std::move(m_batch));
+    m_batch = {};
+
+    return m_submittedValue;
+}
+
+void UploadManager::Retire(bool wait)
+{
+    if (m_inFlight.empty())
+    {
+        return;
+    }
+
+    if (wait)
+    {
+        Wait(m_inFlight.front().m_value);
+    }
+
+    uint64_t completedValue = 0;
+    RHI_ASSERT(vkGetSemaphoreCounterValue(VulkanDevice::s_ctx.m_device, m_semaphore, &completedValue) == VK_SUCCESS);
+
+    while (!m_inFlight.empty() && m_inFlight.front().m_value <= completedValue)
+    {
+        auto& batch = m_inFlight.front();
+        m_ringTail = batch.m_ringHead;
+        m_freeCmdBuffers.push_back(batch.m_cmdBuffer);
+        m_inFlight.pop_front();
+    }
+}
+
+void UploadManager::RecordPending(PendingUpload& upload)
+{
+    RecordUpload(upload.m_texture, upload.m_data.data());
+    upload.m_texture->m_uploadPending.store(false, std::memory_order_release);
+}
+
+bool UploadManager::FitsBudget(uint64_t size) const
+{
+    const uint64_t budget = VulkanDevice::s_ctx.m_instance->m_parameters.m_uploadBudget;
+
+    // Upload which is bigger than the whole budget is recorded alone in its frame
+    return budget == 0 || m_frameBytes == 0 || m_frameBytes + size <= budget;
+}
+
+} // rhi::vulkan
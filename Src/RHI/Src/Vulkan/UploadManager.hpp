@@ -0,0 +1,95 @@
+#pragma once
+
+#include <RHI/Config.hpp>
+#include <vulkan/vulkan.h>
+#include <EASTL/deque.h>
+#include <mutex>
+
+namespace rhi::vulkan
+{
+
+class VulkanBuffer;
+class VulkanTexture;
+
+// Records staging copies of buffers and textures into a single batch which is submitted once per frame.
+// Staging memory is suballocated from a persistently mapped ring, batches completion is tracked with a timeline semaphore.
+// Uses dedicated transfer queue if device has one.
+// Texture uploads past the per frame budget are queued and recorded in the later frames, buffer uploads are always recorded
+// right away, since buffers may be updated in parts and are in use while being updated.
+class RHI_API UploadManager
+{
+public:
+    // Queue mutex is shared with the other submissions to the device queues
+    UploadManager(uint32_t queueFamily, VkQueue queue, std::mutex& queueMutex);
+    ~UploadManager();
+
+    void        Upload(const std::shared_ptr<VulkanBuffer>& buffer, const void* data, uint64_t size, uint64_t offset);
+    // Data can be nullptr, in that case only image layout is initialized
+    void        Upload(const std::shared_ptr<VulkanTexture>& texture, const void* data);
+
+    // Records queued upload of the texture into the current batch regardless of the budget, so GPU work submitted
+    // after the call sees the data. Must be called before the texture is bound or transitioned
+    void        Require(const VulkanTexture& texture);
+
+    // Submits recorded copies. Returns timeline value which will be signaled once copies are finished
+    uint64_t    Flush();
+
+    // Resets per frame budget, records queued texture uploads which fit into it and releases staging memory of finished batches
+    void        NextFrame();
+
+    void        Wait(uint64_t value) const;
+
+    VkSemaphore Semaphore() const { return m_semaphore; }
+    uint64_t    SubmittedValue() const { return m_submittedValue; }
+
+private:
+    struct Batch
+    {
+        VkCommandBuffer                         m_cmdBuffer = nullptr;
+        uint64_t                                m_value = 0;
+        // Ring head position after this batch, everything before it can be reused once batch is finished
+        uint64_t                                m_ringHead = 0;
+        // Keeps destination and oversized staging resources alive until copies are finished
+        eastl::vector<std::shared_ptr<void>>    m_resources;
+    };
+
+    struct PendingUpload
+    {
+        std::shared_ptr<VulkanTexture>  m_texture;
+        eastl::vector<uint8_t>          m_data;
+    };
+
+    struct Allocation
+    {
+        VkBuffer    m_buffer = nullptr;
+        uint64_t    m_offset = 0;
+        void*       m_data = nullptr;
+    };
+
+    Allocation          Allocate(uint64_t size, uint64_t alignment);
+    VkCommandBuffer     CmdBuffer();
+    uint64_t            FlushLocked();
+    void                Retire(bool wait);
+    void                RecordUpload(const std::shared_ptr<VulkanTexture>& texture, const void* data);
+    void                RecordPending(PendingUpload& upload);
+    bool                FitsBudget(uint64_t size) const;
+
+    VkQueue                         m_queue = nullptr;
+    std::mutex&                     m_queueMutex;
+    VkCommandPool                   m_commandPool = nullptr;
+    VkSemaphore                     m_semaphore = nullptr;
+    std::shared_ptr<VulkanBuffer>   m_ring;
+    uint8_t*                        m_ringData = nullptr;
+    uint64_t                        m_ringSize = 0;
+    uint64_t                        m_ringHead = 0;
+    uint64_t                        m_ringTail = 0;
+    uint64_t                        m_submittedValue = 0;
+    uint64_t                        m_frameBytes = 0;
+    Batch                           m_batch;
+    eastl::deque<Batch>             m_inFlight;
+    eastl::deque<PendingUpload>     m_pending;
+    eastl::vector<VkCommandBuffer>  m_freeCmdBuffers;
+    mutable std::mutex              m_mutex;
+};
+
+} // rhi::vulkan
@@ -26,25 +26,48 @@ VulkanBuffer::VulkanBuffer(const BufferDescriptor& desc, const void* data) : Buf
         bufferInfo.usage = helpers::BufferUsage(desc.m_type);
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+        // Device local buffers are filled by the upload manager, possibly from the transfer queue
+        if (desc.m_memoryType == MemoryType::GPU_ONLY)
+        {
+            bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+            const auto& queueFamilies = VulkanDevice::s_ctx.m_instance->ConcurrentQueueFamilies();
+            if (queueFamilies.size() > 1)
+            {
+                bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+                bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+                bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+            }
+        }
+
         VmaAllocationCreateInfo vmaAllocInfo = {};
         vmaAllocInfo.usage = helpers::MemoryUsage(desc.m_memoryType);
 
+        if (desc.m_memoryType != MemoryType::GPU_ONLY)
+        {
+            vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        }
+
+        VmaAllocationInfo allocationInfo{};
+
         const auto result = vmaCreateBuffer(VulkanDevice::s_ctx.m_allocator, 
             &bufferInfo, 
             &vmaAllocInfo,
             &m_buffer,
             &m_allocation,
-            nullptr);
+            &allocationInfo);
 
         if (result != VK_SUCCESS)
         {
             log::error("[Vulkan] Failed to allocate buffer '{}' with the size of {}", desc.m_name, core::string::BytesToHumanReadable(desc.m_size));
             return;
         }
+        m_mappedData = allocationInfo.pMappedData;
+        m_handle = VulkanDevice::s_ctx.m_instance->Pools().m_buffers.Allocate({ m_buffer });
         log::debug("[Vulkan] Successfully allocated buffer '{}' with the size of {}", desc.m_name, core::string::BytesToHumanReadable(desc.m_size));
     }
 
-    if (data)
+    if (data && desc.m_memoryType != MemoryType::GPU_ONLY)
     {
         void* bufferPtr = Map();
         memcpy(bufferPtr, data, desc.m_size);
@@ -61,7 +84,22 @@ VulkanBuffer::~VulkanBuffer()
     }
 
     log::debug("[Vulkan] Successfully deallocated buffer '{}' with the size of {}", m_descriptor.m_name, core::string::BytesToHumanReadable(m_descriptor.m_size));
-    vmaDestroyBuffer(VulkanDevice::s_ctx.m_allocator, m_buffer, m_allocation);
+
+    // Buffer may still be used by the frames in flight
+    VulkanDevice::DeferDestruction([buffer = m_buffer, allocation = m_allocation, handle = m_handle]
+    {
+        if (auto* device = VulkanDevice::s_ctx.m_instance)
+        {
+            // Cached sets must not outlive the buffer, new buffer may get the same handle
+            device->GetDescriptorAllocator().InvalidateBuffer(buffer);
+
+            if (handle.Valid())
+            {
+                device->Pools().m_buffers.Free(handle);
+            }
+        }
+        vmaDestroyBuffer(VulkanDevice::s_ctx.m_allocator, buffer, allocation);
+    });
 }
 
 void* VulkanBuffer::Map() const
@@ -75,6 +113,10 @@ void* VulkanBuffer::Map() const
         }
         return m_bufferData;
     }
+    if (m_mappedData)
+    {
+        return m_mappedData;
+    }
     void* data;
     vmaMapMemory(VulkanDevice::s_ctx.m_allocator, m_allocation, &data);
     return data;
@@ -82,7 +124,7 @@ void* VulkanBuffer::Map() const
 
 void VulkanBuffer::UnMap() const
 {
-    if (m_descriptor.m_type == BufferType::CONSTANT)
+    if (m_descriptor.m_type == BufferType::CONSTANT || m_mappedData)
     {
         return;
     }
@@ -21,6 +21,8 @@ namespace rhi::vulkan
     private:
         VkBuffer            m_buffer = nullptr;
         VmaAllocation        m_allocation = nullptr;
+        // Host visible buffers are mapped once for the whole lifetime
+        void*               m_mappedData = nullptr;
 
         // Is used only for constant buffer
         mutable uint8_t*    m_bufferData = nullptr;
@@ -0,0 +1,180 @@
+#include "VulkanCommandList.hpp"
+#include "VulkanRenderPass.hpp"
+#include "VulkanPipeline.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanGPUMaterial.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanHelpers.hpp"
+
+namespace rhi::vulkan
+{
+
+VulkanCommandList::VulkanCommandList(VkCommandBuffer cmdBuffer, const VulkanRenderPass& pass) : m_cmdBuffer(cmdBuffer), m_pools(VulkanDevice::s_ctx.m_instance->Pools())
+{
+    const auto& colorFormats = pass.ColorFormats();
+
+    VkCommandBufferInheritanceRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorFormats.size());
+    renderingInfo.pColorAttachmentFormats = colorFormats.data();
+    renderingInfo.depthAttachmentFormat = pass.DepthFormat();
+    renderingInfo.stencilAttachmentFormat = pass.DepthFormat();
+    renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = &renderingInfo;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    RHI_ASSERT(vkBeginCommandBuffer(m_cmdBuffer, &beginInfo) == VK_SUCCESS);
+
+    // Dynamic states aren't inherited from the primary command buffer
+    const auto& extent = pass.Descriptor().m_extent;
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(extent.x);
+    viewport.height = static_cast<float>(extent.y);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    const VkRect2D scissor = helpers::Rect(extent);
+
+    vkCmdSetViewport(m_cmdBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(m_cmdBuffer, 0, 1, &scissor);
+}
+
+void VulkanCommandList::BindPipeline(const std::shared_ptr<Pipeline>& pipeline)
+{
+    RHI_ASSERT(!m_ended);
+    RHI_ASSERT(!pipeline->Descriptor().m_compute);
+
+    vkCmdBindPipeline(m_cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, static_cast<const VulkanPipeline&>(*pipeline).GetPipeline());
+}
+
+void VulkanCommandList::BindVertexBuffer(const std::shared_ptr<Buffer>& buffer)
+{
+    RHI_ASSERT(!m_ended);
+    RHI_ASSERT(buffer->Descriptor().m_type == BufferType::VERTEX);
+
+    VkBuffer vertexBuffers[] = { static_cast<const VulkanBuffer&>(*buffer).Raw() };
+    VkDeviceSize offsets[] = { 0 };
+
+    vkCmdBindVertexBuffers(m_cmdBuffer, 0, 1, vertexBuffers, offsets);
+}
+
+void VulkanCommandList::BindIndexBuffer(const std::shared_ptr<Buffer>& buffer)
+{
+    RHI_ASSERT(!m_ended);
+    RHI_ASSERT(buffer->Descriptor().m_type == BufferType::INDEX);
+
+    vkCmdBindIndexBuffer(m_cmdBuffer, static_cast<const VulkanBuffer&>(*buffer).Raw(), 0, VK_INDEX_TYPE_UINT32);
+}
+
+void VulkanCommandList::BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const DynamicOffsets& offsets)
+{
+    RHI_ASSERT(!m_ended);
+
+    const auto descSet = static_cast<const VulkanGPUMaterial&>(*material).DescriptorSet();
+
+    vkCmdBindDescriptorSets(m_cmdBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        static_cast<const VulkanPipeline&>(*pipeline).Layout(),
+        0, 1,
+        &descSet,
+        static_cast<uint32_t>(offsets.size()), offsets.data());
+}
+
+void VulkanCommandList::PushConstant(const void* data, uint32_t size, const std::shared_ptr<Pipeline>& pipeline)
+{
+    RHI_ASSERT(!m_ended);
+
+    vkCmdPushConstants(m_cmdBuffer,
+        static_cast<const VulkanPipeline&>(*pipeline).Layout(),
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        size,
+        data);
+}
+
+void VulkanCommandList::BindPipeline(PipelineHandle pipeline)
+{
+    RHI_ASSERT(!m_ended);
+
+    const auto& entry = m_pools.m_pipelines.Get(pipeline);
+    RHI_ASSERT(entry.m_bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+    vkCmdBindPipeline(m_cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, entry.m_pipeline);
+}
+
+void VulkanCommandList::BindVertexBuffer(BufferHandle buffer)
+{
+    RHI_ASSERT(!m_ended);
+
+    VkBuffer vertexBuffers[] = { m_pools.m_buffers.Get(buffer).m_buffer };
+    VkDeviceSize offsets[] = { 0 };
+
+    vkCmdBindVertexBuffers(m_cmdBuffer, 0, 1, vertexBuffers, offsets);
+}
+
+void VulkanCommandList::BindIndexBuffer(BufferHandle buffer)
+{
+    RHI_ASSERT(!m_ended);
+
+    vkCmdBindIndexBuffer(m_cmdBuffer, m_pools.m_buffers.Get(buffer).m_buffer, 0, VK_INDEX_TYPE_UINT32);
+}
+
+void VulkanCommandList::BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const DynamicOffsets& offsets)
+{
+    RHI_ASSERT(!m_ended);
+
+    const auto descSet = m_pools.m_materials.Get(material).m_descriptorSet;
+
+    vkCmdBindDescriptorSets(m_cmdBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        m_pools.m_pipelines.Get(pipeline).m_layout,
+        0, 1,
+        &descSet,
+        static_cast<uint32_t>(offsets.size()), offsets.data());
+}
+
+void VulkanCommandList::PushConstant(const void* data, uint32_t size, PipelineHandle pipeline)
+{
+    RHI_ASSERT(!m_ended);
+
+    vkCmdPushConstants(m_cmdBuffer,
+        m_pools.m_pipelines.Get(pipeline).m_layout,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        size,
+        data);
+}
+
+void VulkanCommandList::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+    RHI_ASSERT(!m_ended);
+
+    vkCmdDraw(m_cmdBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+void VulkanCommandList::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+    RHI_ASSERT(!m_ended);
+
+    vkCmdDrawIndexed(m_cmdBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+}
+
+void VulkanCommandList::End()
+{
+    RHI_ASSERT(!m_ended);
+
+    RHI_ASSERT(vkEndCommandBuffer(m_cmdBuffer) == VK_SUCCESS);
+    m_ended = true;
+}
+
+} // rhi::vulkan
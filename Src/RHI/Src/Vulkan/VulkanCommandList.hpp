@@ -0,0 +1,42 @@
+#pragma once
+
+#include <RHI/CommandList.hpp>
+#include <vulkan/vulkan.h>
+
+namespace rhi::vulkan
+{
+
+class VulkanRenderPass;
+struct ResourcePools;
+
+// Command list recorded into the secondary command buffer which continues dynamic rendering of the pass
+class RHI_API VulkanCommandList : public CommandList
+{
+public:
+    VulkanCommandList(VkCommandBuffer cmdBuffer, const VulkanRenderPass& pass);
+
+    virtual void    BindPipeline(const std::shared_ptr<Pipeline>& pipeline) override;
+    virtual void    BindVertexBuffer(const std::shared_ptr<Buffer>& buffer) override;
+    virtual void    BindIndexBuffer(const std::shared_ptr<Buffer>& buffer) override;
+    virtual void    BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const DynamicOffsets& offsets = {}) override;
+    virtual void    PushConstant(const void* data, uint32_t size, const std::shared_ptr<Pipeline>& pipeline) override;
+    virtual void    BindPipeline(PipelineHandle pipeline) override;
+    virtual void    BindVertexBuffer(BufferHandle buffer) override;
+    virtual void    BindIndexBuffer(BufferHandle buffer) override;
+    virtual void    BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const DynamicOffsets& offsets = {}) override;
+    virtual void    PushConstant(const void* data, uint32_t size, PipelineHandle pipeline) override;
+    virtual void    Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override;
+    virtual void    DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) override;
+
+    virtual void    End() override;
+
+    VkCommandBuffer Raw() const { return m_cmdBuffer; }
+    bool            Ended() const { return m_ended; }
+
+private:
+    VkCommandBuffer m_cmdBuffer = nullptr;
+    ResourcePools&  m_pools;
+    bool            m_ended = false;
+};
+
+} // rhi::vulkan
@@ -2,6 +2,7 @@
 
 #include <Rhi/ComputeState.hpp>
 #include <Vulkan/CommandBuffer.hpp>
+#include <Vulkan/BarrierBatcher.hpp>
 
 namespace rhi::vulkan
 {
@@ -13,7 +14,8 @@ struct RHI_API VulkanComputeState : public ComputeState
         m_cmdBuffer.Begin();
     }
 
-    CommandBuffer m_cmdBuffer;
+    CommandBuffer   m_cmdBuffer;
+    BarrierBatcher  m_barriers;
 };
 
 } // rhi::vulkan
\ No newline at end of file
@@ -9,9 +9,12 @@
 #include "VulkanHelpers.hpp"
 #include "VulkanGPUMaterial.hpp"
 #include "VulkanComputeState.hpp"
+#include "VulkanCommandList.hpp"
 #include <Core/Profiling.hpp>
-#include <vk-tools/VulkanTools.h>
 #include <optional>
+#include <chrono>
+#include <algorithm>
+#include <limits>
 
 namespace rhi::vulkan
 {
@@ -19,15 +22,34 @@ namespace rhi::vulkan
 namespace
 {
 
-const eastl::array<const char*, 2> C_DEVICE_EXTENSIONS =
+const eastl::array<const char*, 3> C_DEVICE_EXTENSIONS =
 {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+    VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
 #ifdef R_APPLE
         "VK_KHR_portability_subset",
 #endif
 };
 
+// Returns pool of the thread to the device when the thread exits
+struct ThreadCommandPoolOwner
+{
+    VulkanDevice*   m_device = nullptr;
+    VkCommandPool   m_pool = nullptr;
+
+    ~ThreadCommandPoolOwner()
+    {
+        // Device could be destroyed before the thread, then the pool is already gone
+        if (m_pool && m_device == VulkanDevice::s_ctx.m_instance)
+        {
+            m_device->ReleaseThreadCommandPool(m_pool);
+        }
+    }
+};
+
+thread_local ThreadCommandPoolOwner t_commandPoolOwner;
+
 bool CheckDeviceExtensionSupport(VkPhysicalDevice device)
 {
     uint32_t extensionCount;
@@ -97,6 +119,20 @@ QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surfa
         i++;
     }
 
+    i = 0;
+    for (const auto& queueFamily : queueFamilies)
+    {
+        if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT)
+            && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            && !(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT))
+        {
+            indices.transferFamily = i;
+            break;
+        }
+
+        i++;
+    }
+
     return indices;
 }
 
@@ -154,10 +190,12 @@ bool IsDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface)
 
 } // namespace unnamed
 
-VulkanDevice::VulkanDevice(const std::shared_ptr<VulkanContext>& context)
+VulkanDevice::VulkanDevice(const std::shared_ptr<VulkanContext>& context, const Options& options)
 {
     s_ctx.m_instance = this;
     m_context = context;
+    m_parameters.m_framesInFlight = std::clamp<uint8_t>(options.m_framesInFlight, 1, C_MAX_FRAMES_IN_FLIGHT);
+    m_frameBeginTime = std::chrono::steady_clock::now();
 
     PickPhysicalDevice(context);
     CreateLogicalDevice(context);
@@ -166,7 +204,22 @@ VulkanDevice::VulkanDevice(const std::shared_ptr<VulkanContext>& context)
     SetupAllocator(context);
     SetupCommandPool(context);
 
+    const auto indices = FindQueueFamilies();
+    if (indices.transferFamily.has_value())
+    {
+        m_uploadManager = std::make_unique<UploadManager>(indices.transferFamily.value(), m_transferQueue, m_queueMutex);
+    }
+    else
+    {
+        m_uploadManager = std::make_unique<UploadManager>(indices.graphicsFamily.value(), m_graphicsQueue, m_queueMutex);
+    }
+
+    m_descriptorAllocator = std::make_unique<DescriptorAllocator>(s_ctx.m_instance->m_parameters.m_framesInFlight);
+    m_pipelineCache = std::make_unique<PipelineCache>(options.m_pipelineCachePath);
+    m_commandListAllocator = std::make_unique<CommandListAllocator>(indices.graphicsFamily.value(), s_ctx.m_instance->m_parameters.m_framesInFlight);
+
     m_cmdBuffers.resize(s_ctx.m_instance->m_parameters.m_framesInFlight);
+    m_barrierBatchers.resize(s_ctx.m_instance->m_parameters.m_framesInFlight);
     m_computeCmdBuffers.resize(s_ctx.m_instance->m_parameters.m_framesInFlight);
     m_fences.resize(s_ctx.m_instance->m_parameters.m_framesInFlight);
     m_computeFences.resize(s_ctx.m_instance->m_parameters.m_framesInFlight);
@@ -200,10 +253,22 @@ VulkanDevice::VulkanDevice(const std::shared_ptr<VulkanContext>& context)
 
 VulkanDevice::~VulkanDevice()
 {
-    vkDeviceWaitIdle(s_ctx.m_device);
-    VulkanGPUMaterial::Destroy();
+    {
+        std::lock_guard l(m_queueMutex);
+        vkDeviceWaitIdle(s_ctx.m_device);
+    }
+
+    m_uploadManager.reset();
+    m_commandListAllocator.reset();
     m_swapchain.reset();
 
+    const auto pipelineStats = GetPipelineStats();
+    rhi::log::info("[VulkanDevice] Created {} pipelines with {} cache in {:.2f}ms", pipelineStats.m_createdPipelines,
+        pipelineStats.m_warmCache ? "warm" : "cold", pipelineStats.m_creationTimeMs);
+
+    m_pipelineCache->Save();
+    m_pipelineCache.reset();
+
     for (uint32_t i = 0; i < s_ctx.m_instance->m_parameters.m_framesInFlight; i++)
     {
         vkDestroyFence(s_ctx.m_device, m_fences[i], nullptr);
@@ -211,28 +276,39 @@ VulkanDevice::~VulkanDevice()
         vkDestroySemaphore(s_ctx.m_device, m_renderSemaphores[i], nullptr);
     }
 
+    FlushAllDestructions();
+    // Deferred destructions drop cached sets of the destroyed objects
+    m_descriptorAllocator.reset();
+
     vkDestroyCommandPool(s_ctx.m_device, m_commandPool, nullptr);
+
+    // Threads which outlive the device won't release their pools
+    for (auto pool : m_threadCommandPools)
+    {
+        vkDestroyCommandPool(s_ctx.m_device, pool, nullptr);
+    }
+
     vmaDestroyAllocator(s_ctx.m_allocator);
     vkDestroyDevice(s_ctx.m_device, nullptr);
+    s_ctx.m_instance = nullptr;
 }
 
 std::shared_ptr<ShaderCompiler> VulkanDevice::CreateShaderCompiler(const ShaderCompiler::Options& options)
 {
-    static bool created = false;
-
-    RHI_ASSERT_WITH_MESSAGE(!created, "Currently engine supports only one instance of shader compiler!");
-
-    if (!created)
-    {
-        created = true;
-    }
     return std::make_shared<VulkanShaderCompiler>(options);
 }
 
 std::shared_ptr<Buffer> VulkanDevice::CreateBuffer(const BufferDescriptor& desc, const void* data)
 {
     RHI_ASSERT(!desc.m_name.empty());
-    return std::make_shared<VulkanBuffer>(desc, data);
+    auto buffer = std::make_shared<VulkanBuffer>(desc, data);
+
+    if (data && desc.m_memoryType == MemoryType::GPU_ONLY)
+    {
+        m_uploadManager->Upload(buffer, data, desc.m_size, 0);
+    }
+
+    return buffer;
 }
 
 std::shared_ptr<Shader> VulkanDevice::CreateShader(const ShaderDescriptor& desc)
@@ -247,7 +323,28 @@ std::shared_ptr<Sampler> VulkanDevice::CreateSampler(const SamplerDescriptor& de
 
 std::shared_ptr<Texture> VulkanDevice::CreateTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const void* data)
 {
-    return std::make_shared<VulkanTexture>(desc, sampler, data);
+    auto texture = std::make_shared<VulkanTexture>(desc, sampler);
+
+    if (!texture->IsDepth())
+    {
+        m_uploadManager->Upload(texture, data);
+    }
+
+    return texture;
+}
+
+std::shared_ptr<Texture> VulkanDevice::CreateAliasedTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler,
+    const std::shared_ptr<Texture>& memory)
+{
+    // Nothing is uploaded, memory can be still in use by the other texture
+    auto texture = std::make_shared<VulkanTexture>(desc, sampler, std::static_pointer_cast<VulkanTexture>(memory));
+
+    if (!texture->Image())
+    {
+        return nullptr;
+    }
+
+    return texture;
 }
 
 std::shared_ptr<RenderPass> VulkanDevice::CreateRenderPass(const RenderPassDescriptor& desc)
@@ -257,7 +354,14 @@ std::shared_ptr<RenderPass> VulkanDevice::CreateRenderPass(const RenderPassDescr
 
 std::shared_ptr<Pipeline> VulkanDevice::CreatePipeline(const PipelineDescriptor& desc)
 {
-    return std::make_shared<VulkanPipeline>(desc);
+    const auto start = std::chrono::steady_clock::now();
+
+    auto pipeline = std::make_shared<VulkanPipeline>(desc);
+
+    m_pipelineCreationTimeUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    m_createdPipelines++;
+
+    return pipeline;
 }
 
 std::shared_ptr<GPUMaterial> VulkanDevice::CreateGPUMaterial(const std::shared_ptr<Shader>& shader)
@@ -266,13 +370,34 @@ std::shared_ptr<GPUMaterial> VulkanDevice::CreateGPUMaterial(const std::shared_p
     return std::make_shared<VulkanGPUMaterial>(vkShader);
 }
 
+void VulkanDevice::UpdateBuffer(const std::shared_ptr<Buffer>& buffer, const void* data, uint32_t size, uint32_t offset)
+{
+    RHI_ASSERT(buffer && data);
+    RHI_ASSERT(offset + size <= buffer->Descriptor().m_size);
+
+    if (buffer->Descriptor().m_memoryType == MemoryType::GPU_ONLY)
+    {
+        m_uploadManager->Upload(std::static_pointer_cast<VulkanBuffer>(buffer), data, size, offset);
+        return;
+    }
+
+    auto* dst = static_cast<uint8_t*>(buffer->Map());
+    memcpy(dst + offset, data, size);
+    buffer->UnMap();
+}
+
 void VulkanDevice::BeginFrame()
 {
     PROFILER_CPU_ZONE;
 
     if (m_isSwapchainDirty)
     {
-        vkDeviceWaitIdle(s_ctx.m_device);
+        {
+            std::lock_guard l(m_queueMutex);
+            vkDeviceWaitIdle(s_ctx.m_device);
+        }
+
+        FlushAllDestructions();
         m_swapchain.reset();
         m_context->RecreateSurface();
         FillSwapchainSupportDetails(m_context);
@@ -291,6 +416,38 @@ void VulkanDevice::BeginFrame()
     m_frameIndex += 1;
     m_currentCmdBufferIndex = m_frameIndex % m_cmdBuffers.size();
 
+    {
+        // Objects released from now on may be used by the new frame
+        std::lock_guard l(m_destructionMutex);
+        m_destructionFrame = m_frameIndex;
+    }
+
+    // Resources of the slot are reused only after GPU is done with the frame which used them last time.
+    // It is the only place CPU waits for GPU, so with several frames in flight the wait is usually zero
+    {
+        PROFILER_CPU_ZONE_NAME("Wait for frame slot");
+
+        const auto waitStart = std::chrono::steady_clock::now();
+        RHI_ASSERT(vkWaitForFences(s_ctx.m_device, 1, &m_fences[m_currentCmdBufferIndex], VK_TRUE, UINT64_MAX) == VK_SUCCESS);
+        const auto now = std::chrono::steady_clock::now();
+
+        m_gpuWaitMs = std::chrono::duration<float, std::milli>(now - waitStart).count();
+        m_frameTimeMs = std::chrono::duration<float, std::milli>(now - m_frameBeginTime).count();
+        m_frameBeginTime = now;
+
+        PROFILER_PLOT("GPU wait, ms", static_cast<double>(m_gpuWaitMs));
+    }
+
+    // Fence of the slot signals that the frame which used it last time and all frames before it are finished
+    if (m_frameIndex >= m_cmdBuffers.size())
+    {
+        FlushDestructions(m_frameIndex - m_cmdBuffers.size());
+    }
+
+    m_uploadManager->NextFrame();
+    m_descriptorAllocator->NextFrame();
+    m_commandListAllocator->NextFrame(m_currentCmdBufferIndex);
+
     auto& cmdBuffer = m_cmdBuffers[m_currentCmdBufferIndex];
     RHI_ASSERT(vkResetCommandBuffer(cmdBuffer, 0) == VK_SUCCESS);
     VkCommandBufferBeginInfo beginInfo{};
@@ -307,21 +464,46 @@ void VulkanDevice::EndFrame()
     PROFILER_CPU_ZONE;
 
     auto& cmdBuffer = m_cmdBuffers[m_currentCmdBufferIndex];
+
+    auto& batcher = m_barrierBatchers[m_currentCmdBufferIndex];
+    RHI_ASSERT(batcher.Empty());
+
+    const auto& barrierStats = batcher.GetStats();
+    m_frameBarriers = barrierStats.m_barriers;
+    m_frameImageBarriers = barrierStats.m_imageBarriers;
+    m_frameBufferBarriers = barrierStats.m_bufferBarriers;
+    PROFILER_PLOT("Barriers", static_cast<int64_t>(barrierStats.m_barriers));
+    PROFILER_PLOT("Image barriers", static_cast<int64_t>(barrierStats.m_imageBarriers));
+    batcher.ResetStats();
+
     RHI_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS);
 
-    VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // Frame must not start before all uploads recorded so far are finished
+    const uint64_t uploadValue = m_uploadManager->Flush();
+
+    const eastl::array<VkPipelineStageFlags, 2> waitStageMasks = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+    const eastl::array<VkSemaphore, 2> waitSemaphores = { m_presentSemaphores[m_currentCmdBufferIndex], m_uploadManager->Semaphore() };
+    const eastl::array<uint64_t, 2> waitValues = { 0, uploadValue };
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pWaitDstStageMask = &waitStageMask;
-    submitInfo.pWaitSemaphores = &m_presentSemaphores[m_currentCmdBufferIndex];
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.pWaitDstStageMask = waitStageMasks.data();
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
     submitInfo.pSignalSemaphores = &m_renderSemaphores[m_currentCmdBufferIndex];
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pCommandBuffers = &cmdBuffer;
     submitInfo.commandBufferCount = 1;
 
     RHI_ASSERT(vkResetFences(s_ctx.m_device, 1, &m_fences[m_currentCmdBufferIndex]) == VK_SUCCESS);
+
+    std::lock_guard l(m_queueMutex);
     RHI_ASSERT(vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_fences[m_currentCmdBufferIndex]) == VK_SUCCESS);
 }
 
@@ -331,12 +513,9 @@ void VulkanDevice::BeginComputePipeline(const std::shared_ptr<Pipeline>& pipelin
 
     auto& cmdBuffer = m_cmdBuffers[m_currentCmdBufferIndex];
 
-    for (const auto& texture : pipeline->Descriptor().m_computePass->m_storageTextures)
-    {
-        auto vkTexture = std::static_pointer_cast<VulkanTexture>(texture);
-        vkTexture->ChangeImageLayout(cmdBuffer, vkTexture->Layout(), VK_IMAGE_LAYOUT_GENERAL);
-        m_computeTexturesToReset.emplace_back(vkTexture);
-    }
+    TransitionStorageTextures(pipeline->Descriptor().m_computePass->m_storageTextures, VK_IMAGE_LAYOUT_GENERAL, CurrentBarrierBatcher());
+    CurrentBarrierBatcher().Flush(cmdBuffer);
+    m_computeTexturesToReset = pipeline->Descriptor().m_computePass->m_storageTextures;
 
     const auto vkPipeline = std::static_pointer_cast<VulkanPipeline>(pipeline);
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline->GetPipeline());
@@ -348,11 +527,8 @@ void VulkanDevice::EndComputePipeline(const std::shared_ptr<Pipeline>& pipeline)
 
     auto& cmdBuffer = m_cmdBuffers[m_currentCmdBufferIndex];
 
-    for (const auto& texture : m_computeTexturesToReset)
-    {
-        auto vkTexture = std::static_pointer_cast<VulkanTexture>(texture);
-        vkTexture->ChangeImageLayout(cmdBuffer, vkTexture->Layout(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    }
+    TransitionStorageTextures(m_computeTexturesToReset, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, CurrentBarrierBatcher());
+    CurrentBarrierBatcher().Flush(cmdBuffer);
     m_computeTexturesToReset.clear();
 }
 
@@ -364,12 +540,8 @@ std::shared_ptr<ComputeState> VulkanDevice::BeginComputePipelineImmediate(const
 
     const auto cmdBuffer = state->m_cmdBuffer.Raw();
 
-    for (const auto& texture : pipeline->Descriptor().m_computePass->m_storageTextures)
-    {
-        auto vkTexture = std::static_pointer_cast<VulkanTexture>(texture);
-        vkTexture->ChangeImageLayout(cmdBuffer, vkTexture->Layout(), VK_IMAGE_LAYOUT_GENERAL);
-        m_computeTexturesToReset.emplace_back(vkTexture);
-    }
+    TransitionStorageTextures(pipeline->Descriptor().m_computePass->m_storageTextures, VK_IMAGE_LAYOUT_GENERAL, state->m_barriers);
+    state->m_barriers.Flush(cmdBuffer);
 
     const auto vkPipeline = std::static_pointer_cast<VulkanPipeline>(pipeline);
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline->GetPipeline());
@@ -386,12 +558,9 @@ void VulkanDevice::EndComputePipeline(const std::shared_ptr<Pipeline>& pipeline,
     const auto vkState = std::static_pointer_cast<VulkanComputeState>(state);
     const auto cmdBuffer = vkState->m_cmdBuffer.Raw();
 
-    for (const auto& texture : m_computeTexturesToReset)
-    {
-        auto vkTexture = std::static_pointer_cast<VulkanTexture>(texture);
-        vkTexture->ChangeImageLayout(cmdBuffer, vkTexture->Layout(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    }
-    m_computeTexturesToReset.clear();
+    // Pass is the same as on begin, so storage textures are taken from the pipeline instead of the shared list
+    TransitionStorageTextures(pipeline->Descriptor().m_computePass->m_storageTextures, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, vkState->m_barriers);
+    vkState->m_barriers.Flush(cmdBuffer);
 
     vkState->m_cmdBuffer.End();
     Execute(vkState->m_cmdBuffer)->Wait();
@@ -420,7 +589,10 @@ void VulkanDevice::Present()
 
     presentInfo.pWaitSemaphores = &m_renderSemaphores[m_currentCmdBufferIndex];
     presentInfo.waitSemaphoreCount = 1;
-    result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
+    {
+        std::lock_guard l(m_queueMutex);
+        result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
+    }
 
     if (result != VK_SUCCESS)
     {
@@ -433,12 +605,43 @@ void VulkanDevice::Present()
             RHI_ASSERT(false);
         }
     }
+}
+
+void VulkanDevice::Barrier(const eastl::vector<TextureBarrier>& barriers)
+{
+    PROFILER_CPU_ZONE;
+
+    auto& batcher = CurrentBarrierBatcher();
+
+    for (const auto& barrier : barriers)
+    {
+        const auto texture = static_cast<VulkanTexture*>(barrier.m_texture.get());
+        m_uploadManager->Require(*texture);
+        batcher.Transition(*texture, helpers::ImageLayout(barrier.m_layout), barrier.m_discard);
+    }
 
-    const uint32_t nextFrameIndex = (m_frameIndex + 1) % s_ctx.m_instance->m_parameters.m_framesInFlight;
-    RHI_ASSERT(vkWaitForFences(s_ctx.m_device, 1, &m_fences[nextFrameIndex], VK_TRUE, UINT64_MAX) == VK_SUCCESS);
+    batcher.Flush(m_cmdBuffers[m_currentCmdBufferIndex]);
 }
 
-void VulkanDevice::BeginPipeline(const std::shared_ptr<Pipeline>& pipeline)
+void VulkanDevice::TransitionStorageTextures(const eastl::vector<StorageTexture>& textures, VkImageLayout layout, BarrierBatcher& batcher)
+{
+    for (const auto& storageTexture : textures)
+    {
+        auto& texture = static_cast<VulkanTexture&>(*storageTexture.m_texture);
+        m_uploadManager->Require(texture);
+
+        if (storageTexture.m_mipLevel)
+        {
+            batcher.Transition(texture, layout, false, *storageTexture.m_mipLevel, 1);
+        }
+        else
+        {
+            batcher.Transition(texture, layout);
+        }
+    }
+}
+
+void VulkanDevice::BeginPipeline(const std::shared_ptr<Pipeline>& pipeline, bool commandLists)
 {
     PROFILER_CPU_ZONE;
 
@@ -452,6 +655,13 @@ void VulkanDevice::BeginPipeline(const std::shared_ptr<Pipeline>& pipeline)
     renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
     renderingInfo.renderArea = helpers::Rect(renderpass->Descriptor().m_extent);
 
+    if (commandLists)
+    {
+        // Command lists continue rendering of the offscreen pass only, their formats are taken from the render pass attachments
+        RHI_ASSERT(pipeline->Descriptor().m_offscreen);
+        renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR;
+    }
+
     if (pipeline->Descriptor().m_offscreen)
     {
         renderingInfo.layerCount = 1;
@@ -464,13 +674,20 @@ void VulkanDevice::BeginPipeline(const std::shared_ptr<Pipeline>& pipeline)
             renderingInfo.pStencilAttachment = &renderpass->DepthAttachment();
         }
 
-        for (const auto& texture : renderpass->Descriptor().m_colorAttachments)
+        eastl::vector<TextureBarrier> barriers;
+
+        for (const auto& attachment : renderpass->Descriptor().m_colorAttachments)
         {
-            auto vkTexture = std::static_pointer_cast<VulkanTexture>(texture.m_texture);
-            vkTexture->ChangeImageLayout(cmdBuffer, vkTexture->Layout(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-            m_texturesToReset.emplace_back(vkTexture);
+            barriers.push_back({ attachment.m_texture, TextureLayout::COLOR_ATTACHMENT });
         }
 
+        if (renderpass->Descriptor().m_depthStencilAttachment.m_texture)
+        {
+            barriers.push_back({ renderpass->Descriptor().m_depthStencilAttachment.m_texture, TextureLayout::DEPTH_STENCIL_ATTACHMENT });
+        }
+
+        Barrier(barriers);
+
         vkCmdBeginRendering(cmdBuffer, &renderingInfo);
     }
     else
@@ -499,15 +716,24 @@ void VulkanDevice::BeginPipeline(const std::shared_ptr<Pipeline>& pipeline)
         srcSubRange.baseMipLevel = 0;
         srcSubRange.levelCount = 1;
 
-        vks::tools::setImageLayout(cmdBuffer,
-            m_swapchain->Image(m_swapchainImageIndex),
+        // Acquire semaphore is waited on the color output stage, so the transition is chained to it
+        CurrentBarrierBatcher().Transition(m_swapchain->Image(m_swapchainImageIndex),
+            srcSubRange,
             VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
             VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            srcSubRange);
+            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+        CurrentBarrierBatcher().Flush(cmdBuffer);
 
         vkCmdBeginRendering(cmdBuffer, &renderingInfo);
     }
 
+    // Pass contents are recorded only in command lists, they bind pipelines and set dynamic states themselves
+    if (commandLists)
+    {
+        return;
+    }
+
     const auto vkPipeline = std::static_pointer_cast<VulkanPipeline>(pipeline);
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vkPipeline->GetPipeline());
 
@@ -536,12 +762,6 @@ void VulkanDevice::EndPipeline(const std::shared_ptr<Pipeline>& pipeline)
     auto& cmdBuffer = m_cmdBuffers[m_currentCmdBufferIndex];
     vkCmdEndRendering(cmdBuffer);
 
-    for (auto& texture : m_texturesToReset)
-    {
-        texture->ChangeImageLayout(cmdBuffer, texture->Layout(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    }
-    m_texturesToReset.clear();
-
     if (!pipeline->Descriptor().m_offscreen)
     {
         VkImageSubresourceRange srcSubRange{};
@@ -550,46 +770,82 @@ void VulkanDevice::EndPipeline(const std::shared_ptr<Pipeline>& pipeline)
         srcSubRange.baseMipLevel = 0;
         srcSubRange.levelCount = 1;
 
-        vks::tools::setImageLayout(cmdBuffer,
-            m_swapchain->Image(m_swapchainImageIndex),
+        CurrentBarrierBatcher().Transition(m_swapchain->Image(m_swapchainImageIndex),
+            srcSubRange,
             VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-            srcSubRange);
+            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_2_NONE);
+        CurrentBarrierBatcher().Flush(cmdBuffer);
     }
 }
 
-void VulkanDevice::Draw(const std::shared_ptr<Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount)
+void VulkanDevice::BindPipeline(const std::shared_ptr<Pipeline>& pipeline)
+{
+    RHI_ASSERT(!pipeline->Descriptor().m_compute);
+
+    // Viewport and scissor are dynamic states, so ones set on pipeline begin are kept
+    auto& cmdBuffer = m_cmdBuffers[m_currentCmdBufferIndex];
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, static_cast<const VulkanPipeline&>(*pipeline).GetPipeline());
+}
+
+void VulkanDevice::Draw(const std::shared_ptr<Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance)
 {
     auto& cmdBuffer = m_cmdBuffers[m_currentCmdBufferIndex];
-    VkBuffer vertexBuffers[] = { std::static_pointer_cast<VulkanBuffer>(buffer)->Raw() };
+    VkBuffer vertexBuffers[] = { static_cast<const VulkanBuffer&>(*buffer).Raw() };
     VkDeviceSize offsets[] = { 0 };
 
     vkCmdBindVertexBuffers(cmdBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdDraw(cmdBuffer, vertexCount, instanceCount, 0, 0);
+    vkCmdDraw(cmdBuffer, vertexCount, instanceCount, 0, firstInstance);
 }
 
 void VulkanDevice::Draw(const std::shared_ptr<Buffer>& vb, const std::shared_ptr<Buffer>& ib, uint32_t indexCount,
-    uint32_t instanceCount)
+    uint32_t instanceCount, uint32_t firstInstance)
 {
     RHI_ASSERT(vb->Descriptor().m_type == BufferType::VERTEX);
     RHI_ASSERT(ib->Descriptor().m_type == BufferType::INDEX);
 
-    const auto vkVertexBuffer = std::static_pointer_cast<VulkanBuffer>(vb);
-    const auto vkIndexBuffer = std::static_pointer_cast<VulkanBuffer>(ib);
-    VkBuffer vertexBuffers[] = { vkVertexBuffer->Raw() };
+    VkBuffer vertexBuffers[] = { static_cast<const VulkanBuffer&>(*vb).Raw() };
     VkDeviceSize offsets[] = { 0 };
 
     auto& cmdBuffer = m_cmdBuffers[m_currentCmdBufferIndex];
 
     vkCmdBindVertexBuffers(cmdBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(cmdBuffer, vkIndexBuffer->Raw(), 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(cmdBuffer, static_cast<const VulkanBuffer&>(*ib).Raw(), 0, VK_INDEX_TYPE_UINT32);
 
     vkCmdDrawIndexed(cmdBuffer,
         indexCount,
         instanceCount,
         0,
         0,
-        0);
+        firstInstance);
+}
+
+void VulkanDevice::BindVertexBuffer(const std::shared_ptr<Buffer>& buffer)
+{
+    RHI_ASSERT(buffer->Descriptor().m_type == BufferType::VERTEX);
+
+    VkBuffer vertexBuffers[] = { static_cast<const VulkanBuffer&>(*buffer).Raw() };
+    VkDeviceSize offsets[] = { 0 };
+
+    vkCmdBindVertexBuffers(m_cmdBuffers[m_currentCmdBufferIndex], 0, 1, vertexBuffers, offsets);
+}
+
+void VulkanDevice::BindIndexBuffer(const std::shared_ptr<Buffer>& buffer)
+{
+    RHI_ASSERT(buffer->Descriptor().m_type == BufferType::INDEX);
+
+    vkCmdBindIndexBuffer(m_cmdBuffers[m_currentCmdBufferIndex], static_cast<const VulkanBuffer&>(*buffer).Raw(), 0, VK_INDEX_TYPE_UINT32);
+}
+
+void VulkanDevice::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+    vkCmdDraw(m_cmdBuffers[m_currentCmdBufferIndex], vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+void VulkanDevice::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+    vkCmdDrawIndexed(m_cmdBuffers[m_currentCmdBufferIndex], indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
 void VulkanDevice::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
@@ -608,34 +864,21 @@ void VulkanDevice::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t
     vkCmdDispatch(vkState->m_cmdBuffer.Raw(), groupCountX, groupCountY, groupCountZ);
 }
 
-void VulkanDevice::BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline)
+void VulkanDevice::BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const DynamicOffsets& offsets)
 {
-    const auto vkPipeline = std::static_pointer_cast<VulkanPipeline>(pipeline);
-    const auto vkMaterial = std::static_pointer_cast<VulkanGPUMaterial>(material);
-    const auto descSet = vkMaterial->DescriptorSet();
-
-    if (vkPipeline->Descriptor().m_compute)
-    {
-        vkCmdBindDescriptorSets(m_cmdBuffers[m_currentCmdBufferIndex],
-            VK_PIPELINE_BIND_POINT_COMPUTE,
-            vkPipeline->Layout(),
-            0, 1,
-            &descSet
-            , 0, nullptr);
-    }
-    else
-    {
-        vkCmdBindDescriptorSets(m_cmdBuffers[m_currentCmdBufferIndex],
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            vkPipeline->Layout(),
-            0, 1,
-            &descSet
-            , 0, nullptr);
-    }
+    const auto& vkPipeline = static_cast<const VulkanPipeline&>(*pipeline);
+    const auto descSet = static_cast<const VulkanGPUMaterial&>(*material).DescriptorSet();
+
+    vkCmdBindDescriptorSets(m_cmdBuffers[m_currentCmdBufferIndex],
+        vkPipeline.Descriptor().m_compute ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS,
+        vkPipeline.Layout(),
+        0, 1,
+        &descSet,
+        static_cast<uint32_t>(offsets.size()), offsets.data());
 }
 
 void VulkanDevice::BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material,
-    const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state)
+    const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state, const DynamicOffsets& offsets)
 {
     RHI_ASSERT(state);
 
@@ -650,8 +893,8 @@ void VulkanDevice::BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material,
             VK_PIPELINE_BIND_POINT_COMPUTE,
             vkPipeline->Layout(),
             0, 1,
-            &descSet
-            , 0, nullptr);
+            &descSet,
+            static_cast<uint32_t>(offsets.size()), offsets.data());
     }
     else
     {
@@ -662,13 +905,104 @@ void VulkanDevice::BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material,
 void VulkanDevice::PushConstant(const void* data, uint32_t size, const std::shared_ptr<Pipeline>& pipeline)
 {
     vkCmdPushConstants(m_cmdBuffers[m_currentCmdBufferIndex],
-        std::static_pointer_cast<VulkanPipeline>(pipeline)->Layout(),
+        static_cast<const VulkanPipeline&>(*pipeline).Layout(),
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        size,
+        data);
+}
+
+void VulkanDevice::BindPipeline(PipelineHandle pipeline)
+{
+    const auto& entry = m_pools.m_pipelines.Get(pipeline);
+    RHI_ASSERT(entry.m_bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+    vkCmdBindPipeline(m_cmdBuffers[m_currentCmdBufferIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, entry.m_pipeline);
+}
+
+void VulkanDevice::BindVertexBuffer(BufferHandle buffer)
+{
+    VkBuffer vertexBuffers[] = { m_pools.m_buffers.Get(buffer).m_buffer };
+    VkDeviceSize offsets[] = { 0 };
+
+    vkCmdBindVertexBuffers(m_cmdBuffers[m_currentCmdBufferIndex], 0, 1, vertexBuffers, offsets);
+}
+
+void VulkanDevice::BindIndexBuffer(BufferHandle buffer)
+{
+    vkCmdBindIndexBuffer(m_cmdBuffers[m_currentCmdBufferIndex], m_pools.m_buffers.Get(buffer).m_buffer, 0, VK_INDEX_TYPE_UINT32);
+}
+
+void VulkanDevice::BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const DynamicOffsets& offsets)
+{
+    const auto& pipelineEntry = m_pools.m_pipelines.Get(pipeline);
+    const auto descSet = m_pools.m_materials.Get(material).m_descriptorSet;
+
+    vkCmdBindDescriptorSets(m_cmdBuffers[m_currentCmdBufferIndex],
+        pipelineEntry.m_bindPoint,
+        pipelineEntry.m_layout,
+        0, 1,
+        &descSet,
+        static_cast<uint32_t>(offsets.size()), offsets.data());
+}
+
+void VulkanDevice::BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const std::shared_ptr<ComputeState>& state, const DynamicOffsets& offsets)
+{
+    RHI_ASSERT(state);
+
+    const auto& pipelineEntry = m_pools.m_pipelines.Get(pipeline);
+    RHI_ASSERT(pipelineEntry.m_bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE);
+
+    const auto descSet = m_pools.m_materials.Get(material).m_descriptorSet;
+
+    vkCmdBindDescriptorSets(static_cast<const VulkanComputeState&>(*state).m_cmdBuffer.Raw(),
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        pipelineEntry.m_layout,
+        0, 1,
+        &descSet,
+        static_cast<uint32_t>(offsets.size()), offsets.data());
+}
+
+void VulkanDevice::PushConstant(const void* data, uint32_t size, PipelineHandle pipeline)
+{
+    vkCmdPushConstants(m_cmdBuffers[m_currentCmdBufferIndex],
+        m_pools.m_pipelines.Get(pipeline).m_layout,
         VK_SHADER_STAGE_VERTEX_BIT,
         0,
         size,
         data);
 }
 
+std::shared_ptr<CommandList> VulkanDevice::BeginCommandList(const std::shared_ptr<RenderPass>& pass)
+{
+    PROFILER_CPU_ZONE;
+
+    const auto cmdBuffer = m_commandListAllocator->Allocate(m_currentCmdBufferIndex);
+    return std::make_shared<VulkanCommandList>(cmdBuffer, static_cast<const VulkanRenderPass&>(*pass));
+}
+
+void VulkanDevice::ExecuteCommandLists(const eastl::vector<std::shared_ptr<CommandList>>& lists)
+{
+    PROFILER_CPU_ZONE;
+
+    if (lists.empty())
+    {
+        return;
+    }
+
+    eastl::fixed_vector<VkCommandBuffer, 16> cmdBuffers;
+
+    for (const auto& list : lists)
+    {
+        const auto& vkList = static_cast<const VulkanCommandList&>(*list);
+        RHI_ASSERT(vkList.Ended());
+
+        cmdBuffers.push_back(vkList.Raw());
+    }
+
+    vkCmdExecuteCommands(m_cmdBuffers[m_currentCmdBufferIndex], static_cast<uint32_t>(cmdBuffers.size()), cmdBuffers.data());
+}
+
 void VulkanDevice::FillSwapchainSupportDetails(const std::shared_ptr<VulkanContext>& context)
 {
     SwapchainSupportDetails details;
@@ -705,13 +1039,28 @@ std::shared_ptr<Fence> VulkanDevice::Execute(CommandBuffer buffer)
 {
     const auto cmd = buffer.Raw();
 
+    const uint64_t uploadValue = m_uploadManager->Flush();
+    const VkSemaphore uploadSemaphore = m_uploadManager->Semaphore();
+    const VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = 1;
+    timelineInfo.pWaitSemaphoreValues = &uploadValue;
+
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cmd;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &uploadSemaphore;
+    submitInfo.pWaitDstStageMask = &waitStageMask;
 
     auto fence = std::make_shared<Fence>(true);
     fence->Reset();
+
+    std::lock_guard l(m_queueMutex);
     vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, *fence->Raw());
 
     return fence;
@@ -757,6 +1106,10 @@ void VulkanDevice::CreateLogicalDevice(const std::shared_ptr<VulkanContext>& con
                                                             indices.graphicsFamily.value(),
                                                             indices.presentFamily.value()
                                                          };
+    if (indices.transferFamily.has_value())
+    {
+        uniqueQueueFamilies.insert(indices.transferFamily.value());
+    }
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -776,6 +1129,16 @@ void VulkanDevice::CreateLogicalDevice(const std::shared_ptr<VulkanContext>& con
     dynamicRenderingFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
     dynamicRenderingFeature.dynamicRendering = VK_TRUE;
 
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeature{};
+    timelineSemaphoreFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timelineSemaphoreFeature.timelineSemaphore = VK_TRUE;
+    dynamicRenderingFeature.pNext = &timelineSemaphoreFeature;
+
+    VkPhysicalDeviceSynchronization2Features synchronization2Feature{};
+    synchronization2Feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+    synchronization2Feature.synchronization2 = VK_TRUE;
+    timelineSemaphoreFeature.pNext = &synchronization2Feature;
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -809,6 +1172,13 @@ void VulkanDevice::SetupDeviceQueues(const std::shared_ptr<VulkanContext>& conte
     RHI_ASSERT(indices.IsComplete());
     vkGetDeviceQueue(s_ctx.m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
     vkGetDeviceQueue(s_ctx.m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+
+    if (indices.transferFamily.has_value())
+    {
+        vkGetDeviceQueue(s_ctx.m_device, indices.transferFamily.value(), 0, &m_transferQueue);
+        m_concurrentQueueFamilies = { indices.graphicsFamily.value(), indices.transferFamily.value() };
+        rhi::log::info("[Vulkan] Using dedicated transfer queue family {} for uploads", indices.transferFamily.value());
+    }
 }
 
 void VulkanDevice::SetupAllocator(const std::shared_ptr<VulkanContext>& context)
@@ -849,7 +1219,132 @@ void VulkanDevice::OnResize(uint32_t x, uint32_t y)
 
 void VulkanDevice::WaitForIdle()
 {
-    vkDeviceWaitIdle(s_ctx.m_device);
+    {
+        std::lock_guard l(m_queueMutex);
+        vkDeviceWaitIdle(s_ctx.m_device);
+    }
+
+    FlushAllDestructions();
+}
+
+VkCommandPool VulkanDevice::ThreadCommandPool()
+{
+    auto& owner = t_commandPoolOwner;
+
+    // Pool of the previous device was destroyed together with it
+    if (owner.m_pool && owner.m_device == this)
+    {
+        return owner.m_pool;
+    }
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = FindQueueFamilies().graphicsFamily.value();
+
+    VkCommandPool pool = nullptr;
+    RHI_ASSERT(vkCreateCommandPool(s_ctx.m_device, &poolInfo, nullptr, &pool) == VK_SUCCESS);
+
+    {
+        std::lock_guard l(m_threadCommandPoolsMutex);
+        m_threadCommandPools.push_back(pool);
+    }
+
+    owner.m_device = this;
+    owner.m_pool = pool;
+
+    return pool;
+}
+
+void VulkanDevice::ReleaseThreadCommandPool(VkCommandPool pool)
+{
+    {
+        std::lock_guard l(m_threadCommandPoolsMutex);
+
+        const auto it = eastl::find(m_threadCommandPools.begin(), m_threadCommandPools.end(), pool);
+        RHI_ASSERT(it != m_threadCommandPools.end());
+        m_threadCommandPools.erase(it);
+    }
+
+    DeferDestruction([pool]
+        {
+            vkDestroyCommandPool(VulkanDevice::s_ctx.m_device, pool, nullptr);
+        });
+}
+
+void VulkanDevice::DeferDestruction(std::function<void()>&& destroy)
+{
+    auto* device = s_ctx.m_instance;
+
+    if (!device)
+    {
+        destroy();
+        return;
+    }
+
+    // Frame is read under the same lock it is advanced with, so the object is never tagged with the frame before the current one
+    std::lock_guard l(device->m_destructionMutex);
+    device->m_pendingDestructions.push_back({ device->m_destructionFrame, std::move(destroy) });
+}
+
+void VulkanDevice::FlushDestructions(uint64_t completedFrame)
+{
+    eastl::vector<std::function<void()>> destructions;
+
+    {
+        std::lock_guard l(m_destructionMutex);
+
+        while (!m_pendingDestructions.empty() && m_pendingDestructions.front().m_frame <= completedFrame)
+        {
+            destructions.push_back(std::move(m_pendingDestructions.front().m_destroy));
+            m_pendingDestructions.pop_front();
+        }
+    }
+
+    // Destructors may release other objects which are deferred again, so they run outside of the lock
+    for (auto& destroy : destructions)
+    {
+        destroy();
+    }
+}
+
+void VulkanDevice::FlushAllDestructions()
+{
+    // Flushed destructors may defer the new ones, so it repeats until nothing is left
+    bool empty = false;
+    while (!empty)
+    {
+        FlushDestructions(std::numeric_limits<uint64_t>::max());
+
+        std::lock_guard l(m_destructionMutex);
+        empty = m_pendingDestructions.empty();
+    }
+}
+
+Device::FrameStats VulkanDevice::GetFrameStats() const
+{
+    FrameStats stats;
+    stats.m_gpuWaitMs = m_gpuWaitMs;
+    stats.m_frameTimeMs = m_frameTimeMs;
+    return stats;
+}
+
+Device::BarrierStats VulkanDevice::GetBarrierStats() const
+{
+    BarrierStats stats;
+    stats.m_barriers = m_frameBarriers;
+    stats.m_imageBarriers = m_frameImageBarriers;
+    stats.m_bufferBarriers = m_frameBufferBarriers;
+    return stats;
+}
+
+Device::PipelineStats VulkanDevice::GetPipelineStats() const
+{
+    PipelineStats stats;
+    stats.m_createdPipelines = m_createdPipelines;
+    stats.m_creationTimeMs = static_cast<float>(m_pipelineCreationTimeUs) / 1000.0f;
+    stats.m_warmCache = m_pipelineCache && m_pipelineCache->Warm();
+    return stats;
 }
 
 }
@@ -1,12 +1,23 @@
 #pragma once
 
 #include <optional>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <EASTL/deque.h>
 #include <RHI/Config.hpp>
 #include <RHI/Device.hpp>
 #include "VulkanContext.hpp"
 #include "CommandBuffer.hpp"
 #include "Fence.hpp"
 #include "Swapchain.hpp"
+#include "UploadManager.hpp"
+#include "DescriptorAllocator.hpp"
+#include "PipelineCache.hpp"
+#include "BarrierBatcher.hpp"
+#include "CommandListAllocator.hpp"
+#include "HandlePool.hpp"
 
 #pragma warning(push)
 #pragma warning(disable : 4189)
@@ -29,6 +40,8 @@ struct QueueFamilyIndices
 {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    // Set only if device has a transfer family without graphics and compute support
+    std::optional<uint32_t> transferFamily;
 
     bool IsComplete() const
     {
@@ -36,6 +49,39 @@ struct QueueFamilyIndices
     }
 };
 
+struct BufferEntry
+{
+    VkBuffer                m_buffer = nullptr;
+};
+
+struct TextureEntry
+{
+    VkImage                 m_image = nullptr;
+    // View of the first mip
+    VkImageView             m_view = nullptr;
+};
+
+struct PipelineEntry
+{
+    VkPipeline              m_pipeline = nullptr;
+    VkPipelineLayout        m_layout = nullptr;
+    VkPipelineBindPoint     m_bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+};
+
+struct GPUMaterialEntry
+{
+    VkDescriptorSet         m_descriptorSet = nullptr;
+};
+
+// Raw objects referenced by handles, slots are registered by the objects on creation and freed once GPU is done with them
+struct ResourcePools
+{
+    HandlePool<Buffer, BufferEntry>             m_buffers;
+    HandlePool<Texture, TextureEntry>           m_textures;
+    HandlePool<Pipeline, PipelineEntry>         m_pipelines;
+    HandlePool<GPUMaterial, GPUMaterialEntry>   m_materials;
+};
+
 class RHI_API VulkanDevice : public Device
 {
 public:
@@ -51,7 +97,7 @@ public:
     inline static ContextHolder s_ctx;
 
 public:
-    VulkanDevice(const std::shared_ptr<VulkanContext>& context);
+    VulkanDevice(const std::shared_ptr<VulkanContext>& context, const Options& options = {});
 
     virtual ~VulkanDevice() override;
 
@@ -60,10 +106,13 @@ public:
     virtual std::shared_ptr<Shader>             CreateShader(const ShaderDescriptor& desc) override;
     virtual std::shared_ptr<Sampler>            CreateSampler(const SamplerDescriptor& desc) override;
     virtual std::shared_ptr<Texture>            CreateTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const void* data = {}) override;
+    virtual std::shared_ptr<Texture>            CreateAliasedTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const std::shared_ptr<Texture>& memory) override;
     virtual std::shared_ptr<RenderPass>         CreateRenderPass(const RenderPassDescriptor& desc) override;
     virtual std::shared_ptr<Pipeline>           CreatePipeline(const PipelineDescriptor& desc) override;
     virtual std::shared_ptr<GPUMaterial>        CreateGPUMaterial(const std::shared_ptr<Shader>& shader) override;
 
+    virtual void                                UpdateBuffer(const std::shared_ptr<Buffer>& buffer, const void* data, uint32_t size, uint32_t offset = 0) override;
+
     virtual void                            BeginFrame() override;
     virtual void                            EndFrame() override;
     virtual void                            BeginComputePipeline(const std::shared_ptr<Pipeline>& pipeline) override;
@@ -72,33 +121,71 @@ public:
     virtual void                            EndComputePipeline(const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state) override;
     virtual void                            PushConstantComputeImmediate(const void* data, uint32_t size, const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state) override;
     virtual void                            Present() override;
-    virtual void                            BeginPipeline(const std::shared_ptr<Pipeline>& pipeline) override;
+    virtual void                            Barrier(const eastl::vector<TextureBarrier>& barriers) override;
+    virtual void                            BeginPipeline(const std::shared_ptr<Pipeline>& pipeline, bool commandLists = false) override;
     virtual void                            EndPipeline(const std::shared_ptr<Pipeline>& pipeline) override;
-    virtual void                            Draw(const std::shared_ptr<Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount) override;
-    virtual void                            Draw(const std::shared_ptr<Buffer>& vb, const std::shared_ptr<Buffer>& ib, uint32_t indexCount, uint32_t instanceCount) override;
+    virtual void                            BindPipeline(const std::shared_ptr<Pipeline>& pipeline) override;
+    virtual void                            Draw(const std::shared_ptr<Buffer>& buffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance = 0) override;
+    virtual void                            Draw(const std::shared_ptr<Buffer>& vb, const std::shared_ptr<Buffer>& ib, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance = 0) override;
+    virtual void                            BindVertexBuffer(const std::shared_ptr<Buffer>& buffer) override;
+    virtual void                            BindIndexBuffer(const std::shared_ptr<Buffer>& buffer) override;
+    virtual void                            Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override;
+    virtual void                            DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) override;
     virtual void                            Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
     virtual void                            Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, const std::shared_ptr<ComputeState>& state) override;
-    virtual void                            BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline) override;
-    virtual void                            BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state) override;
+    virtual void                            BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const DynamicOffsets& offsets = {}) override;
+    virtual void                            BindGPUMaterial(const std::shared_ptr<GPUMaterial>& material, const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<ComputeState>& state, const DynamicOffsets& offsets = {}) override;
     virtual void                            PushConstant(const void* data, uint32_t size, const std::shared_ptr<Pipeline>& pipeline) override;
+    virtual void                            BindPipeline(PipelineHandle pipeline) override;
+    virtual void                            BindVertexBuffer(BufferHandle buffer) override;
+    virtual void                            BindIndexBuffer(BufferHandle buffer) override;
+    virtual void                            BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const DynamicOffsets& offsets = {}) override;
+    virtual void                            BindGPUMaterial(GPUMaterialHandle material, PipelineHandle pipeline, const std::shared_ptr<ComputeState>& state, const DynamicOffsets& offsets = {}) override;
+    virtual void                            PushConstant(const void* data, uint32_t size, PipelineHandle pipeline) override;
+
+    virtual std::shared_ptr<CommandList>    BeginCommandList(const std::shared_ptr<RenderPass>& pass) override;
+    virtual void                            ExecuteCommandLists(const eastl::vector<std::shared_ptr<CommandList>>& lists) override;
 
     virtual void                            OnResize(uint32_t x, uint32_t y) override;
 
     virtual void                            WaitForIdle() override;
 
+    virtual PipelineStats                   GetPipelineStats() const override;
+    virtual BarrierStats                    GetBarrierStats() const override;
+    virtual FrameStats                      GetFrameStats() const override;
+
     VkPhysicalDevice                        PhysicalDevice() const { return s_ctx.m_physicalDevice; }
     VkCommandPool                           CommandPool() const { return m_commandPool; }
+    // Pool of the calling thread for the immediately executed command buffers, it must not be used by the other threads.
+    // Pool is destroyed when the thread exits, so command buffers allocated from it must not outlive the thread
+    VkCommandPool                           ThreadCommandPool();
+    // Called by the exiting thread, pool is destroyed once GPU finishes the frames which could use its command buffers
+    void                                    ReleaseThreadCommandPool(VkCommandPool pool);
+    // Guards submissions to all device queues, queues are externally synchronized
+    std::mutex&                             QueueMutex() { return m_queueMutex; }
     const SwapchainSupportDetails&          GetSwapchainSupportDetails() const { return m_swapchainDetails; }
     QueueFamilyIndices                      FindQueueFamilies() const;
     const std::shared_ptr<VulkanContext>&   Context() const { return m_context; }
     VkQueue                                 GraphicsQueue() const { return m_graphicsQueue; }
     VkCommandBuffer                         CurrentCmdBuffer() const { return m_cmdBuffers[m_currentCmdBufferIndex]; }
+    BarrierBatcher&                         CurrentBarrierBatcher() { return m_barrierBatchers[m_currentCmdBufferIndex]; }
+    // Queue families which device local resources are shared between
+    const eastl::vector<uint32_t>&          ConcurrentQueueFamilies() const { return m_concurrentQueueFamilies; }
+    DescriptorAllocator&                    GetDescriptorAllocator() { return *m_descriptorAllocator; }
+    UploadManager&                          GetUploadManager() { return *m_uploadManager; }
+    VkPipelineCache                         GetPipelineCache() const { return m_pipelineCache->Handle(); }
+    ResourcePools&                          Pools() { return m_pools; }
 
     std::shared_ptr<Fence>                  Execute(CommandBuffer buffer);
 
+    // Destroys Vulkan objects once GPU finishes all frames which could use them, may be called from any thread.
+    // Objects are destroyed right away if device is already gone
+    static void                             DeferDestruction(std::function<void()>&& destroy);
+
 private:
     VkQueue                         m_graphicsQueue = nullptr;
     VkQueue                         m_presentQueue = nullptr;
+    VkQueue                         m_transferQueue = nullptr;
     VkCommandPool                   m_commandPool = nullptr;
     SwapchainSupportDetails         m_swapchainDetails;
     std::unique_ptr<Swapchain>      m_swapchain;
@@ -108,8 +195,41 @@ private:
     glm::ivec2                      m_presentExtent = {0, 0};
     bool                            m_isSwapchainDirty = false;
     std::shared_ptr<VulkanContext>  m_context;
+    std::unique_ptr<UploadManager>  m_uploadManager;
+    std::unique_ptr<DescriptorAllocator> m_descriptorAllocator;
+    std::unique_ptr<PipelineCache>  m_pipelineCache;
+    std::unique_ptr<CommandListAllocator> m_commandListAllocator;
+    std::atomic<uint32_t>           m_createdPipelines = 0;
+    std::atomic<uint64_t>           m_pipelineCreationTimeUs = 0;
+    eastl::vector<uint32_t>         m_concurrentQueueFamilies;
+    ResourcePools                   m_pools;
 
     eastl::vector<VkCommandBuffer>                  m_cmdBuffers;
+    eastl::vector<BarrierBatcher>                   m_barrierBatchers;
+    std::atomic<uint32_t>                           m_frameBarriers = 0;
+    std::atomic<uint32_t>                           m_frameImageBarriers = 0;
+    std::atomic<uint32_t>                           m_frameBufferBarriers = 0;
+    std::atomic<float>                              m_gpuWaitMs = 0.0f;
+    std::atomic<float>                              m_frameTimeMs = 0.0f;
+    std::chrono::steady_clock::time_point           m_frameBeginTime;
+
+    std::mutex                                      m_queueMutex;
+    std::mutex                                      m_threadCommandPoolsMutex;
+    // Pools of the alive threads
+    eastl::vector<VkCommandPool>                    m_threadCommandPools;
+
+    struct PendingDestruction
+    {
+        // Last frame which could use the object
+        uint64_t                m_frame = 0;
+        std::function<void()>   m_destroy;
+    };
+
+    std::mutex                                      m_destructionMutex;
+    // Ordered by frame, as the frame is advanced under the same mutex
+    eastl::deque<PendingDestruction>                m_pendingDestructions;
+    // Frame which is recorded now, guarded by destruction mutex
+    uint64_t                                        m_destructionFrame = 0;
     // TODO: It is quick and easy implementation in future with must integrate compute cmd buffers to general rendering pipeline
     eastl::vector<VkCommandBuffer>                  m_computeCmdBuffers;
     eastl::vector<VkFence>                          m_fences;
@@ -117,8 +237,7 @@ private:
     eastl::vector<VkSemaphore>                      m_presentSemaphores;
     eastl::vector<VkSemaphore>                      m_renderSemaphores;
     eastl::vector<VkSemaphore>                      m_computeSemaphores;
-    eastl::vector<std::shared_ptr<VulkanTexture>>   m_texturesToReset;
-    eastl::vector<std::shared_ptr<VulkanTexture>>   m_computeTexturesToReset;
+    eastl::vector<StorageTexture>                   m_computeTexturesToReset;
 
     // Initializer methods
     void PickPhysicalDevice(const std::shared_ptr<VulkanContext>& context);
@@ -128,6 +247,13 @@ private:
     void SetupAllocator(const std::shared_ptr<VulkanContext>& context);
     void SetupCommandPool(const std::shared_ptr<VulkanContext>& context);
     void FillSwapchainSupportDetails(const std::shared_ptr<VulkanContext>& context);
+
+    // Destroys objects released not later than the given frame, GPU must be done with that frame
+    void FlushDestructions(uint64_t completedFrame);
+    void FlushAllDestructions();
+
+    // Storage textures with the mip set are transitioned only in that mip
+    void TransitionStorageTextures(const eastl::vector<StorageTexture>& textures, VkImageLayout layout, BarrierBatcher& batcher);
 };
 
 }
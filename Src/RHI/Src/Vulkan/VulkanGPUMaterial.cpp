@@ -4,36 +4,32 @@
 #include "VulkanTexture.hpp"
 #include "VulkanDevice.hpp"
 
-namespace
-{
-constexpr uint32_t C_DESCRIPTOR_POOL_SIZE = 128;
-}
-
 namespace rhi::vulkan
 {
 
-VulkanGPUMaterial::VulkanGPUMaterial(const std::shared_ptr<VulkanShader>& shader) : m_shaderDesc(&shader->Descriptor())
+VulkanGPUMaterial::VulkanGPUMaterial(const std::shared_ptr<VulkanShader>& shader) : m_shaderDesc(&shader->Descriptor()), m_layout(shader->Layout())
 {
-    if (s_descriptorPool == nullptr)
-    {
-        AllocateDescriptorPool();
-    }
-
-    const auto layout = shader->Layout();
-
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = s_descriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &layout;
-
-    const auto res = vkAllocateDescriptorSets(VulkanDevice::s_ctx.m_device, &allocInfo, &m_descriptorSet);
-
-    RHI_ASSERT(res == VK_SUCCESS);
+    // Material without bindings still gets a valid set
+    m_dirty = true;
+    Sync();
 }
 
 VulkanGPUMaterial::~VulkanGPUMaterial()
 {
+    // Descriptor allocator is already destroyed together with the device
+    if (m_descriptorSet && VulkanDevice::s_ctx.m_instance)
+    {
+        VulkanDevice::s_ctx.m_instance->GetDescriptorAllocator().Release(m_descriptorSet);
+    }
+
+    // Handle may still be resolved by the frames in flight, so the slot isn't reused until they are finished
+    VulkanDevice::DeferDestruction([handle = m_handle]
+    {
+        if (auto* device = VulkanDevice::s_ctx.m_instance)
+        {
+            device->Pools().m_materials.Free(handle);
+        }
+    });
 }
 
 // TODO: Add validation for texture slots from reflection
@@ -46,7 +42,7 @@ void VulkanGPUMaterial::SetTexture(const std::shared_ptr<Texture>& texture, uint
     info.m_slot = slot;
     info.m_mipLevel = mipLevel;
 
-    m_texturesToSync.emplace_back(info);
+    m_textures[slot] = info;
 }
 
 // TODO: Add validation for buffer slots from reflection
@@ -62,7 +58,7 @@ void VulkanGPUMaterial::SetBuffer(const std::shared_ptr<Buffer>& buffer, uint8_t
     info.m_offset = offset;
     info.m_stage = stage;
 
-    m_buffersToSync.emplace_back(info);
+    m_buffers[slot] = info;
 }
 
 void VulkanGPUMaterial::Sync()
@@ -76,11 +72,11 @@ void VulkanGPUMaterial::Sync()
     eastl::vector<VkWriteDescriptorSet> writeDescriptorSets;
     eastl::vector<VkDescriptorBufferInfo> bufferInfos;
 
-    writeDescriptorSets.reserve(m_buffersToSync.size() + 1);
-    bufferInfos.reserve(m_buffersToSync.size() + 1);
+    writeDescriptorSets.reserve(m_buffers.size() + m_textures.size());
+    bufferInfos.reserve(m_buffers.size() + 1);
 
     uint32_t i = 0;
-    for (auto& buffer : m_buffersToSync)
+    for (auto& [_, buffer] : m_buffers)
     {
         if (buffer.m_buffer.expired())
         {
@@ -90,20 +86,27 @@ void VulkanGPUMaterial::Sync()
 
         const auto bufferPtr = buffer.m_buffer.lock();
 
+        const bool isStorage = bufferPtr->Descriptor().m_type == BufferType::STORAGE;
+
         VkDescriptorBufferInfo bufferInfo{};
         bufferInfo.buffer = std::static_pointer_cast<VulkanBuffer>(bufferPtr)->Raw();
         // TODO: Add validation for stride and offset
         bufferInfo.range = bufferPtr->Descriptor().m_size;
         bufferInfo.offset = buffer.m_offset;
 
+        // Uniform buffers are dynamic, so only the size of the block is visible, actual offset is provided on bind
+        if (const auto it = m_shaderDesc->m_reflection.m_bufferMap.find(buffer.m_slot); !isStorage && it != m_shaderDesc->m_reflection.m_bufferMap.end())
+        {
+            bufferInfo.range = it->second.m_size;
+        }
+
         bufferInfos.emplace_back(bufferInfo);
 
         VkWriteDescriptorSet descriptorWrite{};
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = m_descriptorSet;
         descriptorWrite.dstBinding = buffer.m_slot;
         descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrite.descriptorType = isStorage ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         descriptorWrite.descriptorCount = 1;
         descriptorWrite.pBufferInfo = &bufferInfos[i];
 
@@ -113,9 +116,9 @@ void VulkanGPUMaterial::Sync()
 
     eastl::vector<VkDescriptorImageInfo> textureInfos;
     // To prevent reallocation
-    textureInfos.reserve(m_texturesToSync.size() + 1);
+    textureInfos.reserve(m_textures.size() + 1);
 
-    for (auto& texture : m_texturesToSync)
+    for (auto& [_, texture] : m_textures)
     {
         if (texture.m_texture.expired())
         {
@@ -125,6 +128,9 @@ void VulkanGPUMaterial::Sync()
 
         const auto texPtr = std::static_pointer_cast<VulkanTexture>(texture.m_texture.lock());
 
+        // Data of the texture may be still queued, set can be bound right after it is written
+        VulkanDevice::s_ctx.m_instance->GetUploadManager().Require(*texPtr);
+
         VkDescriptorImageInfo imageInfo{};
         if (texPtr->Descriptor().m_format == Format::D32_SFLOAT_S8_UINT ||
             eastl::find_if(m_shaderDesc->m_reflection.m_storageImages.begin(), 
@@ -148,7 +154,6 @@ void VulkanGPUMaterial::Sync()
 
         VkWriteDescriptorSet descriptorWrite{};
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = m_descriptorSet;
         descriptorWrite.dstBinding = texture.m_slot;
         descriptorWrite.dstArrayElement = 0;
         descriptorWrite.descriptorType = DescriptorType(texture.m_slot);
@@ -158,66 +163,58 @@ void VulkanGPUMaterial::Sync()
         writeDescriptorSets.push_back(descriptorWrite);
     }
 
-    vkUpdateDescriptorSets(VulkanDevice::s_ctx.m_device,
-        static_cast<uint32_t>(writeDescriptorSets.size()),
-        writeDescriptorSets.data(),
-        0,
-        nullptr);
-
-    m_texturesToSync.clear();
-    m_buffersToSync.clear();
-}
-
-void VulkanGPUMaterial::Destroy()
-{
-    vkDestroyDescriptorPool(VulkanDevice::s_ctx.m_device, s_descriptorPool, nullptr);
-}
-
-void VulkanGPUMaterial::AllocateDescriptorPool()
-{
-    VkDescriptorPoolSize bufferPoolSize{};
-    bufferPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    bufferPoolSize.descriptorCount = C_DESCRIPTOR_POOL_SIZE;
-
-    VkDescriptorPoolSize texturePoolSize{};
-    texturePoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    texturePoolSize.descriptorCount = C_DESCRIPTOR_POOL_SIZE;
-
-    VkDescriptorPoolSize imageStoragePoolSize{};
-    imageStoragePoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    imageStoragePoolSize.descriptorCount = C_DESCRIPTOR_POOL_SIZE;
-
-    VkDescriptorPoolSize storageBufferPoolSize{};
-    storageBufferPoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    storageBufferPoolSize.descriptorCount = C_DESCRIPTOR_POOL_SIZE;
-
-    eastl::vector<VkDescriptorPoolSize> poolSizes;
-    if (bufferPoolSize.descriptorCount > 0)
+    DescriptorAllocator::SetKey key;
+    key.m_layout = m_layout;
+    for (const auto& write : writeDescriptorSets)
     {
-        poolSizes.push_back(bufferPoolSize);
+        key.Add(write);
     }
-    else if (texturePoolSize.descriptorCount > 0)
-    {
-        poolSizes.push_back(texturePoolSize);
-    }
-    else if (imageStoragePoolSize.descriptorCount > 0)
+
+    auto& allocator = VulkanDevice::s_ctx.m_instance->GetDescriptorAllocator();
+
+    // Current set may reference destroyed object which handle was reused by the new one, so it must be still cached
+    if (m_descriptorSet && key == m_setKey && allocator.Cached(m_descriptorSet))
     {
-        poolSizes.push_back(imageStoragePoolSize);
+        return;
     }
-    else if (storageBufferPoolSize.descriptorCount > 0)
+
+    // Set which is currently bound is never rewritten, material switches to another one instead
+    const VkDescriptorSet set = allocator.Acquire(key, [&writeDescriptorSets](VkDescriptorSet set)
+        {
+            for (auto& write : writeDescriptorSets)
+            {
+                write.dstSet = set;
+            }
+
+            vkUpdateDescriptorSets(VulkanDevice::s_ctx.m_device,
+                static_cast<uint32_t>(writeDescriptorSets.size()),
+                writeDescriptorSets.data(),
+                0,
+                nullptr);
+        });
+
+    if (m_descriptorSet)
     {
-        poolSizes.push_back(storageBufferPoolSize);
+        allocator.Release(m_descriptorSet);
     }
 
-    RHI_ASSERT(!poolSizes.empty());
+    m_descriptorSet = set;
+    m_setKey = key;
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = C_DESCRIPTOR_POOL_SIZE;
+    // Entry of the handle is never changed, so commands which were recorded with the previous handle keep binding the previous set
+    // while the render thread is behind. Previous slot is freed once the frames in flight are finished
+    if (m_handle.Valid())
+    {
+        VulkanDevice::DeferDestruction([handle = m_handle]
+        {
+            if (auto* device = VulkanDevice::s_ctx.m_instance)
+            {
+                device->Pools().m_materials.Free(handle);
+            }
+        });
+    }
 
-    RHI_ASSERT(vkCreateDescriptorPool(VulkanDevice::s_ctx.m_device, &poolInfo, nullptr, &s_descriptorPool) == VK_SUCCESS);
+    m_handle = VulkanDevice::s_ctx.m_instance->Pools().m_materials.Allocate({ set });
 }
 
 VkDescriptorType VulkanGPUMaterial::DescriptorType(uint8_t slot)
@@ -2,6 +2,8 @@
 
 #include <RHI/GPUMaterial.hpp>
 #include "VulkanShader.hpp"
+#include "DescriptorAllocator.hpp"
+#include <EASTL/vector_map.h>
 
 namespace rhi::vulkan
 {
@@ -22,10 +24,7 @@ public:
 
     virtual void        Sync() override;
 
-    static void         Destroy();
-
 private:
-    static void         AllocateDescriptorPool();
     VkDescriptorType    DescriptorType(uint8_t slot);
 
     struct BufferInfo
@@ -43,13 +42,14 @@ private:
         uint8_t                     m_mipLevel = 0;
     };
 
-    eastl::vector<BufferInfo>           m_buffersToSync;
-    eastl::vector<TextureInfo>          m_texturesToSync;
-
-    const ShaderDescriptor*             m_shaderDesc = nullptr;
-    VkDescriptorSet                     m_descriptorSet = nullptr;
+    // All current bindings, set is looked up in the cache by all of them on every sync
+    eastl::vector_map<uint8_t, BufferInfo>  m_buffers;
+    eastl::vector_map<uint8_t, TextureInfo> m_textures;
 
-    inline static VkDescriptorPool      s_descriptorPool = nullptr;
+    const ShaderDescriptor*                 m_shaderDesc = nullptr;
+    VkDescriptorSetLayout                   m_layout = nullptr;
+    VkDescriptorSet                         m_descriptorSet = nullptr;
+    DescriptorAllocator::SetKey             m_setKey;
 };
 
 } // rhi::vulkan
\ No newline at end of file
@@ -34,6 +34,8 @@ inline VkBufferUsageFlags BufferUsage(BufferType type)
         return VK_BUFFER_USAGE_TRANSFER_DST_BIT;
     case BufferType::TRANSFER_SRC:
         return VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    case BufferType::STORAGE:
+        return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
     default:
         HELPER_DEFAULT_RETURN(VkBufferUsageFlags);
     }
@@ -208,4 +210,61 @@ inline VkCompareOp CompareOp(CompareOp op)
     }
 }
 
+inline VkImageLayout ImageLayout(TextureLayout layout)
+{
+    switch (layout)
+    {
+    case TextureLayout::UNDEFINED:
+        return VK_IMAGE_LAYOUT_UNDEFINED;
+    case TextureLayout::SHADER_READ_ONLY:
+        return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    case TextureLayout::COLOR_ATTACHMENT:
+        return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    case TextureLayout::DEPTH_STENCIL_ATTACHMENT:
+        return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    default:
+        HELPER_DEFAULT_RETURN(VkImageLayout);
+    }
+}
+
+// Accesses which image in the layout is used with, layouts without known usage are synchronized as any memory access
+inline VkAccessFlags2 LayoutAccess(VkImageLayout layout)
+{
+    switch (layout)
+    {
+    case VK_IMAGE_LAYOUT_UNDEFINED:
+    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+        return VK_ACCESS_2_NONE;
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        return VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        return VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        return VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    case VK_IMAGE_LAYOUT_GENERAL:
+        return VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    default:
+        return VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+    }
+}
+
+inline VkPipelineStageFlags2 LayoutStages(VkImageLayout layout)
+{
+    switch (layout)
+    {
+    case VK_IMAGE_LAYOUT_UNDEFINED:
+        return VK_PIPELINE_STAGE_2_NONE;
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        return VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        return VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        return VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+    case VK_IMAGE_LAYOUT_GENERAL:
+        return VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    default:
+        return VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    }
+}
+
 } // namespace rhi::vulkan::helpers
\ No newline at end of file
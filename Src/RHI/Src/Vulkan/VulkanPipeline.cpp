@@ -5,6 +5,44 @@
 #include "VulkanRenderPass.hpp"
 #include <RHI/RenderPass.hpp>
 #include <vulkan/vulkan.h>
+#include <cstddef>
+
+namespace
+{
+
+struct SpecializationData
+{
+    eastl::vector<VkSpecializationMapEntry> m_entries;
+    VkSpecializationInfo                    m_info{};
+};
+
+// Returns nullptr if there are no constants, values are read directly from the descriptor
+const VkSpecializationInfo* FillSpecializationInfo(const eastl::vector<rhi::SpecializationConstant>& constants, SpecializationData& data)
+{
+    if (constants.empty())
+    {
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < constants.size(); i++)
+    {
+        VkSpecializationMapEntry entry{};
+        entry.constantID = constants[i].m_id;
+        entry.offset = static_cast<uint32_t>(i * sizeof(rhi::SpecializationConstant) + offsetof(rhi::SpecializationConstant, m_value));
+        entry.size = sizeof(uint32_t);
+
+        data.m_entries.push_back(entry);
+    }
+
+    data.m_info.mapEntryCount = static_cast<uint32_t>(data.m_entries.size());
+    data.m_info.pMapEntries = data.m_entries.data();
+    data.m_info.dataSize = constants.size() * sizeof(rhi::SpecializationConstant);
+    data.m_info.pData = constants.data();
+
+    return &data.m_info;
+}
+
+} // unnamed
 
 namespace rhi::vulkan
 {
@@ -54,12 +92,25 @@ VulkanPipeline::VulkanPipeline(const PipelineDescriptor& descriptor) : Pipeline(
     {
         CreateFxPipeline();
     }
+
+    PipelineEntry entry;
+    entry.m_pipeline = m_pipeline;
+    entry.m_layout = m_layout;
+    entry.m_bindPoint = descriptor.m_compute ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
+    m_handle = VulkanDevice::s_ctx.m_instance->Pools().m_pipelines.Allocate(entry);
 }
 
 VulkanPipeline::~VulkanPipeline()
 {
-    vkDestroyPipelineLayout(VulkanDevice::s_ctx.m_device, m_layout, nullptr);
-    vkDestroyPipeline(VulkanDevice::s_ctx.m_device, m_pipeline, nullptr);
+    VulkanDevice::DeferDestruction([layout = m_layout, pipeline = m_pipeline, handle = m_handle]
+    {
+        if (auto* device = VulkanDevice::s_ctx.m_instance)
+        {
+            device->Pools().m_pipelines.Free(handle);
+        }
+        vkDestroyPipelineLayout(VulkanDevice::s_ctx.m_device, layout, nullptr);
+        vkDestroyPipeline(VulkanDevice::s_ctx.m_device, pipeline, nullptr);
+    });
 }
 
 void VulkanPipeline::CreateFxPipeline()
@@ -160,6 +211,10 @@ void VulkanPipeline::CreateFxPipeline()
     colorBlending.blendConstants[2] = 0.0f; // Optional
     colorBlending.blendConstants[3] = 0.0f; // Optional
 
+    // Constants which are not used in the stage are ignored by it
+    SpecializationData specializationData;
+    const auto* specializationInfo = FillSpecializationInfo(m_descriptor.m_specializationConstants, specializationData);
+
     eastl::vector<VkPipelineShaderStageCreateInfo> shaderStages;
 
     for (const auto& [stage, blob] : shader->Descriptor().m_blobByStage)
@@ -169,6 +224,7 @@ void VulkanPipeline::CreateFxPipeline()
         shaderStageInfo.stage = helpers::ShaderStage(stage);
         shaderStageInfo.module = shader->Module(stage);
         shaderStageInfo.pName = "main";
+        shaderStageInfo.pSpecializationInfo = specializationInfo;
 
         shaderStages.emplace_back(shaderStageInfo);
     }
@@ -187,23 +243,15 @@ void VulkanPipeline::CreateFxPipeline()
     depthStencil.front = {}; // Optional
     depthStencil.back = {}; // Optional
 
-    eastl::vector<VkFormat> colorAttachmentFormats;
-
-    for (auto& attachment : renderPassDescriptor.m_colorAttachments)
-    {
-        colorAttachmentFormats.emplace_back(helpers::Format(attachment.m_texture->Descriptor().m_format));
-    }
+    const auto& vkRenderPass = static_cast<const VulkanRenderPass&>(*m_descriptor.m_pass);
+    const auto& colorAttachmentFormats = vkRenderPass.ColorFormats();
 
     VkPipelineRenderingCreateInfoKHR pipelineRenderingInfo{};
     pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
-    pipelineRenderingInfo.colorAttachmentCount = static_cast<uint32_t>(renderPassDescriptor.m_colorAttachments.size());
+    pipelineRenderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentFormats.size());
     pipelineRenderingInfo.pColorAttachmentFormats = colorAttachmentFormats.data();
-
-    if (renderPassDescriptor.m_depthStencilAttachment.m_texture)
-    {
-        pipelineRenderingInfo.depthAttachmentFormat = helpers::Format(renderPassDescriptor.m_depthStencilAttachment.m_texture->Descriptor().m_format);
-        pipelineRenderingInfo.stencilAttachmentFormat = helpers::Format(renderPassDescriptor.m_depthStencilAttachment.m_texture->Descriptor().m_format);
-    }
+    pipelineRenderingInfo.depthAttachmentFormat = vkRenderPass.DepthFormat();
+    pipelineRenderingInfo.stencilAttachmentFormat = vkRenderPass.DepthFormat();
 
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -224,23 +272,26 @@ void VulkanPipeline::CreateFxPipeline()
     pipelineInfo.basePipelineHandle = nullptr; // Optional
     pipelineInfo.basePipelineIndex = -1; // Optional
 
-    RHI_ASSERT(vkCreateGraphicsPipelines(VulkanDevice::s_ctx.m_device, nullptr, 1, &pipelineInfo, nullptr, &m_pipeline) == VK_SUCCESS);
+    RHI_ASSERT(vkCreateGraphicsPipelines(VulkanDevice::s_ctx.m_device, VulkanDevice::s_ctx.m_instance->GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_pipeline) == VK_SUCCESS);
 }
 
 void VulkanPipeline::CreateComputePipeline()
 {
+    SpecializationData specializationData;
+
     VkPipelineShaderStageCreateInfo shaderStageInfo{};
     shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
     shaderStageInfo.module = std::static_pointer_cast<VulkanShader>(m_descriptor.m_shader)->Module(ShaderStage::COMPUTE);
     shaderStageInfo.pName = "main";
+    shaderStageInfo.pSpecializationInfo = FillSpecializationInfo(m_descriptor.m_specializationConstants, specializationData);
 
     VkComputePipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     pipelineInfo.layout = m_layout;
     pipelineInfo.stage = shaderStageInfo;
 
-    RHI_ASSERT(vkCreateComputePipelines(VulkanDevice::s_ctx.m_device, nullptr, 1, &pipelineInfo, nullptr, &m_pipeline) == VK_SUCCESS);
+    RHI_ASSERT(vkCreateComputePipelines(VulkanDevice::s_ctx.m_device, VulkanDevice::s_ctx.m_instance->GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_pipeline) == VK_SUCCESS);
 }
 
 } // rhi::vulkan
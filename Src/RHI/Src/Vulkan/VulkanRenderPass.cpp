@@ -25,6 +25,7 @@ VulkanRenderPass::VulkanRenderPass(const RenderPassDescriptor& descriptor) : Ren
         colorAttachment.imageView = std::static_pointer_cast<VulkanTexture>(attachment.m_texture)->ImageView(0);
 
         m_colorAttachmentInfos.push_back(colorAttachment);
+        m_colorFormats.push_back(helpers::Format(attachment.m_texture->Descriptor().m_format));
     }
 
     if (!HasDepth())
@@ -46,6 +47,8 @@ VulkanRenderPass::VulkanRenderPass(const RenderPassDescriptor& descriptor) : Ren
     m_depthAttachmentInfo.imageView = std::static_pointer_cast<VulkanTexture>(descriptor.m_depthStencilAttachment.m_texture)->ImageView(0);
     m_depthAttachmentInfo.loadOp = helpers::LoadOperation(descriptor.m_depthStencilAttachment.m_loadOperation);
     m_depthAttachmentInfo.storeOp = helpers::StoreOperation(descriptor.m_depthStencilAttachment.m_storeOperation);
+
+    m_depthFormat = helpers::Format(descriptor.m_depthStencilAttachment.m_texture->Descriptor().m_format);
 }
 
 VulkanRenderPass::~VulkanRenderPass()
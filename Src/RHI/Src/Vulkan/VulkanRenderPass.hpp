@@ -18,10 +18,15 @@ public:
 
     const AttachmentInfoList&    ColorAttachments() const { return m_colorAttachmentInfos; }
     const AttachmentInfo&        DepthAttachment() const { return m_depthAttachmentInfo; }
+    // Formats which pipelines and command lists of the pass are created with, depth format is undefined if pass has no depth
+    const eastl::vector<VkFormat>& ColorFormats() const { return m_colorFormats; }
+    VkFormat                     DepthFormat() const { return m_depthFormat; }
 
 private:
     AttachmentInfoList                m_colorAttachmentInfos;
     AttachmentInfo                    m_depthAttachmentInfo;
+    eastl::vector<VkFormat>           m_colorFormats;
+    VkFormat                          m_depthFormat = VK_FORMAT_UNDEFINED;
 };
 
 }
\ No newline at end of file
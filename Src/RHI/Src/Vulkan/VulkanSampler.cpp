@@ -32,7 +32,15 @@ namespace rhi::vulkan
 
     VulkanSampler::~VulkanSampler()
     {
-        vkDestroySampler(VulkanDevice::s_ctx.m_device, m_sampler, nullptr);
+        // Sampler may still be used by the frames in flight
+        VulkanDevice::DeferDestruction([sampler = m_sampler]
+        {
+            if (auto* device = VulkanDevice::s_ctx.m_instance)
+            {
+                device->GetDescriptorAllocator().InvalidateSampler(sampler);
+            }
+            vkDestroySampler(VulkanDevice::s_ctx.m_device, sampler, nullptr);
+        });
     }
 
 } // namespace rhi::vulkan
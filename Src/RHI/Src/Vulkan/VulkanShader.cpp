@@ -61,13 +61,24 @@ void VulkanShader::CreateDescriptorSetLayout()
         {
             VkDescriptorSetLayoutBinding bufferLayoutBinding{};
             bufferLayoutBinding.binding = slot;
-            bufferLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            // Uniform data lives in per frame ring buffer, so offset is provided on every bind
+            bufferLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             bufferLayoutBinding.descriptorCount = 1;
             bufferLayoutBinding.stageFlags = helpers::ShaderStage(info.m_stage);
             bindings.emplace_back(bufferLayoutBinding);
         }
     }
 
+    for (const auto& [slot, info] : m_descriptor.m_reflection.m_storageBufferMap)
+    {
+        VkDescriptorSetLayoutBinding bufferLayoutBinding{};
+        bufferLayoutBinding.binding = slot;
+        bufferLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bufferLayoutBinding.descriptorCount = 1;
+        bufferLayoutBinding.stageFlags = helpers::ShaderStage(info.m_stage);
+        bindings.emplace_back(bufferLayoutBinding);
+    }
+
     for (const auto& info : m_descriptor.m_reflection.m_textures)
     {
         VkDescriptorSetLayoutBinding textureLayoutBinding{};
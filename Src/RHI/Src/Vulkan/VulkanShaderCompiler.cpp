@@ -8,9 +8,12 @@
 #pragma warning(pop)
 #include <spirv_cross/spirv_cross.hpp>
 #include <EASTL/sort.h>
+#include <Core/Hash.hpp>
+#include <Core/Profiling.hpp>
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <chrono>
 
 #define SHADER_COMPILER_VERBOSE 1
 #define SHADER_COMPILER_PRINT_SHADER 0
@@ -22,6 +25,9 @@ namespace
 
 using SPIRV_PAYLOAD = uint32_t;
 
+// Must be bumped on every change in compilation or reflection which affects its results
+constexpr std::string_view C_SHADER_CACHE_VERSION = "2";
+
 TBuiltInResource InitResources()
 {
     TBuiltInResource Resources;
@@ -152,8 +158,11 @@ glslang_stage_t RHITypeToGLSLangType(rhi::ShaderStage type)
 namespace rhi::vulkan
 {
 
-VulkanShaderCompiler::VulkanShaderCompiler(Options options) : ShaderCompiler(options)
+VulkanShaderCompiler::VulkanShaderCompiler(Options options) : ShaderCompiler(options), m_cache(m_options.m_cacheDirectory)
 {
+    // Process initialization is reference counted, so every compiler instance keeps its own.
+    // All glslang objects are created per compile call and glslang keeps its pool allocator per thread,
+    // so each worker compiles with its own context and no lock is needed
     glslang::InitializeProcess();
 }
 
@@ -164,11 +173,13 @@ VulkanShaderCompiler::~VulkanShaderCompiler()
 
 CompiledShaderData VulkanShaderCompiler::Compile(std::string_view path, ShaderType type)
 {
+    PROFILER_CPU_ZONE;
     RHI_ASSERT(fs::path(path).is_absolute());
     rhi::log::info("[VulkanShaderCompiler] Compiling {}", path);
 
     Context ctx;
     ctx.m_path = path;
+    ctx.m_dependencies.emplace_back(fs::path(path).lexically_normal().generic_u8string());
 
     ReadShader(ReadShader(path), ctx);
 
@@ -178,13 +189,33 @@ CompiledShaderData VulkanShaderCompiler::Compile(std::string_view path, ShaderTy
 
     CompiledShaderData data;
 
+    const auto cacheKey = CacheKey(ctx);
+
+    if (m_cache.Load(cacheKey, data))
+    {
+        data.m_dependencies = std::move(ctx.m_dependencies);
+        m_cacheHits++;
+        rhi::log::info("[VulkanShaderCompiler] Loaded from cache: {}", path);
+        return data;
+    }
+
+    m_cacheMisses++;
+
+    const auto compileStart = std::chrono::steady_clock::now();
+    size_t blobSize = 0;
+
     for (const auto& [stage, code] : ctx.m_stageCodeStr)
     {
         auto blob = CompileShader(code, path, stage);
         RHI_ASSERT(!blob.empty());
+        blobSize += blob.size();
         data.m_stageBlob[stage] = std::move(blob);
     }
 
+    const auto compileTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - compileStart);
+    m_compiledBlobSize += blobSize;
+    m_compileTimeUs += compileTime.count();
+
     data.m_valid = true;
 
     RHI_ASSERT(!data.m_stageBlob.empty());
@@ -206,7 +237,15 @@ CompiledShaderData VulkanShaderCompiler::Compile(std::string_view path, ShaderTy
         data.m_reflection = std::move(reflectionMap.begin()->second);
     }
 
-    rhi::log::info("[VulkanShaderCompiler] Successfully compiled: {}", path);
+    rhi::log::info("[VulkanShaderCompiler] Successfully compiled: {} ({} profile, {} bytes, {:.2f}ms)",
+        path,
+        ShaderProfileToString(m_options.m_profile),
+        blobSize,
+        static_cast<float>(compileTime.count()) / 1000.0f);
+
+    m_cache.Store(cacheKey, data);
+
+    data.m_dependencies = std::move(ctx.m_dependencies);
 
     return data;
 }
@@ -276,16 +315,18 @@ core::Blob VulkanShaderCompiler::CompileShader(const std::string& shaderStr, std
         return {};
     }
 
-    // TODO: Add debug and release shaders compilation settings
+    const bool release = m_options.m_profile == ShaderProfile::RELEASE;
 
-    glslang_spv_options_t spv_options;
-    spv_options.generate_debug_info = true;
+    // Names are not stripped even in release, because reflection binds engine types to buffers by their names
+    glslang_spv_options_t spv_options{};
+    spv_options.generate_debug_info = !release;
     spv_options.strip_debug_info = false;
-    spv_options.emit_nonsemantic_shader_debug_info = true;
-    spv_options.emit_nonsemantic_shader_debug_source = true;
-    spv_options.disable_optimizer = true;
-    spv_options.optimize_size = false;
-    spv_options.disassemble = true;
+    spv_options.emit_nonsemantic_shader_debug_info = !release;
+    spv_options.emit_nonsemantic_shader_debug_source = !release;
+    // Performance or size passes of SPIRV-Tools optimizer, glslang must be built with enable_optimizer option for them to run
+    spv_options.disable_optimizer = !release;
+    spv_options.optimize_size = release && m_options.m_optimizeSize;
+    spv_options.disassemble = !release;
     spv_options.validate = true;
     spv_options.compile_only = false;
 
@@ -326,6 +367,17 @@ ShaderReflection VulkanShaderCompiler::ReflectShader(const core::Blob& shaderBlo
         reflectionData.m_bufferMap[slot] = { std::move(name), size, rhi::BufferType::UNIFORM, stage, };
     }
 
+    for (auto& storageBuffer : res.storage_buffers)
+    {
+        auto& name = storageBuffer.name;
+        const auto slot = static_cast<uint8_t>(spirvCompiler.get_decoration(storageBuffer.id, spv::DecorationBinding));
+        // Runtime arrays are not included in declared size
+        const auto size = static_cast<uint32_t>(spirvCompiler.get_declared_struct_size(spirvCompiler.get_type(storageBuffer.base_type_id)));
+
+        RHI_ASSERT(reflectionData.m_storageBufferMap.find(slot) == reflectionData.m_storageBufferMap.end());
+        reflectionData.m_storageBufferMap[slot] = { std::move(name), size, rhi::BufferType::STORAGE, stage, };
+    }
+
     for (auto& texture : res.sampled_images)
     {
         auto& name = texture.name;
@@ -369,6 +421,15 @@ ShaderReflection VulkanShaderCompiler::ReflectShader(const core::Blob& shaderBlo
 
     reflectionData.m_outputAmount = static_cast<uint8_t>(res.stage_outputs.size());
 
+    for (const auto& constant : spirvCompiler.get_specialization_constants())
+    {
+        ShaderReflection::SpecializationConstantInfo constantInfo;
+        constantInfo.m_name = spirvCompiler.get_name(constant.id);
+        constantInfo.m_id = constant.constant_id;
+
+        reflectionData.m_specializationConstants.emplace_back(std::move(constantInfo));
+    }
+
     if (stage == ShaderStage::VERTEX)
     {
         eastl::map<uint8_t, spirv_cross::Resource> inputStages;
@@ -523,11 +584,16 @@ void VulkanShaderCompiler::PreprocessShader(Context& ctx)
                 if (start != std::string::npos && end != std::string::npos)
                 {
                     const auto shaderDir = fs::path(ctx.m_path).parent_path().generic_u8string();
-                    std::string includePath = fmt::format("{}/{}", shaderDir, line.substr(start + 1, end - start - 1));
+                    std::string includePath = fs::path(fmt::format("{}/{}", shaderDir, line.substr(start + 1, end - start - 1))).lexically_normal().generic_u8string();
                     std::string includedContent;
 
+                    if (eastl::find(ctx.m_dependencies.begin(), ctx.m_dependencies.end(), includePath) == ctx.m_dependencies.end())
                     {
-                        std::lock_guard l(m_includeCacheMutex);
+                        ctx.m_dependencies.push_back(includePath);
+                    }
+
+                    {
+                        std::shared_lock l(m_includeCacheMutex);
                         if (const auto it = m_includeCache.find(includePath); it != m_includeCache.end())
                         {
                             includedContent = it->second;
@@ -561,6 +627,52 @@ void VulkanShaderCompiler::PreprocessShader(Context& ctx)
     ctx.m_stageCodeStr = processedShaders;
 }
 
+void VulkanShaderCompiler::Invalidate(std::string_view path)
+{
+    std::lock_guard l(m_includeCacheMutex);
+    m_includeCache.erase(fs::path(path).lexically_normal().generic_u8string());
+}
+
+ShaderCompiler::Stats VulkanShaderCompiler::GetStats() const
+{
+    Stats stats;
+    stats.m_cacheHits = m_cacheHits;
+    stats.m_cacheMisses = m_cacheMisses;
+    stats.m_compiledBlobSize = m_compiledBlobSize;
+    stats.m_compileTimeMs = static_cast<float>(m_compileTimeUs) / 1000.0f;
+    return stats;
+}
+
+uint64_t VulkanShaderCompiler::CacheKey(const Context& ctx) const
+{
+    std::string keySource = fmt::format("{};{};{};{};",
+        C_SHADER_CACHE_VERSION,
+        static_cast<int>(ctx.m_type),
+        ShaderProfileToString(m_options.m_profile),
+        m_options.m_optimizeSize);
+#ifdef R_APPLE
+    keySource += "vk1.0;spv1.0;";
+#else
+    keySource += "vk1.3;spv1.5;";
+#endif
+
+    // Stages are stored in unordered map, so they are sorted to get the same key every time
+    eastl::vector<ShaderStage> stages;
+    for (const auto& [stage, _] : ctx.m_stageCodeStr)
+    {
+        stages.push_back(stage);
+    }
+    eastl::sort(stages.begin(), stages.end());
+
+    for (const auto stage : stages)
+    {
+        keySource += fmt::format("#stage {}\n", ShaderStageToString(stage));
+        keySource += ctx.m_stageCodeStr.at(stage);
+    }
+
+    return core::hash::HashString(keySource);
+}
+
 ShaderReflection VulkanShaderCompiler::MergeReflection(const ReflectionMap& reflectionMap, std::string_view path)
 {
     ShaderReflection mergedReflection;
@@ -582,6 +694,22 @@ ShaderReflection VulkanShaderCompiler::MergeReflection(const ReflectionMap& refl
             }
         }
 
+        // Merge storage buffers
+        auto& mergedStorageBufferMap = mergedReflection.m_storageBufferMap;
+        for (const auto& [slot, buffer] : reflection.m_storageBufferMap)
+        {
+            RHI_ASSERT_WITH_MESSAGE(mergedBufferMap.find(slot) == mergedBufferMap.end(), fmt::format("Slot {} has assigned buffer already", slot));
+
+            if (mergedStorageBufferMap.find(slot) == mergedStorageBufferMap.end())
+            {
+                mergedStorageBufferMap[slot] = buffer;
+            }
+            else
+            {
+                RHI_ASSERT_WITH_MESSAGE(false, fmt::format("Slot {} has assigned storage buffer '{}' already", slot, buffer.m_name));
+            }
+        }
+
         // Merge textures
         auto& mergedTextures = mergedReflection.m_textures;
         for (const auto& texture : reflection.m_textures)
@@ -597,6 +725,22 @@ ShaderReflection VulkanShaderCompiler::MergeReflection(const ReflectionMap& refl
         }
 
         
+        // Merge specialization constants, the same constant can be used in several stages
+        auto& mergedConstants = mergedReflection.m_specializationConstants;
+        for (const auto& constant : reflection.m_specializationConstants)
+        {
+            const auto it = eastl::find_if(mergedConstants.begin(), mergedConstants.end(), [&constant](const auto& c) { return c.m_id == constant.m_id; });
+
+            if (it == mergedConstants.end())
+            {
+                mergedConstants.push_back(constant);
+            }
+            else
+            {
+                RHI_ASSERT_WITH_MESSAGE(it->m_name == constant.m_name, fmt::format("Specialization constant {} has different names '{}' and '{}'", constant.m_id, it->m_name, constant.m_name));
+            }
+        }
+
         if (reflection.m_inputLayout.Empty())
         {
             continue;
@@ -3,9 +3,11 @@
 #include <RHI/Config.hpp>
 #include <RHI/ShaderCompiler.hpp>
 #include <Core/EASTLIntergration.hpp>
+#include "ShaderCache.hpp"
 #include <EASTL/unordered_map.h>
 #include <glslang/Include/glslang_c_shader_types.h>
-#include <mutex>
+#include <shared_mutex>
+#include <atomic>
 
 namespace rhi::vulkan
 {
@@ -19,27 +21,39 @@ public:
 
     virtual CompiledShaderData Compile(std::string_view path, ShaderType type) override;
 
+    virtual void Invalidate(std::string_view path) override;
+
+    virtual Stats GetStats() const override;
+
 private:
     using ReflectionMap = eastl::unordered_map<ShaderStage, ShaderReflection>;
     using ShaderMap = eastl::unordered_map<ShaderStage, std::string>;
 
     struct Context
     {
-        std::string_view    m_path;
-        ShaderMap           m_stageCodeStr;
-        ShaderType          m_type;
+        std::string_view            m_path;
+        ShaderMap                   m_stageCodeStr;
+        ShaderType                  m_type;
+        eastl::vector<std::string>  m_dependencies;
     };
 
     void                            ReadShader(const std::string& text, Context& ctx) const;
     std::string                     ReadShader(std::string_view path);
     void                            PreprocessShader(Context& ctx);
+    // Hash of preprocessed source of all stages and compiler options
+    uint64_t                        CacheKey(const Context& ctx) const;
     ShaderReflection                MergeReflection(const ReflectionMap& reflectionMap, std::string_view path);
     [[nodiscard]] ShaderReflection  ReflectShader(const core::Blob& shaderBlob, std::string_view path, ShaderStage stage);
     [[nodiscard]] core::Blob        CompileShader(const std::string& shaderCode, std::string_view path, ShaderStage stage);
 
     eastl::unordered_map<std::string, std::string>    m_includeCache;
-    std::mutex                                        m_includeCacheMutex;
-    std::mutex                                        m_glslangMutex;
+    // Shared between all compiling threads, includes are mostly read once they are cached
+    std::shared_mutex                                 m_includeCacheMutex;
+    ShaderCache                                       m_cache;
+    std::atomic<uint32_t>                             m_cacheHits = 0;
+    std::atomic<uint32_t>                             m_cacheMisses = 0;
+    std::atomic<uint64_t>                             m_compiledBlobSize = 0;
+    std::atomic<uint64_t>                             m_compileTimeUs = 0;
 };
 
 } // rhi::vulkan
@@ -2,7 +2,7 @@
 #include "VulkanBuffer.hpp"
 #include "VulkanDevice.hpp"
 #include "VulkanHelpers.hpp"
-#include <vk-tools/VulkanTools.h>
+#include "BarrierBatcher.hpp"
 
 namespace rhi::vulkan
 {
@@ -21,41 +21,6 @@ inline bool IsDepthTexture(Format format)
     return false;
 }
 
-void CopyBufferToImage(VkBuffer buffer, VkImage image, TextureDescriptor descriptor)
-{
-    CommandBuffer cmdBuffer;
-    cmdBuffer.Begin();
-
-    VkBufferImageCopy region{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-
-    region.imageOffset = { 0, 0, 0 };
-    region.imageExtent = { descriptor.m_width, descriptor.m_height, 1 };
-
-    cmdBuffer.Push([&](VkCommandBuffer cmdBufferPtr)
-        {
-            vkCmdCopyBufferToImage(
-                cmdBufferPtr,
-                buffer,
-                image,
-                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                1,
-                &region
-            );
-        });
-
-    cmdBuffer.End();
-
-    VulkanDevice::s_ctx.m_instance->Execute(cmdBuffer)->Wait();
-}
-
 [[maybe_unused]] void CopyImageToBuffer(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
 {
     CommandBuffer cmdBuffer;
@@ -91,26 +56,8 @@ void CopyBufferToImage(VkBuffer buffer, VkImage image, TextureDescriptor descrip
     VulkanDevice::s_ctx.m_instance->Execute(cmdBuffer)->Wait();
 }
 
-} // unnamed
-
-VulkanTexture::VulkanTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const void* data) : Texture(desc, sampler), m_layout(VK_IMAGE_LAYOUT_UNDEFINED)
+VkImageCreateInfo ImageCreateInfo(const TextureDescriptor& desc, uint8_t mipLevels)
 {
-    RHI_ASSERT(desc.m_width > 0 && desc.m_height > 0);
-    RHI_ASSERT(sampler);
-
-    if (data)
-    {
-        BufferDescriptor stagingBufferDesc;
-        stagingBufferDesc.m_size = desc.Size();
-        stagingBufferDesc.m_type = BufferType::TRANSFER_SRC;
-        stagingBufferDesc.m_memoryType = MemoryType::CPU_ONLY;
-        stagingBufferDesc.m_name = "Staging buffer";
-        m_stagingBuffer = VulkanDevice::s_ctx.m_instance->CreateBuffer(stagingBufferDesc, nullptr);
-        auto ptr = m_stagingBuffer->Map();
-        memcpy(ptr, data, stagingBufferDesc.m_size);
-        m_stagingBuffer->UnMap();
-    }
-
     VkImageCreateInfo imageCreateInfo{};
     imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     // TODO: Currently we support only 2D textures
@@ -118,7 +65,7 @@ VulkanTexture::VulkanTexture(const TextureDescriptor& desc, const std::shared_pt
     imageCreateInfo.extent.width = desc.m_width;
     imageCreateInfo.extent.height = desc.m_height;
     imageCreateInfo.extent.depth = 1;
-    imageCreateInfo.mipLevels = m_params.m_mipLevels;
+    imageCreateInfo.mipLevels = mipLevels;
     imageCreateInfo.arrayLayers = desc.m_layersAmount;
     imageCreateInfo.format = helpers::Format(desc.m_format);
     imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -147,7 +94,18 @@ VulkanTexture::VulkanTexture(const TextureDescriptor& desc, const std::shared_pt
             | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     }
 
-    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    // Image is shared with the transfer queue, so the upload doesn't need queue ownership transfer
+    const auto& queueFamilies = VulkanDevice::s_ctx.m_instance->ConcurrentQueueFamilies();
+    if (queueFamilies.size() > 1)
+    {
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageCreateInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+        imageCreateInfo.pQueueFamilyIndices = queueFamilies.data();
+    }
+    else
+    {
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
     imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 
     switch (desc.m_type)
@@ -166,6 +124,18 @@ VulkanTexture::VulkanTexture(const TextureDescriptor& desc, const std::shared_pt
         break;
     }
 
+    return imageCreateInfo;
+}
+
+} // unnamed
+
+VulkanTexture::VulkanTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler) : Texture(desc, sampler)
+{
+    RHI_ASSERT(desc.m_width > 0 && desc.m_height > 0);
+    RHI_ASSERT(sampler);
+
+    const auto imageCreateInfo = ImageCreateInfo(desc, m_params.m_mipLevels);
+
     VmaAllocationCreateInfo imageAllocInfo = {};
     imageAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
     imageAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
@@ -174,40 +144,95 @@ VulkanTexture::VulkanTexture(const TextureDescriptor& desc, const std::shared_pt
 
     RHI_ASSERT(status == VK_SUCCESS);
 
-    // TODO: Add later support for more layers
+    m_layouts.resize(static_cast<size_t>(MipLevels()) * LayerCount(), VK_IMAGE_LAYOUT_UNDEFINED);
 
     if (!IsDepthTexture(m_descriptor.m_format))
     {
-        ChangeImageLayout(m_image,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            m_descriptor.m_format,
-            m_descriptor.m_type == TextureType::TEXTURE_CUBEMAP ? 6 : 1,
-            m_params.m_mipLevels);
-        if (data)
-        {
-            CopyBufferToImage(std::static_pointer_cast<VulkanBuffer>(m_stagingBuffer)->Raw(), m_image, m_descriptor);
-
-            m_stagingBuffer.reset();
-        }
-        ChangeImageLayout(m_image,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            m_descriptor.m_format,
-            m_descriptor.m_type == TextureType::TEXTURE_CUBEMAP ? 6 : 1,
-            m_params.m_mipLevels);
+        // Layout initialization and data copy are recorded by the upload manager
+        SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, MipLevels());
     }
     else
     {
-        ChangeImageLayout(m_image,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 
-            m_descriptor.m_format,
-            m_descriptor.m_type == TextureType::TEXTURE_CUBEMAP ? 6 : 1,
-            m_params.m_mipLevels,
-            true);
+        InitializeLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
 
+    CreateImageViews();
+    m_handle = VulkanDevice::s_ctx.m_instance->Pools().m_textures.Allocate({ m_image, m_imageViews[0] });
+}
+
+VulkanTexture::VulkanTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const std::shared_ptr<VulkanTexture>& memory)
+    : Texture(desc, sampler)
+{
+    RHI_ASSERT(desc.m_width > 0 && desc.m_height > 0);
+    RHI_ASSERT(sampler && memory);
+
+    // Aliases always share the memory of the texture which allocated it
+    const auto& owner = memory->m_memory ? memory->m_memory : memory;
+    RHI_ASSERT(owner->m_allocation);
+
+    const auto imageCreateInfo = ImageCreateInfo(desc, m_params.m_mipLevels);
+    RHI_ASSERT(vkCreateImage(VulkanDevice::s_ctx.m_device, &imageCreateInfo, nullptr, &m_image) == VK_SUCCESS);
+
+    VkMemoryRequirements requirements{};
+    vkGetImageMemoryRequirements(VulkanDevice::s_ctx.m_device, m_image, &requirements);
+
+    VmaAllocationInfo allocationInfo{};
+    vmaGetAllocationInfo(VulkanDevice::s_ctx.m_allocator, owner->m_allocation, &allocationInfo);
+
+    const bool fits = requirements.size <= allocationInfo.size
+        && (requirements.memoryTypeBits & (1u << allocationInfo.memoryType)) != 0
+        && allocationInfo.offset % requirements.alignment == 0;
+
+    if (!fits || vmaBindImageMemory(VulkanDevice::s_ctx.m_allocator, owner->m_allocation, m_image) != VK_SUCCESS)
+    {
+        vkDestroyImage(VulkanDevice::s_ctx.m_device, m_image, nullptr);
+        m_image = nullptr;
+        return;
+    }
+
+    m_layouts.resize(static_cast<size_t>(MipLevels()) * LayerCount(), VK_IMAGE_LAYOUT_UNDEFINED);
+    m_memory = owner;
+    m_aliased = true;
+    owner->m_aliased = true;
+
+    CreateImageViews();
+    m_handle = VulkanDevice::s_ctx.m_instance->Pools().m_textures.Allocate({ m_image, m_imageViews[0] });
+}
+
+VulkanTexture::~VulkanTexture()
+{
+    if (!m_image)
+    {
+        return;
+    }
+
+    // Texture may still be used by the frames in flight. Aliased texture keeps the memory owner alive until its image is destroyed
+    VulkanDevice::DeferDestruction([image = m_image, allocation = m_allocation, views = std::move(m_imageViews), memory = std::move(m_memory), handle = m_handle]
+    {
+        if (auto* device = VulkanDevice::s_ctx.m_instance)
+        {
+            device->GetDescriptorAllocator().InvalidateImageViews(views);
+            device->Pools().m_textures.Free(handle);
+        }
+
+        for (const auto view : views)
+        {
+            vkDestroyImageView(VulkanDevice::s_ctx.m_device, view, nullptr);
+        }
+
+        if (memory)
+        {
+            vkDestroyImage(VulkanDevice::s_ctx.m_device, image, nullptr);
+        }
+        else
+        {
+            vmaDestroyImage(VulkanDevice::s_ctx.m_allocator, image, allocation);
+        }
+    });
+}
+
+void VulkanTexture::CreateImageViews()
+{
     m_imageViews.resize(m_params.m_mipLevels);
     for (int i = 0; i < m_params.m_mipLevels; i++)
     {
@@ -246,106 +271,46 @@ VulkanTexture::VulkanTexture(const TextureDescriptor& desc, const std::shared_pt
     }
 }
 
-VulkanTexture::~VulkanTexture()
+bool VulkanTexture::IsDepth() const
 {
-    // TODO: Currently we support only one image view, change later!
-    vkDestroyImageView(VulkanDevice::s_ctx.m_device, m_imageViews[0], nullptr);
-    vmaDestroyImage(VulkanDevice::s_ctx.m_allocator, m_image, m_allocation);
+    return IsDepthTexture(m_descriptor.m_format);
 }
 
-void VulkanTexture::ChangeImageLayout(VkCommandBuffer cmdBuffer, VkImageLayout oldLayout, VkImageLayout newLayout)
+VkImageAspectFlags VulkanTexture::Aspect() const
 {
-    const bool isDepth = m_descriptor.m_format == Format::D32_SFLOAT
-    || m_descriptor.m_format == Format::D32_SFLOAT_S8_UINT;
-
-    ChangeImageLayout(cmdBuffer,
-        m_image, 
-        oldLayout, 
-        newLayout, 
-        m_descriptor.m_format, 
-        m_descriptor.m_layersAmount,
-        m_params.m_mipLevels,
-        isDepth);
+    switch (m_descriptor.m_format)
+    {
+    case Format::D24_UNORM_S8_UINT:
+    case Format::D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    case Format::D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
 }
 
-void VulkanTexture::ChangeImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout)
+void VulkanTexture::SetLayout(VkImageLayout layout, uint32_t baseMip, uint32_t mipCount)
 {
-    const bool isDepth = m_descriptor.m_format == Format::D32_SFLOAT
-        || m_descriptor.m_format == Format::D32_SFLOAT_S8_UINT;
-
-    ChangeImageLayout(m_image,
-        oldLayout,
-        newLayout,
-        m_descriptor.m_format,
-        m_descriptor.m_layersAmount,
-        m_params.m_mipLevels,
-        isDepth);
-}
+    RHI_ASSERT(baseMip + mipCount <= MipLevels());
 
-void VulkanTexture::ChangeImageLayout(VkCommandBuffer cmdBuffer,
-                                      VkImage image,
-                                      VkImageLayout oldLayout, 
-                                      VkImageLayout newLayout,
-                                      Format format, 
-                                      int layers, 
-                                      int mipmaps, 
-                                      bool isDepth)
-{
-    VkImageSubresourceRange srcSubRange = {};
-    if (isDepth)
+    for (uint32_t layer = 0; layer < LayerCount(); ++layer)
     {
-        switch (format)
+        for (uint32_t mip = baseMip; mip < baseMip + mipCount; ++mip)
         {
-        case Format::D32_SFLOAT_S8_UINT:
-        {
-            srcSubRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
-            break;
-        }
-        case Format::D32_SFLOAT:
-        {
-            srcSubRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-            break;
+            m_layouts[layer * MipLevels() + mip] = layout;
         }
-        default:
-            RHI_ASSERT(false);
-        }
-    }
-    else
-    {
-        srcSubRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     }
-    srcSubRange.baseMipLevel = 0;
-    srcSubRange.levelCount = mipmaps;
-    srcSubRange.layerCount = layers;
-
-    vks::tools::setImageLayout(cmdBuffer,
-        image,
-        oldLayout,
-        newLayout,
-        srcSubRange);
-
-    m_layout = newLayout;
 }
 
-void VulkanTexture::ChangeImageLayout(VkImage image, 
-                                        VkImageLayout oldLayout,
-                                        VkImageLayout newLayout, 
-                                        Format format,
-                                        int layers, 
-                                        int mipmaps, 
-                                        bool isDepth)
+void VulkanTexture::InitializeLayout(VkImageLayout layout)
 {
     CommandBuffer cmdBuffer;
     cmdBuffer.Begin();
 
-    ChangeImageLayout(cmdBuffer.Raw(),
-        m_image,
-        oldLayout,
-        newLayout,
-        m_descriptor.m_format,
-        m_descriptor.m_layersAmount,
-        m_params.m_mipLevels,
-        isDepth);
+    BarrierBatcher batcher;
+    batcher.Transition(*this, layout);
+    batcher.Flush(cmdBuffer.Raw());
 
     cmdBuffer.End();
 
@@ -3,6 +3,7 @@
 #include <RHI/Texture.hpp>
 #include <RHI/Buffer.hpp>
 #include <vulkan/vulkan.h>
+#include <atomic>
 
 #pragma warning(push)
 #pragma warning(disable : 4189)
@@ -15,41 +16,44 @@ namespace rhi::vulkan
 class RHI_API VulkanTexture : public Texture
 {
 public:
-    VulkanTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const void* data = nullptr);
+    VulkanTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler);
+    // Texture is placed into the memory of the other one, Image() is null if it doesn't fit there.
+    // Layout isn't initialized, texture must be transitioned with discarding barrier before the first use
+    VulkanTexture(const TextureDescriptor& desc, const std::shared_ptr<Sampler>& sampler, const std::shared_ptr<VulkanTexture>& memory);
 
     virtual ~VulkanTexture() override;
 
-    void            ChangeImageLayout(VkCommandBuffer cmdBuffer, VkImageLayout oldLayout, VkImageLayout newLayout);
-    void            ChangeImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout);
-
-    VkImageLayout   Layout() const { return m_layout; }
-    VkImage         Image() const { return m_image; }
-    VkImageView     ImageView(uint32_t idx) const { RHI_ASSERT(idx < m_imageViews.size());  return m_imageViews[idx]; }
+    // Layout of the subresource, it is changed only by barrier batcher
+    VkImageLayout       Layout(uint32_t mip = 0, uint32_t layer = 0) const { return m_layouts[layer * MipLevels() + mip]; }
+    void                SetLayout(VkImageLayout layout, uint32_t baseMip, uint32_t mipCount);
+    VkImage             Image() const { return m_image; }
+    VkImageView         ImageView(uint32_t idx) const { RHI_ASSERT(idx < m_imageViews.size());  return m_imageViews[idx]; }
+    uint8_t             MipLevels() const { return m_params.m_mipLevels; }
+    uint32_t            LayerCount() const { return m_descriptor.m_layersAmount; }
+    VkImageAspectFlags  Aspect() const;
+    bool                IsDepth() const;
+    // True if memory of the texture is shared with the other texture
+    bool                Aliased() const { return m_aliased; }
+    // Data upload is queued for the later frames, it must be recorded with UploadManager::Require before the texture is used
+    bool                UploadPending() const { return m_uploadPending.load(std::memory_order_acquire); }
 
 private:
-    void ChangeImageLayout(VkCommandBuffer cmdBuffer,
-        VkImage image,
-        VkImageLayout oldLayout,
-        VkImageLayout newLayout,
-        Format format,
-        int layers,
-        int mipmaps,
-        bool isDepth = false);
-
-    // Immediate change, may cause deadlocks!
-    void ChangeImageLayout(VkImage image,
-        VkImageLayout oldLayout,
-        VkImageLayout newLayout,
-        Format format,
-        int layers,
-        int mipmaps,
-        bool isDepth = false);
-
-    std::shared_ptr<Buffer>         m_stagingBuffer;
+    friend class UploadManager;
+
+    // Immediate transition of the whole image, may cause deadlocks!
+    void InitializeLayout(VkImageLayout layout);
+
+    void CreateImageViews();
+
     VkImage                         m_image = nullptr;
     eastl::vector<VkImageView>      m_imageViews;
     VmaAllocation                   m_allocation = nullptr;
-    VkImageLayout                   m_layout;
+    // Layouts of the subresources, indexed by layer * mips + mip
+    eastl::vector<VkImageLayout>    m_layouts;
+    // Texture which owns the memory, set only for aliased textures
+    std::shared_ptr<VulkanTexture>  m_memory;
+    bool                            m_aliased = false;
+    std::atomic<bool>               m_uploadPending = false;
 };
 
 } // rhi::vulkan